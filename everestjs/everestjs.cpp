@@ -5,6 +5,7 @@
 
 #include <framework/everest.hpp>
 #include <framework/runtime.hpp>
+#include <utils/config_blob.hpp>
 
 #include <napi.h>
 
@@ -398,7 +399,7 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
         // initialize logging as early as possible
         Everest::Logging::init(rs->logging_config_file, module_id);
 
-        auto config = std::make_unique<Everest::Config>(rs);
+        auto config = std::make_unique<Everest::Config>(Everest::load_module_config(rs));
         if (!config->contains(module_id)) {
             EVTHROW(EVEXCEPTION(Everest::EverestConfigError,
                                 "Module with identifier '" << module_id << "' not found in config!"));
@@ -407,7 +408,7 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
         const std::string& module_name = config->get_main_config()[module_id]["module"].get<std::string>();
         auto module_manifest = config->get_manifests()[module_name];
         // FIXME (aw): get_classes should be called get_units and should contain the type of class for each unit
-        auto module_impls = config->get_interfaces()[module_name];
+        auto module_impls = config->get_interfaces().value(module_name, json::object());
 
         // initialize everest framework
         const auto& module_identifier = config->printable_identifier(module_id);
@@ -745,10 +746,18 @@ static Napi::Value boot_module(const Napi::CallbackInfo& info) {
 
         module_this.DefineProperty(Napi::PropertyDescriptor::Value("info", module_info_prop, napi_enumerable));
 
+        // the validate_schema setting of the javascript module overrides the one of the runtime settings
+        auto schema_validation = rs->schema_validation;
+        if (!validate_schema) {
+            schema_validation.mode = Everest::SchemaValidationMode::Off;
+        } else if (schema_validation.mode == Everest::SchemaValidationMode::Off) {
+            schema_validation.mode = Everest::SchemaValidationMode::Full;
+        }
+
         // connect to mqtt server and start mqtt mainloop thread
-        auto everest_handle = std::make_unique<Everest::Everest>(
-            module_id, *config, validate_schema, rs->mqtt_broker_host, rs->mqtt_broker_port, rs->mqtt_everest_prefix,
-            rs->mqtt_external_prefix, rs->telemetry_prefix, rs->telemetry_enabled);
+        auto everest_handle =
+            std::make_unique<Everest::Everest>(module_id, *config, schema_validation, Everest::get_mqtt_settings(*rs),
+                                               rs->telemetry_prefix, rs->telemetry_enabled);
 
         ctx = new EvModCtx(std::move(everest_handle), module_manifest, env);
 
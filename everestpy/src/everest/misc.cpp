@@ -5,6 +5,8 @@
 #include <cstdlib>
 #include <stdexcept>
 
+#include <utils/config_blob.hpp>
+
 static std::string get_ev_prefix_from_env() {
     const auto prefix = std::getenv("EV_PREFIX");
     if (prefix == nullptr) {
@@ -33,7 +35,7 @@ RuntimeSession::RuntimeSession() : RuntimeSession(get_ev_prefix_from_env(), get_
 std::unique_ptr<Everest::Config> RuntimeSession::create_config_instance(std::shared_ptr<Everest::RuntimeSettings> rs) {
     // FIXME (aw): where to initialize the logger?
     Everest::Logging::init(rs->logging_config_file);
-    return std::make_unique<Everest::Config>(rs);
+    return std::make_unique<Everest::Config>(Everest::load_module_config(rs));
 }
 
 ModuleSetup create_setup_from_config(const std::string& module_id, Everest::Config& config) {
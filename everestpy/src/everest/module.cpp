@@ -7,9 +7,9 @@
 std::unique_ptr<Everest::Everest> Module::create_everest_instance(const std::string& module_id,
                                                                   const RuntimeSession& session) {
     const auto& rs = session.get_runtime_settings();
-    return std::make_unique<Everest::Everest>(module_id, session.get_config(), rs->validate_schema,
-                                              rs->mqtt_broker_host, rs->mqtt_broker_port, rs->mqtt_everest_prefix,
-                                              rs->mqtt_external_prefix, rs->telemetry_prefix, rs->telemetry_enabled);
+    return std::make_unique<Everest::Everest>(module_id, session.get_config(), rs->schema_validation,
+                                              Everest::get_mqtt_settings(*rs), rs->telemetry_prefix,
+                                              rs->telemetry_enabled);
 }
 
 static std::string get_ev_module_from_env() {
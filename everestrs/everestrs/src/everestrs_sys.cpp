@@ -13,9 +13,9 @@ namespace {
 std::unique_ptr<Everest::Everest> create_everest_instance(const std::string& module_id,
                                                           std::shared_ptr<Everest::RuntimeSettings> rs,
                                                           const Everest::Config& config) {
-    return std::make_unique<Everest::Everest>(module_id, config, rs->validate_schema, rs->mqtt_broker_host,
-                                              rs->mqtt_broker_port, rs->mqtt_everest_prefix, rs->mqtt_external_prefix,
-                                              rs->telemetry_prefix, rs->telemetry_enabled);
+    return std::make_unique<Everest::Everest>(module_id, config, rs->schema_validation,
+                                              Everest::get_mqtt_settings(*rs), rs->telemetry_prefix,
+                                              rs->telemetry_enabled);
 }
 
 std::unique_ptr<Everest::Config> create_config_instance(std::shared_ptr<Everest::RuntimeSettings> rs) {
@@ -70,7 +70,12 @@ protected:
 
 struct ModuleAdapter {
     using CallFunc = std::function<Result(const Requirement&, const std::string&, Parameters)>;
+    using CallAsyncFunc = std::function<std::future<json>(const Requirement&, const std::string&, Parameters,
+                                                          std::optional<std::chrono::milliseconds>)>;
+    using CallAsyncCallbackFunc = std::function<void(const Requirement&, const std::string&, Parameters,
+                                                     CmdResultCallback, std::optional<std::chrono::milliseconds>)>;
     using PublishFunc = std::function<void(const std::string&, const std::string&, Value)>;
+    using PublishBatchFunc = std::function<void(const std::string&, VarBatch)>;
     using SubscribeFunc = std::function<void(const Requirement&, const std::string&, ValueCallback)>;
     using SubscribeErrorFunc = std::function<void(const Requirement&, const std::string&, error::ErrorCallback)>;
     using SubscribeAllErrorsFunc = std::function<void(error::ErrorCallback)>;
@@ -87,7 +92,10 @@ struct ModuleAdapter {
         std::function<void(const std::string&, const std::string&, const std::string&, const TelemetryMap&)>;
 
     CallFunc call;
+    CallAsyncFunc call_async;
+    CallAsyncCallbackFunc call_async_callback;
     PublishFunc publish;
+    PublishBatchFunc publish_batch;
     SubscribeFunc subscribe;
     SubscribeErrorFunc subscribe_error;
     SubscribeAllErrorsFunc subscribe_all_errors;
@@ -3,20 +3,27 @@
 #ifndef FRAMEWORK_EVEREST_HPP
 #define FRAMEWORK_EVEREST_HPP
 
+#include <atomic>
 #include <chrono>
 #include <future>
 #include <map>
 #include <set>
 #include <thread>
+#include <unordered_set>
 #include <variant>
 
 #include <everest/exceptions.hpp>
 
 #include <utils/config.hpp>
+#include <utils/config_snapshot.hpp>
 #include <utils/error.hpp>
 #include <utils/error/error_manager.hpp>
 #include <utils/mqtt_abstraction.hpp>
+#include <utils/pending_calls.hpp>
+#include <utils/routing_table.hpp>
+#include <utils/schema_validator_cache.hpp>
 #include <utils/types.hpp>
+#include <utils/var_coalescer.hpp>
 
 namespace Everest {
 ///
@@ -41,6 +48,8 @@ public:
     Everest(std::string module_id, const Config& config, bool validate_data_with_schema,
             const std::string& mqtt_server_address, int mqtt_server_port, const std::string& mqtt_everest_prefix,
             const std::string& mqtt_external_prefix, const std::string& telemetry_prefix, bool telemetry_enabled);
+    Everest(std::string module_id, const Config& config, const SchemaValidationSettings& schema_validation,
+            const MQTTSettings& mqtt_settings, const std::string& telemetry_prefix, bool telemetry_enabled);
 
     // forbid copy assignment and copy construction
     // NOTE (aw): move assignment and construction are also not supported because we're creating explicit references to
@@ -60,15 +69,42 @@ public:
 
     ///
     /// \brief Provides functionality for calling commands of other modules. The module is identified by the given \p
-    /// req, the command by the given command name \p cmd_name and the needed arguments by \p args
+    /// req, the command by the given command name \p cmd_name and the needed arguments by \p args. Blocks until the
+    /// result arrives, throws an EverestTimeoutError if it does not arrive within the \p timeout. Without a \p timeout
+    /// the cmd_timeout_ms of the connection of the requirement applies, or 300 s if none is configured
     ///
-    json call_cmd(const Requirement& req, const std::string& cmd_name, json args);
+    json call_cmd(const Requirement& req, const std::string& cmd_name, json args,
+                  std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+    ///
+    /// \brief Calls a command like call_cmd() without waiting for its result
+    ///
+    /// \returns a future that becomes ready with the result, or with an EverestTimeoutError if no result arrived
+    /// within the \p timeout
+    ///
+    std::future<json> call_cmd_async(const Requirement& req, const std::string& cmd_name, json args,
+                                     std::optional<std::chrono::milliseconds> timeout = std::nullopt);
+
+    ///
+    /// \brief Calls a command like call_cmd() without waiting for its result. The given \p callback is called once,
+    /// either with the result or with an EverestTimeoutError if no result arrived within the \p timeout
+    ///
+    /// Callbacks of all calls are run one after another on a thread of this instance, so they should not block
+    ///
+    void call_cmd_async(const Requirement& req, const std::string& cmd_name, json args, CmdResultCallback callback,
+                        std::optional<std::chrono::milliseconds> timeout = std::nullopt);
 
     ///
     /// \brief Publishes a variable of the given \p impl_id, names \p var_name with the given \p value
     ///
     void publish_var(const std::string& impl_id, const std::string& var_name, json value);
 
+    ///
+    /// \brief Publishes the given \p vars of the given \p impl_id together in one message. Subscribers receive them one
+    /// by one in the given order
+    ///
+    void publish_vars(const std::string& impl_id, VarBatch vars);
+
     ///
     /// \brief Subscribes to a variable of another module identified by the given \p req and variable name \p
     /// var_name. The given \p callback is called when a new value becomes available
@@ -140,6 +176,9 @@ public:
     /// \returns true if telemetry is enabled
     bool is_telemetry_enabled();
 
+    /// \returns the counters of messages checked against their cmd and var schemas
+    SchemaValidationStatistics get_schema_validation_statistics() const;
+
     ///
     /// \brief Chccks if all commands of a module that are listed in its manifest are available
     ///
@@ -178,24 +217,67 @@ public:
 private:
     MQTTAbstraction mqtt_abstraction;
     Config config;
+    std::shared_ptr<const ConfigSnapshot> config_snapshot; ///< indexed copy of the config for lookups from handlers
+    SchemaValidatorCache validators; ///< compiled schemas of cmd arguments, results and vars
     std::string module_id;
     std::map<std::string, std::set<std::string>> registered_cmds;
     bool ready_received;
     std::chrono::seconds remote_cmd_res_timeout;
-    bool validate_data_with_schema;
+    std::string call_id_prefix;
+    std::atomic<uint64_t> next_call_id{0};
+    PendingCalls pending_calls; ///< calls waiting for their result by call id
+    std::unique_ptr<const RoutingTable> routing; ///< routes to the implementations provided and required by the module
+    // NOTE: declared after routing, the coalescer flushes its last batches through it when destroyed
+    std::unique_ptr<VarCoalescer> var_coalescer; ///< only set if vars to coalesce are configured
+    std::unordered_set<const ImplementationRoute*> result_routers; ///< implementations with a registered result router
+    std::mutex result_routers_mutex;
     std::unique_ptr<std::function<void()>> on_ready;
     std::thread heartbeat_thread;
     std::string module_name;
     std::future<void> main_loop_end{};
     json module_manifest;
-    json module_classes;
     std::string mqtt_everest_prefix;
     std::string mqtt_external_prefix;
     std::string telemetry_prefix;
     std::optional<TelemetryConfig> telemetry_config;
     bool telemetry_enabled;
 
-    void handle_ready(json data);
+    void handle_ready(const json& data);
+
+    ///
+    /// \brief Registers one handler on the cmd topic of the given \p implementation that routes all results to the
+    /// pending calls, if not done yet
+    void register_result_router(const ImplementationRoute& implementation);
+
+    ///
+    /// \returns the connection of the requirement \p req, throws an EverestApiError if it is not connected
+    const ConnectionRoute& resolve_connection(const Requirement& req);
+
+    ///
+    /// \returns the implementation \p impl_id of this module, throws an EverestApiError if it is not provided
+    const ImplementationRoute& get_provided_implementation(const std::string& impl_id);
+
+    ///
+    /// \returns the cmd \p cmd_name of the given \p implementation, throws an EverestApiError if it does not declare
+    /// it. \p is_call tells whether the cmd is called or provided, for the error message
+    const CmdRoute& get_cmd_route(const ImplementationRoute& implementation, const std::string& cmd_name,
+                                  bool is_call);
+
+    ///
+    /// \brief Publishes the given \p vars of \p impl_id in one message with the highest QoS of them
+    void publish_var_batch(const std::string& impl_id, const VarBatch& vars);
+
+    ///
+    /// \brief Checks that the given \p implementation declares the var \p var_name and that \p value matches its schema
+    void check_var(const ImplementationRoute& implementation, const std::string& var_name, const json& value);
+
+    ///
+    /// \brief Checks the given \p args and publishes the call. The given \p add_pending_call is called with the call
+    /// id, a description and the timeout of the call before it is published
+    void send_cmd(const Requirement& req, const std::string& cmd_name, json& args,
+                  std::optional<std::chrono::milliseconds> timeout,
+                  const std::function<void(const std::string& call_id, const std::string& description,
+                                           std::chrono::milliseconds timeout)>& add_pending_call);
 
     void heartbeat();
 
@@ -12,6 +12,8 @@
 #include <framework/ModuleAdapter.hpp>
 #include <sys/prctl.h>
 
+#include <utils/mqtt_settings.hpp>
+#include <utils/schema_validator_cache.hpp>
 #include <utils/yaml_loader.hpp>
 
 #include <everest/compile_time_settings.hpp>
@@ -48,6 +50,8 @@ namespace defaults {
 //   interfaces_dir: ${DATAROOT_DIR}${EVEREST_NAMESPACE}/interfaces
 //   schemas_dir: ${DATAROOT_DIR}${EVEREST_NAMESPACE}/schemas
 //   configs_dir: ${SYSCONF_DIR}${EVEREST_NAMESPACE}
+//   cache_dir: ${LOCALSTATE_DIR}/cache/${EVEREST_NAMESPACE}
+//   mqtt_broker_socket_path of the embedded broker: ${LOCALSTATE_DIR}/run/${EVEREST_NAMESPACE}/mqtt.sock
 //
 //   config_path: ${SYSCONF_DIR}${EVEREST_NAMESPACE}/default.yaml
 //   logging_config_path: ${SYSCONF_DIR}${EVEREST_NAMESPACE}/default_logging.cfg
@@ -71,16 +75,40 @@ inline constexpr auto CONFIG_NAME = "default.yaml";
 inline constexpr auto LOGGING_CONFIG_NAME = "default_logging.cfg";
 
 inline constexpr auto WWW_DIR = "www";
+inline constexpr auto CACHE_DIR = "cache";
+inline constexpr auto RUN_DIR = "run";
+inline constexpr auto CONFIG_CACHE = true;
 
 inline constexpr auto CONTROLLER_PORT = 8849;
 inline constexpr auto CONTROLLER_RPC_TIMEOUT_MS = 2000;
 inline constexpr auto MQTT_BROKER_HOST = "localhost";
 inline constexpr auto MQTT_BROKER_PORT = 1883;
+inline constexpr auto MQTT_BROKER_SOCKET_PATH = "";
+inline constexpr auto MQTT_EMBEDDED_BROKER = false;
+inline constexpr auto MQTT_EMBEDDED_BROKER_BRIDGE = false;
+inline constexpr auto MQTT_EMBEDDED_BROKER_SOCKET_NAME = "mqtt.sock";
 inline constexpr auto MQTT_EVEREST_PREFIX = "everest";
 inline constexpr auto MQTT_EXTERNAL_PREFIX = "";
 inline constexpr auto TELEMETRY_PREFIX = "everest-telemetry";
 inline constexpr auto TELEMETRY_ENABLED = false;
 inline constexpr auto VALIDATE_SCHEMA = false;
+inline constexpr auto SCHEMA_VALIDATION_SAMPLE_FIRST = 100;
+inline constexpr auto SCHEMA_VALIDATION_SAMPLE_EVERY = 100;
+inline constexpr auto MESSAGE_HANDLER_THREADS = 0;
+inline constexpr auto MESSAGE_QUEUE_SIZE = 1024;
+inline constexpr auto MESSAGE_QUEUE_OVERFLOW_POLICY = "drop_oldest";
+inline constexpr auto MQTT_BUFFER_INITIAL_SIZE = 16 * 1024;
+inline constexpr auto MQTT_BUFFER_MAX_SIZE = 16 * 1024 * 1024;
+inline constexpr auto MQTT_RECONNECT_INITIAL_BACKOFF_MS = 100;
+inline constexpr auto MQTT_RECONNECT_MAX_BACKOFF_MS = 10000;
+inline constexpr auto MQTT_OFFLINE_QUEUE_SIZE = 1024;
+inline constexpr auto MQTT_SHARED_MEMORY_THRESHOLD = 0;
+inline constexpr auto MQTT_SHARED_MEMORY_MAX_SIZE = 64 * 1024 * 1024;
+inline constexpr auto MQTT_SHARED_MEMORY_LEASE_MS = 10000;
+inline constexpr auto MQTT_EVEREST_ENCODING = "json";
+inline constexpr auto MQTT_PUBLISH_QUEUE_SIZE = 1024;
+inline constexpr auto MQTT_PUBLISH_QUEUE_OVERFLOW_POLICY = "block";
+inline constexpr auto MQTT_PUBLISH_QUEUE_TIMEOUT_MS = 1000;
 
 } // namespace defaults
 
@@ -107,20 +135,42 @@ struct RuntimeSettings {
     fs::path logging_config_file;
     fs::path config_file;
     fs::path www_dir;
+    fs::path cache_dir;
+    bool config_cache; ///< whether loaded and validated config files are cached in cache_dir
     int controller_port;
     int controller_rpc_timeout_ms;
     std::string mqtt_broker_host;
     int mqtt_broker_port;
+    std::string mqtt_broker_socket_path;
+    bool mqtt_embedded_broker;
+    bool mqtt_embedded_broker_bridge;
     std::string mqtt_everest_prefix;
     std::string mqtt_external_prefix;
     std::string telemetry_prefix;
     bool telemetry_enabled;
+    int message_handler_threads;
+    int message_queue_size;
+    MessageQueueOverflowPolicy message_queue_overflow_policy;
+    int mqtt_buffer_initial_size;
+    int mqtt_buffer_max_size;
+    int mqtt_reconnect_initial_backoff_ms;
+    int mqtt_reconnect_max_backoff_ms;
+    int mqtt_offline_queue_size;
+    int mqtt_shared_memory_threshold;
+    int mqtt_shared_memory_max_size;
+    int mqtt_shared_memory_lease_ms;
+    PayloadEncoding mqtt_everest_encoding;
+    int mqtt_publish_queue_size;
+    PublishQueueOverflowPolicy mqtt_publish_queue_overflow_policy;
+    int mqtt_publish_queue_timeout_ms;
 
     std::string run_as_user;
 
     nlohmann::json config;
 
     bool validate_schema;
+    SchemaValidationSettings schema_validation; ///< how messages are checked, defaults to full validation if
+                                                ///< validate_schema is set and to no validation otherwise
 
     explicit RuntimeSettings(const std::string& prefix, const std::string& config);
 };
@@ -128,6 +178,12 @@ struct RuntimeSettings {
 // NOTE: this function needs the be called with a pre-initialized ModuleInfo struct
 void populate_module_info_path_from_runtime_settings(ModuleInfo&, std::shared_ptr<RuntimeSettings> rs);
 
+/// \returns the address of the MQTT broker configured in the given runtime settings \p rs, for log messages
+std::string get_mqtt_broker_address(const RuntimeSettings& rs);
+
+/// \returns the settings of the MQTT abstraction configured in the given runtime settings \p rs
+MQTTSettings get_mqtt_settings(const RuntimeSettings& rs);
+
 struct ModuleCallbacks {
     std::function<void(ModuleAdapter module_adapter)> register_module_adapter;
     std::function<std::vector<cmd>(const json& connections)> everest_register;
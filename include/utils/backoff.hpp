@@ -0,0 +1,40 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_BACKOFF_HPP
+#define UTILS_BACKOFF_HPP
+
+#include <chrono>
+#include <random>
+
+namespace Everest {
+
+///
+/// \brief Delays between retries of a failing operation that grow exponentially up to a maximum
+///
+/// Every delay is randomly shortened by up to half, so that many processes retrying the same operation, e.g. all
+/// modules reconnecting to a restarted broker, spread their attempts.
+///
+class Backoff {
+public:
+    ///
+    /// \brief Starts with delays of up to \p initial_delay that double after every attempt up to \p max_delay
+    Backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay);
+
+    ///
+    /// \returns the delay before the next attempt
+    std::chrono::milliseconds next();
+
+    ///
+    /// \brief Starts over with the initial delay, e.g. after the operation succeeded
+    void reset();
+
+private:
+    std::chrono::milliseconds initial_delay;
+    std::chrono::milliseconds max_delay;
+    std::chrono::milliseconds delay;
+    std::mt19937 random;
+};
+
+} // namespace Everest
+
+#endif // UTILS_BACKOFF_HPP
@@ -3,14 +3,17 @@
 #ifndef UTILS_CONFIG_HPP
 #define UTILS_CONFIG_HPP
 
+#include <cstdint>
 #include <filesystem>
 #include <list>
 #include <optional>
 #include <regex>
 #include <set>
 #include <string>
+#include <string_view>
 #include <tuple>
 #include <unordered_map>
+#include <vector>
 
 #include <nlohmann/json-schema.hpp>
 
@@ -18,6 +21,7 @@
 #include <utils/error.hpp>
 #include <utils/error/error_type_map.hpp>
 #include <utils/types.hpp>
+#include <utils/yaml_cache.hpp>
 
 namespace Everest {
 using json = nlohmann::json;
@@ -26,6 +30,7 @@ using json_validator = nlohmann::json_schema::json_validator;
 namespace fs = std::filesystem;
 
 struct RuntimeSettings;
+class ThreadPool;
 ///
 /// \brief A structure that contains all available schemas
 ///
@@ -75,18 +80,11 @@ private:
 
     ///
     /// \brief loads the contents of the interface file referenced by the give \p intf_name from disk and validates its
-    /// contents
+    /// contents, can be called from multiple threads at the same time
     ///
     /// \returns a json object containing the interface definition
     json load_interface_file(const std::string& intf_name);
 
-    ///
-    /// \brief resolves inheritance tree of json interface \p intf_name, throws an exception if variables or commands
-    /// would be overwritten
-    ///
-    /// \returns the resulting interface definiion
-    json resolve_interface(const std::string& intf_name);
-
     ///
     /// \brief extracts information about the provided module given via \p module_id from the config and manifest
     ///
@@ -106,10 +104,31 @@ private:
     std::unordered_map<std::string, std::string> module_names;
     std::unordered_map<std::string, ConfigCache> module_config_cache;
 
-    void load_and_validate_manifest(const std::string& module_id, const json& module_config);
+    ///
+    /// \brief loads the manifest of the module \p module_name and validates it and the default values of its config
+    /// entries, can be called from multiple threads at the same time
+    ///
+    /// \returns the validated manifest extended with default values
+    json load_manifest(const std::string& module_name);
+
+    ///
+    /// \brief sets up the interfaces and the config maps of the module \p module_id from the already loaded manifests
+    /// and interface definitions
+    void setup_module(const std::string& module_id, const json& module_config);
+
+    ///
+    /// \brief loads and validates all yaml files in \p directory with \p schema in parallel on the \p pool, \p kind is
+    /// either "type" or "error"
+    ///
+    /// \returns the declarations of all files by "/<file name without extension>"
+    json load_and_validate_directory(ThreadPool& pool, const fs::path& directory, const json& schema,
+                                     const std::string& kind);
 
     error::ErrorTypeMap error_map;
 
+    /// parsed and validated yaml files of previous runs, disabled for configs created from a blob
+    YamlCache yaml_cache;
+
     ///
     /// \brief loads and validates the given file \p file_path with the schema \p schema
     ///
@@ -126,6 +145,15 @@ public:
     explicit Config(std::shared_ptr<RuntimeSettings> rs);
     explicit Config(std::shared_ptr<RuntimeSettings> rs, bool manager);
 
+    ///
+    /// \brief creates a Config object from the \p blob created by serialize() of a config that was loaded from the same
+    /// config file, without loading and validating any files again
+    explicit Config(std::shared_ptr<RuntimeSettings> rs, std::string_view blob);
+
+    ///
+    /// \returns the fully resolved and validated config as a CBOR document that can be passed to Config(rs, blob)
+    std::vector<std::uint8_t> serialize() const;
+
     ///
     /// \brief checks if the given \p module_id provides the requirement given in \p requirement_id
     ///
@@ -139,8 +167,7 @@ public:
 
     ///
     /// \returns a json object that contains the main config
-    // FIXME (aw): this should be const and return the config by const ref!
-    json get_main_config();
+    const json& get_main_config() const;
 
     ///
     /// \returns a map of module config options
@@ -148,7 +175,7 @@ public:
 
     ///
     /// \returns a json object that contains the module config options
-    json get_module_json_config(const std::string& module_id);
+    const json& get_module_json_config(const std::string& module_id) const;
 
     ///
     /// \brief assemble basic information about the module (id, name,
@@ -163,15 +190,15 @@ public:
 
     ///
     /// \returns a json object that contains the manifests
-    const json& get_manifests();
+    const json& get_manifests() const;
 
     ///
     /// \returns a json object that contains the available interfaces
-    json get_interfaces();
+    const json& get_interfaces() const;
 
     ///
-    /// \returns a json object that contains the interface definition
-    json get_interface_definition(const std::string& interface_name);
+    /// \returns a json object that contains the interface definition, null if the interface is not known
+    const json& get_interface_definition(const std::string& interface_name) const;
 
     ///
     /// \brief turns then given \p module_id into a printable identifier
@@ -188,12 +215,12 @@ public:
     ///
     /// \brief turns the given \p module_id and \p impl_id into a mqtt prefix
     ///
-    std::string mqtt_prefix(const std::string& module_id, const std::string& impl_id);
+    std::string mqtt_prefix(const std::string& module_id, const std::string& impl_id) const;
 
     ///
     /// \brief turns the given \p module_id into a mqtt prefix
     ///
-    std::string mqtt_module_prefix(const std::string& module_id);
+    std::string mqtt_module_prefix(const std::string& module_id) const;
 
     ///
     /// \brief A json schema loader that can handle type refs and otherwise uses the builtin draft7 schema of
@@ -0,0 +1,72 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_CONFIG_BLOB_HPP
+#define UTILS_CONFIG_BLOB_HPP
+
+#include <cstddef>
+#include <memory>
+#include <string_view>
+
+#include <utils/config.hpp>
+
+namespace Everest {
+
+/// \brief Environment variable the manager passes the file descriptor of the config blob in to the modules it spawns
+constexpr auto CONFIG_BLOB_FD_ENV = "EV_CONFIG_BLOB_FD";
+
+///
+/// \brief A serialized config in a sealed, read-only memfd
+///
+/// The manager serializes the config it loaded and validated once and passes the file descriptor to all modules it
+/// spawns, so they only have to map and parse a single CBOR document instead of loading and validating all config,
+/// manifest, interface, type and error files again. The memfd is sealed against any modification before it is passed
+/// on and lives as long as a process still holds its file descriptor.
+///
+class ConfigBlob {
+public:
+    ///
+    /// \brief Serializes the given loaded \p config into a new sealed memfd
+    static ConfigBlob create(const Config& config);
+
+    ///
+    /// \brief Maps the sealed memfd \p fd read-only, the blob takes ownership of the file descriptor
+    static ConfigBlob open(int fd);
+
+    ~ConfigBlob();
+    ConfigBlob(ConfigBlob&& other) noexcept;
+    ConfigBlob(ConfigBlob const&) = delete;
+    void operator=(ConfigBlob const&) = delete;
+    void operator=(ConfigBlob&&) = delete;
+
+    ///
+    /// \brief Lets the program started next with exec() open the blob, must only be called in a forked child process
+    void pass_to_exec() const;
+
+    ///
+    /// \returns the file descriptor of the memfd
+    int get_fd() const;
+
+    ///
+    /// \returns the serialized config, empty if the blob was not mapped
+    std::string_view get_data() const;
+
+    ///
+    /// \returns the size of the serialized config in bytes
+    std::size_t get_size() const;
+
+private:
+    ConfigBlob(int fd, void* data, std::size_t size);
+
+    int fd;
+    void* data;
+    std::size_t size;
+};
+
+///
+/// \brief Loads the config of a module, from the blob passed by the manager in CONFIG_BLOB_FD_ENV if there is one and
+/// it was created from the config file in \p rs. Otherwise, or if the blob cannot be read, all files are loaded
+Config load_module_config(std::shared_ptr<RuntimeSettings> rs);
+
+} // namespace Everest
+
+#endif // UTILS_CONFIG_BLOB_HPP
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_CONFIG_SNAPSHOT_HPP
+#define UTILS_CONFIG_SNAPSHOT_HPP
+
+#include <map>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/config.hpp>
+
+namespace Everest {
+
+///
+/// \brief Immutable copy of a loaded Config that is indexed for lookups
+///
+/// Modules, their implementations and the interface definitions are indexed by id and name when the snapshot is
+/// created, together with their printable identifiers and MQTT prefixes. All accessors are const and return references
+/// into the snapshot, so it can be shared by multiple threads without locking and without copying json trees.
+///
+class ConfigSnapshot {
+public:
+    /// \brief An implementation provided by a module
+    struct Implementation {
+        std::string impl_id;
+        std::string interface_name;
+        std::string identifier;                    ///< The printable identifier of the implementation
+        std::string mqtt_prefix;                   ///< The MQTT prefix of its cmds, vars and errors
+        const json* interface{nullptr};            ///< The interface of the implementation with resolved errors
+        const json* interface_definition{nullptr}; ///< The definition of the interface, null json if it is unknown
+    };
+
+    /// \brief A module of the config
+    struct Module {
+        std::string module_id;
+        std::string module_name;
+        std::string identifier;        ///< The printable identifier of the module
+        std::string mqtt_prefix;       ///< The MQTT prefix of the module
+        const json* config{nullptr};   ///< The config of the module in the main config
+        const json* manifest{nullptr}; ///< The manifest of the module
+        /// The provided implementations by implementation id
+        std::map<std::string, Implementation> implementations;
+    };
+
+    ///
+    /// \brief Copies and indexes the given loaded \p config
+    explicit ConfigSnapshot(const Config& config);
+
+    ConfigSnapshot(ConfigSnapshot const&) = delete;
+    void operator=(ConfigSnapshot const&) = delete;
+
+    ///
+    /// \returns a json object that contains the main config
+    const json& get_main_config() const;
+
+    ///
+    /// \returns a json object that contains the manifests
+    const json& get_manifests() const;
+
+    ///
+    /// \returns a json object that contains the interfaces of all implementations by module name and implementation id
+    const json& get_interfaces() const;
+
+    ///
+    /// \returns all modules ordered by their module id
+    const std::vector<const Module*>& get_modules() const;
+
+    ///
+    /// \returns the module \p module_id, nullptr if the config does not contain it
+    const Module* find_module(const std::string& module_id) const;
+
+    ///
+    /// \returns the implementation \p impl_id of the module \p module_id, nullptr if there is no such implementation
+    const Implementation* find_implementation(const std::string& module_id, const std::string& impl_id) const;
+
+    ///
+    /// \returns the definition of the interface \p interface_name, nullptr if it is not known
+    const json* find_interface_definition(const std::string& interface_name) const;
+
+private:
+    json main;
+    json manifests;
+    json interfaces;
+    json interface_definitions;
+    std::unordered_map<std::string, Module> modules;
+    std::vector<const Module*> ordered_modules;
+    std::unordered_map<std::string, const json*> interface_definitions_by_name;
+};
+
+} // namespace Everest
+
+#endif // UTILS_CONFIG_SNAPSHOT_HPP
@@ -0,0 +1,155 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_EMBEDDED_BROKER_HPP
+#define UTILS_EMBEDDED_BROKER_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <map>
+#include <memory>
+#include <mutex>
+#include <set>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <utils/mqtt_abstraction.hpp>
+#include <utils/topic_trie.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+/// \brief Counters of the embedded MQTT broker
+struct EmbeddedBrokerStatistics {
+    uint64_t clients{0};                ///< Number of currently connected clients
+    uint64_t subscriptions{0};          ///< Number of distinct topic filters currently subscribed by clients
+    uint64_t messages_received{0};      ///< Number of messages published by clients
+    uint64_t messages_delivered{0};     ///< Number of messages delivered to subscribed clients
+    uint64_t messages_bridged{0};       ///< Number of messages forwarded to or received from the external broker
+    uint64_t messages_retransmitted{0}; ///< Number of QoS 1 and 2 messages sent again as they were not acknowledged
+    uint64_t clients_dropped{0};        ///< Number of clients disconnected for protocol errors or a too large backlog
+};
+
+///
+/// \brief A MQTT broker running in the manager, serving the modules of a single host on a unix domain socket
+///
+/// It implements the subset of MQTT 3.1.1 used by the MQTT abstraction: clean sessions, publishes with QoS 0, 1 and 2,
+/// subscriptions with "+" and "#" wildcards, pings and disconnects. Subscriptions are granted the QoS they request and
+/// messages are delivered with the QoS they were published with, at most the granted one. QoS 1 and 2 messages that a
+/// client does not acknowledge in time are sent again. No messages are retained and sessions are clean, so a client
+/// loses the messages not acknowledged yet when it disconnects or is disconnected because it does not keep up.
+///
+/// The socket is created in a directory that only the user and group of the broker can access, the directory is
+/// created if it does not exist yet.
+///
+/// With a bridge to an external broker, topics outside the everest prefix are forwarded to the external broker
+/// instead of being delivered locally, and subscriptions to such topics are subscribed on the external broker. The
+/// messages received for them are delivered on their own topic to every client with a matching subscription, once per
+/// client even if several of its subscriptions match.
+///
+class EmbeddedBroker {
+public:
+    ///
+    /// \brief Creates a broker for the unix domain socket at \p socket_path. Topics starting with \p everest_prefix
+    /// stay local, others are bridged via the optional, already connected \p bridge to an external broker
+    EmbeddedBroker(const std::string& socket_path, const std::string& everest_prefix,
+                   std::unique_ptr<MQTTAbstraction> bridge = nullptr);
+
+    ///
+    /// \brief Stops the broker, disconnects all clients and removes the socket
+    ~EmbeddedBroker();
+
+    EmbeddedBroker(EmbeddedBroker const&) = delete;
+    void operator=(EmbeddedBroker const&) = delete;
+
+    ///
+    /// \brief Starts listening on the socket, a stale socket file of a previous run is replaced
+    /// \returns false if the socket could not be set up
+    bool start();
+
+    ///
+    /// \brief Stops the broker and disconnects all clients
+    void stop();
+
+    ///
+    /// \returns a snapshot of the counters of the broker
+    EmbeddedBrokerStatistics get_statistics() const;
+
+private:
+    struct BridgedMessage {
+        std::string topic_filter; ///< the subscribed topic filter the bridge received the message for
+        std::string topic;
+        std::string payload;
+    };
+
+    using SubscribedClients = std::map<int, QOS>;                              ///< granted QoS of clients by socket
+    using Subscribers = std::map<std::string, SubscribedClients>::value_type; ///< a topic filter and its clients
+
+    /// \brief a QoS 1 or 2 message delivered to a client that was not acknowledged yet
+    struct InFlightMessage {
+        std::string packet;   ///< the PUBLISH packet, sent again with the DUP flag if it is not acknowledged in time
+        bool received{false}; ///< QoS 2 only: the PUBREC arrived, the PUBREL is sent again instead
+        std::chrono::steady_clock::time_point sent; ///< when the packet was sent the last time
+    };
+
+    struct Client {
+        int fd{-1};
+        bool connected{false};
+        bool disconnected{false}; ///< the client closed the connection itself
+        std::string in;
+        std::string out;
+        size_t out_offset{0};
+        std::set<std::string> subscriptions;
+        std::set<uint16_t> unreleased_packet_ids;      ///< QoS 2 publishes waiting for their PUBREL
+        std::map<uint16_t, InFlightMessage> in_flight; ///< delivered QoS 1 and 2 messages by their packet id
+        uint16_t last_packet_id{0};
+    };
+
+    std::string socket_path;
+    std::string everest_prefix;
+    std::unique_ptr<MQTTAbstraction> bridge;
+    std::map<std::string, Token> bridge_handlers; ///< handlers of the topic filters subscribed on the external broker
+
+    int listen_fd{-1};
+    int event_fd{-1};
+    std::atomic<bool> running{false};
+    std::thread thread;
+
+    std::map<int, Client> clients;                         ///< clients by their socket
+    std::map<std::string, SubscribedClients> subscribers;  ///< subscribed clients by topic filter
+    TopicTrie<const SubscribedClients*> subscriber_routes; ///< routes topics to their subscribed clients
+    TopicTrie<const Subscribers*> bridged_routes;          ///< routes external topics to their bridged topic filters
+    /// when the clients are checked for messages that were not acknowledged in time next
+    std::chrono::steady_clock::time_point next_retransmission;
+    std::vector<BridgedMessage> bridged_messages; ///< messages received by the bridge, not delivered yet
+    std::mutex bridged_messages_mutex;
+
+    std::atomic<uint64_t> client_count{0};
+    std::atomic<uint64_t> subscription_count{0};
+    std::atomic<uint64_t> messages_received{0};
+    std::atomic<uint64_t> messages_delivered{0};
+    std::atomic<uint64_t> messages_bridged{0};
+    std::atomic<uint64_t> messages_retransmitted{0};
+    std::atomic<uint64_t> clients_dropped{0};
+
+    void run();
+    void accept_clients();
+    bool read_client(Client& client);
+    bool write_client(Client& client);
+    bool handle_packet(Client& client, uint8_t header, std::string_view body);
+    void publish(const std::string& topic, std::string_view payload, QOS qos);
+    void deliver(int fd, std::string_view topic, std::string_view payload, QOS qos);
+    void retransmit(std::chrono::steady_clock::time_point now);
+    void subscribe(Client& client, const std::string& topic_filter, QOS qos);
+    void unsubscribe(Client& client, const std::string& topic_filter);
+    void drop_client(int fd);
+    void deliver_bridged_messages();
+    bool is_external(std::string_view topic) const;
+};
+
+} // namespace Everest
+
+#endif // UTILS_EMBEDDED_BROKER_HPP
@@ -5,6 +5,8 @@
 #define UTILS_ERROR_TYPE_MAP_HPP
 
 #include <filesystem>
+#include <map>
+#include <string>
 
 #include <utils/error.hpp>
 
@@ -30,6 +32,12 @@ public:
     ///
     explicit ErrorTypeMap(std::filesystem::path error_types_dir);
 
+    ///
+    /// \brief Constructor that takes already loaded error types.
+    /// \param error_types The descriptions of the error types by error type.
+    ///
+    explicit ErrorTypeMap(std::map<ErrorType, std::string> error_types);
+
     ///
     /// \brief Loads error types from a directory.
     /// \param error_types_dir The directory to load the error types from.
@@ -50,6 +58,12 @@ public:
     ///
     bool has(const ErrorType& error_type) const;
 
+    ///
+    /// \brief Gets all loaded error types.
+    /// \return The descriptions of all error types by error type.
+    ///
+    const std::map<ErrorType, std::string>& get_error_types() const;
+
 private:
     std::map<ErrorType, std::string> error_types;
 };
@@ -3,17 +3,24 @@
 #ifndef UTILS_MESSAGE_QUEUE_HPP
 #define UTILS_MESSAGE_QUEUE_HPP
 
+#include <atomic>
 #include <condition_variable>
 #include <functional>
 #include <map>
 #include <memory>
 #include <mutex>
 #include <queue>
+#include <string>
+#include <string_view>
 #include <thread>
 #include <unordered_set>
+#include <utility>
+#include <vector>
 
 #include <nlohmann/json.hpp>
 
+#include <utils/single_producer_ring.hpp>
+#include <utils/thread_pool.hpp>
 #include <utils/types.hpp>
 
 namespace Everest {
@@ -24,51 +31,111 @@ struct Message {
     std::string topic;   ///< The MQTT topic where this message originated from
     std::string payload; ///< The message payload
 
+    Message() = default;
     Message(const std::string& topic, const std::string& payload);
 };
 
+/// \brief Pool of reference counted messages, the buffers of released messages are reused for new messages
+class MessagePool {
+public:
+    /// \brief Creates a pool that keeps up to \p max_pooled_messages released messages for reuse
+    explicit MessagePool(size_t max_pooled_messages = 32);
+
+    /// \returns a message containing a copy of \p topic and \p payload. When the last reference to it is released
+    /// the message is returned to the pool
+    std::shared_ptr<Message> acquire(std::string_view topic, std::string_view payload);
+
+    /// \returns the number of heap allocations made for acquired messages, including their reference counts
+    uint64_t get_allocations() const;
+
+    /// \returns the number of acquired messages whose buffers were reused without growing them
+    uint64_t get_reuses() const;
+
+private:
+    struct Pool;
+    std::shared_ptr<Pool> pool;
+};
+
+/// \brief What MessageQueue::add() does when the queue is full
+enum class MessageQueueOverflowPolicy {
+    Block,      ///< Wait until the worker took a message out of the queue, this stalls the thread adding the message
+    DropOldest, ///< Drop the oldest queued message to make room for the new one
+    DropNewest  ///< Drop the new message
+};
+
 /// \brief Simple message queue that takes std::string messages, parsed them and dispatches them to handlers
+///
+/// Messages are passed to the worker thread through a bounded lock-free ring. The producer only wakes the worker up
+/// when the ring was empty before, so adding a message to a busy queue neither takes a lock nor makes a system call.
+/// Only one thread at a time may add messages.
 class MessageQueue {
 private:
-    std::thread worker_thread;
-    std::queue<std::shared_ptr<Message>> message_queue;
-    std::mutex queue_ctrl_mutex;
+    SingleProducerRing<std::shared_ptr<Message>> ring;
+    MessageQueueOverflowPolicy overflow_policy;
     std::function<void(std::shared_ptr<Message> message)> message_callback;
-    std::condition_variable cv;
-    bool running;
+    int wakeup_fd; ///< signalled when the ring gets non-empty or the queue is stopped
+    int space_fd;  ///< signalled when a blocked producer can continue
+    std::atomic<bool> producer_waiting{false};
+    std::atomic<bool> running;
+    std::atomic<uint64_t> dropped{0};
+    std::thread worker_thread;
+
+    void run();
+    void count_dropped_message();
 
 public:
-    /// \brief Creates a message queue with the provided \p message_callback
-    explicit MessageQueue(const std::function<void(std::shared_ptr<Message> message)>& message_callback);
+    /// \brief Creates a message queue with the provided \p message_callback holding at least \p capacity messages,
+    /// if it is full the given \p overflow_policy applies
+    explicit MessageQueue(const std::function<void(std::shared_ptr<Message> message)>& message_callback,
+                          size_t capacity = 1024,
+                          MessageQueueOverflowPolicy overflow_policy = MessageQueueOverflowPolicy::DropOldest);
     ~MessageQueue();
 
+    MessageQueue(MessageQueue const&) = delete;
+    void operator=(MessageQueue const&) = delete;
+
     /// \brief Adds a \p message to the message queue which will then be delivered to the message callback
     void add(std::shared_ptr<Message> message);
 
     /// \brief Stops the message queue
     void stop();
+
+    /// \returns the number of messages dropped because the queue was full
+    uint64_t get_dropped() const;
 };
 
 /// \brief Contains a message queue driven list of handler callbacks
+///
+/// Received messages are dispatched on a shared ThreadPool. Every MessageHandler acts as a serial strand, so messages
+/// of one topic are delivered to its handlers one after another and in the order they were received.
 class MessageHandler {
 private:
     std::unordered_set<std::shared_ptr<TypedHandler>> handlers;
-    std::thread handler_thread;
-    std::queue<std::shared_ptr<json>> message_queue;
+    ThreadPool& thread_pool;
+    std::queue<std::pair<std::shared_ptr<const json>, std::string>> message_queue; ///< messages and their topics
     std::mutex handler_ctrl_mutex;
     std::mutex handler_list_mutex;
-    std::condition_variable cv;
+    bool scheduled;
     bool running;
+    size_t non_result_handlers{0}; ///< number of registered handlers that are not HandlerType::Result
+
+    void run();
+    void dispatch(const json& data, const std::string& topic);
+    bool only_result_handlers();
 
 public:
-    /// \brief Creates the message handler
-    MessageHandler();
+    /// \brief Creates the message handler, dispatching messages on the given \p thread_pool
+    explicit MessageHandler(ThreadPool& thread_pool);
 
     /// \brief Destructor
     ~MessageHandler();
 
-    /// \brief Adds a \p message to the message queue which will be delivered to the registered handlers
-    void add(std::shared_ptr<json> message);
+    /// \brief Adds a \p message to the message queue which will be delivered to the registered handlers. The
+    /// parsed message is shared by all handlers and passed to them by const reference. Command results are delivered
+    /// directly if only HandlerType::Result handlers are registered, so callers waiting for a result never depend on a
+    /// free worker of the thread pool. The \p topic the
+    /// message was received on is only needed by HandlerType::ExternalMQTTWithTopic handlers
+    void add(std::shared_ptr<const json> message, std::string topic = "");
 
     /// \brief Stops the message handler
     void stop();
@@ -7,6 +7,8 @@
 
 #include <nlohmann/json.hpp>
 
+#include <utils/mqtt_settings.hpp>
+#include <utils/mqtt_statistics.hpp>
 #include <utils/types.hpp>
 
 namespace Everest {
@@ -22,6 +24,7 @@ class MQTTAbstraction {
 public:
     MQTTAbstraction(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
                     const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix);
+    explicit MQTTAbstraction(const MQTTSettings& mqtt_settings);
 
     // forbid copy assignment and copy construction
     MQTTAbstraction(MQTTAbstraction const&) = delete;
@@ -39,19 +42,19 @@ public:
 
     ///
     /// \copydoc MQTTAbstractionImpl::publish(const std::string&, const json&)
-    void publish(const std::string& topic, const json& json);
+    bool publish(const std::string& topic, const json& json);
 
     ///
     /// \copydoc MQTTAbstractionImpl::publish(const std::string&, const json&, QOS)
-    void publish(const std::string& topic, const json& json, QOS qos);
+    bool publish(const std::string& topic, const json& json, QOS qos);
 
     ///
     /// \copydoc MQTTAbstractionImpl::publish(const std::string&, const std::string&)
-    void publish(const std::string& topic, const std::string& data);
+    bool publish(const std::string& topic, const std::string& data);
 
     ///
     /// \copydoc MQTTAbstractionImpl::publish(const std::string&, const std::string&, QOS)
-    void publish(const std::string& topic, const std::string& data, QOS qos);
+    bool publish(const std::string& topic, const std::string& data, QOS qos);
 
     ///
     /// \copydoc MQTTAbstractionImpl::subscribe(const std::string&)
@@ -77,6 +80,10 @@ public:
     /// \copydoc MQTTAbstractionImpl::unregister_handler(const std::string&, const Token&)
     void unregister_handler(const std::string& topic, const Token& token);
 
+    ///
+    /// \copydoc MQTTAbstractionImpl::get_statistics()
+    MQTTStatistics get_statistics() const;
+
 private:
     std::unique_ptr<MQTTAbstractionImpl> mqtt_abstraction;
 };
@@ -3,24 +3,37 @@
 #ifndef UTILS_MQTT_ABSTRACTION_IMPL_HPP
 #define UTILS_MQTT_ABSTRACTION_IMPL_HPP
 
+#include <atomic>
+#include <condition_variable>
+#include <deque>
 #include <functional>
 #include <future>
 #include <map>
 #include <memory>
 #include <mutex>
+#include <optional>
+#include <string_view>
 #include <thread>
 #include <vector>
 
 #include <mqtt.h>
 #include <nlohmann/json.hpp>
 
+#include <utils/backoff.hpp>
 #include <utils/message_queue.hpp>
+#include <utils/mqtt_buffers.hpp>
+#include <utils/mqtt_event_loop.hpp>
+#include <utils/mqtt_settings.hpp>
+#include <utils/mqtt_statistics.hpp>
+#include <utils/publish_queue.hpp>
+#include <utils/shared_memory_transport.hpp>
+#include <utils/subscription_batch.hpp>
+#include <utils/thread_pool.hpp>
+#include <utils/topic_trie.hpp>
 #include <utils/types.hpp>
 
 #include <utils/thread.hpp>
 
-#define MQTT_BUF_SIZE 500 * 1024
-
 namespace Everest {
 using json = nlohmann::json;
 
@@ -36,35 +49,41 @@ struct MessageWithQOS : Message {
 ///
 class MQTTAbstractionImpl {
 public:
-    MQTTAbstractionImpl(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
-                        const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix);
+    explicit MQTTAbstractionImpl(const MQTTSettings& mqtt_settings);
     ~MQTTAbstractionImpl();
 
     MQTTAbstractionImpl(MQTTAbstractionImpl const&) = delete;
     void operator=(MQTTAbstractionImpl const&) = delete;
     ///
-    /// \brief connects to the mqtt broker using the MQTT_SERVER_ADDRESS AND MQTT_SERVER_PORT environment variables
+    /// \brief connects to the mqtt broker, via its unix domain socket if a socket path is configured and otherwise via
+    /// TCP to the configured host and port
     bool connect();
 
     ///
-    /// \brief disconnects from the mqtt broker
+    /// \brief disconnects from the mqtt broker, this also stops reconnecting if the connection was lost
     void disconnect();
 
     ///
     /// \brief publishes the given \p json on the given \p topic with QOS level 0
-    void publish(const std::string& topic, const json& json);
+    /// \returns false if the message was dropped because the publish queue was full
+    bool publish(const std::string& topic, const json& json);
 
     ///
     /// \brief publishes the given \p json on the given \p topic with the given \p qos
-    void publish(const std::string& topic, const json& json, QOS qos);
+    /// \returns false if the message was dropped because the publish queue was full
+    bool publish(const std::string& topic, const json& json, QOS qos);
 
     ///
     /// \brief publishes the given \p data on the given \p topic with QOS level 0
-    void publish(const std::string& topic, const std::string& data);
+    /// \returns false if the message was dropped because the publish queue was full
+    bool publish(const std::string& topic, const std::string& data);
 
     ///
-    /// \brief publishes the given \p data on the given \p topic with the given \p qos
-    void publish(const std::string& topic, const std::string& data, QOS qos);
+    /// \brief publishes the given \p data on the given \p topic with the given \p qos. The message is put into the
+    /// publish queue, from which the main loop hands it to MQTT-C, if the queue is full the configured overflow policy
+    /// applies
+    /// \returns false if the message was dropped because the publish queue was full
+    bool publish(const std::string& topic, const std::string& data, QOS qos);
 
     ///
     /// \brief subscribes to the given \p topic with QOS level 0
@@ -79,7 +98,9 @@ public:
     void unsubscribe(const std::string& topic);
 
     ///
-    /// \brief Spawn a thread running the mqtt main loop
+    /// \brief Spawn a thread running the mqtt main loop. If the connection to the broker is lost the main loop
+    /// reconnects with an exponential backoff, publishes made in the meantime are buffered and sent after the
+    /// subscriptions of all registered handlers were restored
     /// \returns a future, which will be fulfilled on thread termination
     std::future<void> spawn_main_loop_thread();
 
@@ -92,6 +113,10 @@ public:
     /// \brief unsubscribes a handler identified by its \p token from the given \p topic
     void unregister_handler(const std::string& topic, const Token& token);
 
+    ///
+    /// \returns a snapshot of the counters maintained by the MQTT abstraction
+    MQTTStatistics get_statistics() const;
+
     ///
     /// \brief checks if the given \p full_topic matches the given \p wildcard_topic that can contain "+" and "#"
     /// wildcards
@@ -100,38 +125,75 @@ public:
     static bool check_topic_matches(const std::string& full_topic, const std::string& wildcard_topic);
 
     ///
-    /// \brief callback that is called from the mqtt implementation whenever a message is received
-    static void publish_callback(void** unused, struct mqtt_response_publish* published);
+    /// \brief callback that is called from the mqtt implementation whenever a message is received, \p state points
+    /// to the receiving MQTTAbstractionImpl
+    static void publish_callback(void** state, struct mqtt_response_publish* published);
 
 private:
-    static constexpr int mqtt_poll_timeout_ms{100};
-    bool mqtt_is_connected;
+    static constexpr time_t mqtt_housekeeping_interval_s{5}; ///< longest time the main loop sleeps when idle
+    std::atomic<bool> mqtt_is_connected{false};
+    std::atomic<bool> disconnect_requested{false};
     std::map<std::string, MessageHandler> message_handlers;
+    TopicTrie<MessageHandler*> message_handler_routes; ///< routes external topics to their (wildcard) handlers
+    std::map<std::string, QOS> subscription_qos; ///< QoS of the subscribed topics, the highest of their handlers
+    SubscriptionBatch subscription_batch; ///< subscription changes of handlers waiting for the main loop
     std::mutex handlers_mutex;
+    // NOTE: declared before the message queue, so it outlives the worker reading received payloads from it
+    SharedMemoryTransport shared_memory; ///< hands large payloads on everest topics to modules on the same host
+    // NOTE: declared after the message handlers, so its workers are stopped before the message handlers get destroyed
+    ThreadPool handler_thread_pool;
+    MessagePool message_pool;
     MessageQueue message_queue;
-    std::vector<std::shared_ptr<MessageWithQOS>> messages_before_connected;
+    std::atomic<uint64_t> messages_received{0};
+    std::atomic<uint64_t> documents_parsed{0};
+    std::atomic<uint64_t> parse_errors{0};
+    PublishQueue publish_queue; ///< messages waiting for the main loop to hand them to MQTT-C
+    std::deque<std::shared_ptr<MessageWithQOS>> messages_before_connected; ///< publishes made while not connected
+    size_t offline_queue_size;
     std::mutex messages_before_connected_mutex;
-
-    Thread mqtt_mainloop_thread;
+    Backoff reconnect_backoff;
+    std::mutex reconnect_mutex;
+    std::condition_variable reconnect_cv;
+    std::atomic<uint64_t> connection_losses{0};
+    std::atomic<uint64_t> reconnects{0};
+    std::atomic<uint64_t> reconnect_attempts{0};
+    std::atomic<uint64_t> messages_buffered{0};
+    std::atomic<uint64_t> offline_messages_dropped{0};
+    std::atomic<uint64_t> last_outage_ms{0};
+    std::atomic<uint64_t> longest_outage_ms{0};
+    std::atomic<uint64_t> total_outage_ms{0};
 
     std::string mqtt_server_address;
     std::string mqtt_server_port;
+    std::string mqtt_server_socket_path;
     std::string mqtt_everest_prefix;
     std::string mqtt_external_prefix;
+    PayloadEncoding everest_encoding; ///< wire format of the payloads on everest topics, others are always json
     struct mqtt_client mqtt_client;
-    uint8_t sendbuf[MQTT_BUF_SIZE];
-    uint8_t recvbuf[MQTT_BUF_SIZE];
+    MQTTBuffers mqtt_buffers;
+    std::mutex mqtt_buffers_mutex; ///< guards the MQTT-C client while its buffers might be resized
+    MQTTEventLoop event_loop;
 
     static int open_nb_socket(const char* addr, const char* port);
-    bool connectBroker(const char* host, const char* port);
+    static int open_nb_unix_socket(const char* path);
+    bool connectBroker();
     void on_mqtt_message(std::shared_ptr<Message> message);
     void on_mqtt_connect();
-    static void on_mqtt_disconnect();
+    void on_mqtt_disconnect();
+    bool reconnect();
+    std::optional<std::string> share_payload(const std::string& topic, const std::string& data);
+    bool send_publish(const std::string& topic, std::string_view payload, QOS qos);
+    bool send_queued_publishes();
+    void send_subscription_changes();
 
     void notify_write_data();
 
     int mqtt_socket_fd{-1};
     int event_fd{-1};
+
+    // NOTE: declared last, so the main loop is joined before the buffers, the event loop and the queues it uses get
+    // destroyed
+    Thread mqtt_mainloop_thread;
 };
 } // namespace Everest
 
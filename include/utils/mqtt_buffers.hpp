@@ -0,0 +1,90 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_MQTT_BUFFERS_HPP
+#define UTILS_MQTT_BUFFERS_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+#include <mqtt.h>
+
+#include <utils/mqtt_statistics.hpp>
+
+namespace Everest {
+
+///
+/// \brief Growable send and receive buffers of a MQTT-C client
+///
+/// MQTT-C works on two caller provided buffers of fixed size. These buffers start small, grow on demand up to a
+/// maximum size and shrink back to their initial size once they were not needed for a while. Resizing moves the
+/// buffered data and adjusts the pointers MQTT-C keeps into the buffers, so the client must not be used concurrently.
+///
+class MQTTBuffers {
+public:
+    ///
+    /// \brief Creates buffers of \p initial_size bytes that can grow up to \p max_size bytes
+    MQTTBuffers(size_t initial_size, size_t max_size);
+
+    MQTTBuffers(MQTTBuffers const&) = delete;
+    void operator=(MQTTBuffers const&) = delete;
+
+    ///
+    /// \brief Initializes the given \p client with these buffers, see mqtt_init(). Anything left in the buffers from a
+    /// previous connection is discarded and grown buffers are shrunk back to their initial size
+    MQTTErrors init(struct mqtt_client& client, int socket_fd,
+                    void (*publish_callback)(void** state, struct mqtt_response_publish* publish));
+
+    ///
+    /// \brief Makes sure a message of \p size bytes can be queued in the send buffer of the \p client, leaving room for
+    /// the acknowledgements the client queues itself
+    /// \returns false if the message does not fit even into a send buffer of the maximum size
+    bool reserve_send_space(struct mqtt_client& client, size_t size);
+
+    ///
+    /// \returns whether a message of \p size bytes fits into an otherwise empty send buffer of the maximum size, if
+    /// reserve_send_space() fails for such a message it has to wait until the client sent enough of the buffer
+    bool fits_send_buffer(size_t size) const;
+
+    ///
+    /// \brief Recovers the \p client from an \p error of mqtt_sync() by growing the buffer that was too small
+    /// \returns true if the error was caused by a full buffer that could be grown, the client can then be used again
+    bool recover(struct mqtt_client& client, MQTTErrors error);
+
+    ///
+    /// \brief Shrinks buffers of the \p client back to their initial size if they were not grown for a while and their
+    /// contents fit
+    void shrink_if_idle(struct mqtt_client& client);
+
+    ///
+    /// \brief Counts a received message of \p size bytes for the high-water mark of the receive buffer
+    void count_received_message(size_t size);
+
+    ///
+    /// \returns the current sizes and the high-water marks of the buffers
+    BufferStatistics get_statistics() const;
+
+private:
+    size_t initial_size;
+    size_t max_size;
+    std::unique_ptr<uint8_t[]> send_buffer;
+    std::unique_ptr<uint8_t[]> receive_buffer;
+    std::atomic<size_t> send_buffer_size;
+    std::atomic<size_t> receive_buffer_size;
+    std::chrono::steady_clock::time_point last_grown;
+    std::atomic<uint64_t> send_buffer_high_water_mark{0};
+    std::atomic<uint64_t> receive_buffer_high_water_mark{0};
+    std::atomic<uint64_t> grows{0};
+    std::atomic<uint64_t> shrinks{0};
+
+    void resize_send_buffer(struct mqtt_client& client, size_t size);
+    void resize_receive_buffer(struct mqtt_client& client, size_t size);
+    /// \returns the size a buffer of \p current_size bytes grows to for \p required_size bytes and counts the growth
+    size_t grown_size(size_t current_size, size_t required_size);
+};
+
+} // namespace Everest
+
+#endif // UTILS_MQTT_BUFFERS_HPP
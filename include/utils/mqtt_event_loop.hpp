@@ -0,0 +1,78 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_MQTT_EVENT_LOOP_HPP
+#define UTILS_MQTT_EVENT_LOOP_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <ctime>
+
+#include <mqtt.h>
+
+#include <utils/mqtt_statistics.hpp>
+
+namespace Everest {
+
+///
+/// \brief Waits for the events the MQTT main loop has to handle, without waking up periodically
+///
+/// The main loop is woken up by data on the socket to the broker, by the socket becoming writable while MQTT-C has
+/// unsent data, by a notification that something was queued for sending and by a timer. The timer is armed for the
+/// earliest deadline of the MQTT-C client: its next keep-alive ping and the retransmission of unacknowledged messages.
+/// MQTT-C measures these deadlines in seconds of the realtime clock, so the timer uses the same clock.
+///
+class MQTTEventLoop {
+public:
+    ///
+    /// \brief Creates the epoll instance and the timer of the event loop
+    /// \throws EverestInternalError if they cannot be created
+    MQTTEventLoop();
+    ~MQTTEventLoop();
+
+    MQTTEventLoop(MQTTEventLoop const&) = delete;
+    void operator=(MQTTEventLoop const&) = delete;
+
+    ///
+    /// \brief Wakes up when the eventfd \p notify_fd gets written to
+    void watch_notify_fd(int notify_fd);
+
+    ///
+    /// \brief Watches \p socket_fd, the socket of a new connection to the broker. The socket of a previous connection
+    /// must already be closed
+    void watch_socket(int socket_fd);
+
+    ///
+    /// \brief Arms the timer for the next deadline of the \p client and watches for the socket becoming writable if the
+    /// client has unsent data. At the latest the loop wakes up after \p max_sleep_s seconds for housekeeping.
+    /// The caller has to make sure the client is not modified concurrently
+    void schedule(const struct mqtt_client& client, time_t max_sleep_s);
+
+    ///
+    /// \brief Waits for the next event
+    /// \returns true if the client has work to do, false if the wake-up was only for housekeeping
+    bool wait();
+
+    ///
+    /// \returns a snapshot of the wake-up counters
+    EventLoopStatistics get_statistics() const;
+
+private:
+    int epoll_fd{-1};
+    int timer_fd{-1};
+    int notify_fd{-1};
+    int socket_fd{-1};
+    bool socket_writable_watched{false};
+    time_t client_deadline{0};
+
+    std::atomic<uint64_t> wakeups{0};
+    std::atomic<uint64_t> socket_wakeups{0};
+    std::atomic<uint64_t> notify_wakeups{0};
+    std::atomic<uint64_t> timer_wakeups{0};
+    std::atomic<uint64_t> housekeeping_wakeups{0};
+
+    void watch_socket_events(uint32_t events);
+};
+
+} // namespace Everest
+
+#endif // UTILS_MQTT_EVENT_LOOP_HPP
@@ -0,0 +1,49 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_MQTT_SETTINGS_HPP
+#define UTILS_MQTT_SETTINGS_HPP
+
+#include <chrono>
+#include <cstddef>
+#include <string>
+
+#include <utils/message_queue.hpp>
+#include <utils/payload_encoding.hpp>
+#include <utils/publish_queue.hpp>
+
+namespace Everest {
+
+/// \brief Settings needed to connect to the MQTT broker and to tune the MQTT abstraction
+struct MQTTSettings {
+    std::string broker_host;     ///< The hostname of the MQTT broker
+    int broker_port = 0;         ///< The port the MQTT broker listens on
+    std::string everest_prefix;  ///< MQTT topic prefix for the "everest" topics
+    std::string external_prefix; ///< MQTT topic prefix for external topics
+    size_t handler_threads = 0;  ///< Number of threads dispatching received messages to handlers, 0 selects a number
+                                 ///< based on the available hardware
+    size_t message_queue_size = 1024; ///< Number of received messages that can wait for being parsed and dispatched
+    MessageQueueOverflowPolicy message_queue_overflow_policy =
+        MessageQueueOverflowPolicy::DropOldest; ///< What happens to received messages when the message queue is full,
+                                                ///< Block stalls the whole MQTT connection while the queue is full
+    size_t buffer_initial_size = 16 * 1024;    ///< Initial size of the MQTT send and receive buffers in bytes
+    size_t buffer_max_size = 16 * 1024 * 1024; ///< Size in bytes up to which the MQTT buffers can grow
+    std::string broker_socket_path; ///< Path of the unix domain socket of the MQTT broker, if set it is used instead
+                                    ///< of broker_host and broker_port
+    std::chrono::milliseconds reconnect_initial_backoff{100}; ///< Delay before the first attempt to reconnect
+    std::chrono::milliseconds reconnect_max_backoff{10000};   ///< Delay up to which the reconnect delays grow
+    size_t offline_queue_size = 1024; ///< Number of publishes buffered while not connected, the oldest are dropped
+    size_t shared_memory_threshold = 0; ///< Size in bytes from which payloads on everest topics are handed over via
+                                        ///< shared memory, 0 disables the shared memory transport
+    size_t shared_memory_max_size = 64 * 1024 * 1024; ///< Bytes a module holds at most in shared memory segments
+    std::chrono::milliseconds shared_memory_lease{10000}; ///< Time after which a shared memory segment is released
+                                                          ///< even if not all its readers have read it
+    PayloadEncoding everest_encoding = PayloadEncoding::Json; ///< Wire format of the payloads on everest topics
+    size_t publish_queue_size = 1024; ///< Number of published messages that can wait for being handed to MQTT-C
+    PublishQueueOverflowPolicy publish_queue_overflow_policy =
+        PublishQueueOverflowPolicy::Block; ///< What happens to published messages when the publish queue is full
+    std::chrono::milliseconds publish_queue_timeout{1000}; ///< How long a publisher waits for room in the full queue
+};
+
+} // namespace Everest
+
+#endif // UTILS_MQTT_SETTINGS_HPP
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_MQTT_STATISTICS_HPP
+#define UTILS_MQTT_STATISTICS_HPP
+
+#include <cstdint>
+
+namespace Everest {
+
+/// \brief Counters of the inbound message path, from the MQTT-C receive buffer to the handlers
+struct InboundMessageStatistics {
+    uint64_t messages_received{0};  ///< Number of messages received from the broker
+    uint64_t allocations{0};        ///< Number of heap allocations made for received messages and their buffers
+    uint64_t buffer_reuses{0};      ///< Number of messages that were copied into a reused, large enough buffer
+    uint64_t documents_parsed{0};   ///< Number of payloads parsed into a json document
+    uint64_t parse_errors{0};       ///< Number of payloads that could not be parsed
+    uint64_t messages_dropped{0};   ///< Number of messages dropped because the message queue was full
+};
+
+/// \brief Sizes of the MQTT send and receive buffers, which grow on demand and shrink back when idle
+struct BufferStatistics {
+    uint64_t send_buffer_size{0};               ///< Current size of the send buffer in bytes
+    uint64_t send_buffer_high_water_mark{0};    ///< Most bytes ever queued in the send buffer
+    uint64_t receive_buffer_size{0};            ///< Current size of the receive buffer in bytes
+    uint64_t receive_buffer_high_water_mark{0}; ///< Size in bytes of the largest message received
+    uint64_t grows{0};                          ///< Number of times a buffer was grown
+    uint64_t shrinks{0};                        ///< Number of times a buffer was shrunk back to its initial size
+};
+
+/// \brief Counters of the connection to the MQTT broker, which is reestablished automatically when it is lost
+struct ConnectionStatistics {
+    bool connected{false};          ///< Whether the connection is currently established
+    uint64_t connection_losses{0};  ///< Number of times the connection was lost
+    uint64_t reconnects{0};         ///< Number of times the connection was reestablished
+    uint64_t reconnect_attempts{0}; ///< Number of attempts to reestablish the connection
+    uint64_t messages_buffered{0};  ///< Number of publishes buffered while not connected
+    uint64_t messages_dropped{0};   ///< Number of buffered publishes dropped because the offline queue was full
+    uint64_t last_outage_ms{0};     ///< Duration of the last outage that ended in a reconnect in milliseconds
+    uint64_t longest_outage_ms{0};  ///< Duration of the longest outage that ended in a reconnect in milliseconds
+    uint64_t total_outage_ms{0};    ///< Duration of all outages that ended in a reconnect in milliseconds
+};
+
+/// \brief Counters of the wake-ups of the MQTT main loop
+struct EventLoopStatistics {
+    uint64_t wakeups{0};              ///< Number of times the main loop woke up
+    uint64_t socket_wakeups{0};       ///< Number of wake-ups because the socket to the broker was ready
+    uint64_t notify_wakeups{0};       ///< Number of wake-ups because data was queued for sending
+    uint64_t timer_wakeups{0};        ///< Number of wake-ups for a keep-alive or retransmission deadline
+    uint64_t housekeeping_wakeups{0}; ///< Number of wake-ups only to shrink buffers and release shared memory
+};
+
+/// \brief Counters of the shared memory transport of large payloads
+struct SharedMemoryStatistics {
+    uint64_t segments_published{0}; ///< Number of payloads published via shared memory
+    uint64_t segments_released{0};  ///< Number of segments released by the publisher
+    uint64_t segments_expired{0};   ///< Number of released segments that not all of their readers have read
+    uint64_t bytes_held{0};         ///< Number of bytes currently held in segments by the publisher
+    uint64_t publish_fallbacks{0};  ///< Number of large payloads published via the broker instead
+    uint64_t segments_read{0};      ///< Number of payloads read from shared memory
+    uint64_t segments_missed{0};    ///< Number of descriptors received after their segment was already released
+};
+
+/// \brief Counters of the queue of outgoing messages, which the MQTT main loop hands to MQTT-C
+struct PublishQueueStatistics {
+    uint64_t queue_depth{0};           ///< Number of messages currently waiting in the publish queue
+    uint64_t queue_high_water_mark{0}; ///< Most messages ever waiting in the publish queue
+    uint64_t messages_queued{0};       ///< Number of messages put into the publish queue
+    uint64_t messages_sent{0};         ///< Number of messages taken out of the publish queue and handed to MQTT-C
+    uint64_t queue_full{0};            ///< Number of publishes that found the publish queue full
+    uint64_t messages_dropped{0};      ///< Number of messages dropped or rejected because the publish queue was full
+    uint64_t send_buffer_full{0};      ///< Number of times queued messages had to wait for room in the send buffer
+};
+
+/// \brief Counters of the subscriptions of registered handlers, which are combined into few SUBSCRIBE packets
+struct SubscriptionStatistics {
+    uint64_t topics_subscribed{0};   ///< Number of topics subscribed to for registered handlers
+    uint64_t subscribe_packets{0};   ///< Number of SUBSCRIBE packets these topics were sent in
+    uint64_t unsubscribe_packets{0}; ///< Number of UNSUBSCRIBE packets sent for unregistered handlers
+};
+
+/// \brief Snapshot of the counters maintained by the MQTT abstraction
+struct MQTTStatistics {
+    InboundMessageStatistics inbound;     ///< Counters of the inbound message path
+    BufferStatistics buffers;             ///< Sizes of the MQTT send and receive buffers
+    ConnectionStatistics connection;      ///< Counters of the connection to the broker
+    SharedMemoryStatistics shared_memory; ///< Counters of the shared memory transport of large payloads
+    EventLoopStatistics event_loop;       ///< Wake-ups of the MQTT main loop
+    PublishQueueStatistics publish_queue; ///< Counters of the queue of outgoing messages
+    SubscriptionStatistics subscriptions; ///< Counters of the subscriptions of registered handlers
+};
+
+} // namespace Everest
+
+#endif // UTILS_MQTT_STATISTICS_HPP
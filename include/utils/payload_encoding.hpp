@@ -0,0 +1,54 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_PAYLOAD_ENCODING_HPP
+#define UTILS_PAYLOAD_ENCODING_HPP
+
+#include <cstddef>
+#include <string>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+
+/// \brief Wire format of the payloads on everest topics, all modules of a deployment have to use the same one
+enum class PayloadEncoding {
+    Json,       ///< json text, readable by any MQTT client
+    Cbor,       ///< Concise Binary Object Representation (RFC 8949)
+    MessagePack ///< MessagePack
+};
+
+///
+/// \returns \p data encoded in the given \p encoding
+std::string encode_payload(const json& data, PayloadEncoding encoding);
+
+///
+/// \brief Encodes CBOR and MessagePack payloads into one buffer that is reused for all of them, so that encoding does
+/// not allocate a new string per payload. Json text is produced by json::dump(). Every thread needs its own encoder
+class PayloadEncoder {
+public:
+    PayloadEncoder() = default;
+
+    PayloadEncoder(PayloadEncoder const&) = delete;
+    void operator=(PayloadEncoder const&) = delete;
+
+    ///
+    /// \returns \p data encoded in the given \p encoding, valid until the next call
+    const std::string& encode(const json& data, PayloadEncoding encoding);
+
+    ///
+    /// \brief Frees the buffer if an occasional large payload made it grow beyond \p max_size bytes
+    void shrink_to(std::size_t max_size);
+
+private:
+    std::string payload;
+};
+
+///
+/// \returns the payload between \p begin and \p end decoded from the given \p encoding
+/// \throws nlohmann::json::parse_error if the payload is not valid in this encoding
+json decode_payload(const char* begin, const char* end, PayloadEncoding encoding);
+
+} // namespace Everest
+
+#endif // UTILS_PAYLOAD_ENCODING_HPP
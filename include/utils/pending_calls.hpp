@@ -0,0 +1,97 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_PENDING_CALLS_HPP
+#define UTILS_PENDING_CALLS_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <future>
+#include <map>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <thread>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/types.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+
+///
+/// \brief Table of cmd calls waiting for their result
+///
+/// A call is completed either by its result or, once its timeout expired, by an EverestTimeoutError. Calls added
+/// with a future are completed directly on the thread delivering the result. Calls added with a callback are
+/// completed on the one thread owned by this table, so no thread has to wait for an outstanding call.
+///
+class PendingCalls {
+public:
+    ///
+    /// \brief Starts the thread running the callbacks and timeouts of the pending calls
+    PendingCalls();
+
+    ///
+    /// \brief Stops and joins the thread, futures of calls that are still pending get a broken promise
+    ~PendingCalls();
+
+    PendingCalls(PendingCalls const&) = delete;
+    void operator=(PendingCalls const&) = delete;
+
+    ///
+    /// \brief Adds a call with the given \p call_id that times out after \p timeout. The \p description is used in the
+    /// message of the timeout error
+    /// \returns a future that becomes ready with the result
+    std::future<json> add(const std::string& call_id, const std::string& description,
+                          std::chrono::milliseconds timeout);
+
+    ///
+    /// \brief Adds a call with the given \p call_id that times out after \p timeout. The given \p callback is called
+    /// once, either with the result or with the timeout error
+    void add(const std::string& call_id, const std::string& description, std::chrono::milliseconds timeout,
+             CmdResultCallback callback);
+
+    ///
+    /// \brief Completes the call with the given \p call_id with the given \p result
+    /// \returns false if there is no such call, e.g. because it already timed out
+    bool complete(const std::string& call_id, json result);
+
+    ///
+    /// \brief Completes the call with the given \p call_id with the given \p error instead of waiting for its timeout
+    /// \returns false if there is no such call
+    bool fail(const std::string& call_id, std::exception_ptr error);
+
+    ///
+    /// \returns the number of calls waiting for their result
+    size_t size() const;
+
+private:
+    using Deadlines = std::multimap<std::chrono::steady_clock::time_point, std::string>;
+
+    struct Call {
+        std::optional<std::promise<json>> promise;
+        CmdResultCallback callback;
+        std::string description;
+        Deadlines::iterator deadline;
+    };
+
+    std::unordered_map<std::string, Call> calls;
+    Deadlines deadlines;                        ///< call ids by deadline, the earliest first
+    std::deque<std::function<void()>> callbacks; ///< callbacks of completed calls that did not run yet
+    mutable std::mutex calls_mutex;
+    std::condition_variable calls_cv;
+    bool running{true};
+    std::thread thread;
+
+    void insert(const std::string& call_id, Call call, std::chrono::milliseconds timeout);
+    void finish(Call& call, json result, std::exception_ptr error);
+    void run();
+};
+
+} // namespace Everest
+
+#endif // UTILS_PENDING_CALLS_HPP
@@ -0,0 +1,107 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_PUBLISH_QUEUE_HPP
+#define UTILS_PUBLISH_QUEUE_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <vector>
+
+#include <utils/mqtt_statistics.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+/// \brief What PublishQueue::push() does when the queue is full
+enum class PublishQueueOverflowPolicy {
+    Block,         ///< Wait until the I/O thread took a message out of the queue, at most for the block timeout
+    FailFast,      ///< Reject the new message right away
+    DropOldestQoS0 ///< Drop the oldest queued QoS 0 message, new messages with a higher QoS wait like with Block
+};
+
+/// \brief A message waiting in the PublishQueue to be handed to MQTT-C
+struct QueuedPublish {
+    std::string topic;   ///< The MQTT topic to publish on
+    std::string payload; ///< The message payload
+    QOS qos{QOS::QOS0};  ///< The QoS level to publish with
+};
+
+///
+/// \brief Bounded queue of outgoing messages, filled by the publishing threads and drained by the MQTT I/O thread
+///
+/// Publishing threads only copy their message into the queue, they never wait for the MQTT-C client. The I/O thread
+/// takes messages out of the queue as long as they fit into the send buffer of the client. While the send buffer is
+/// full the messages wait in the queue, and only once the queue is full as well the overflow policy applies.
+/// The messages are stored in a fixed number of slots whose buffers are reused, so queueing a message does not allocate
+/// once the slots are large enough.
+///
+class PublishQueue {
+public:
+    ///
+    /// \brief Creates a queue holding up to \p capacity messages, if it is full the given \p overflow_policy applies.
+    /// Blocked publishers give up after \p block_timeout
+    PublishQueue(size_t capacity, PublishQueueOverflowPolicy overflow_policy, std::chrono::milliseconds block_timeout);
+
+    PublishQueue(PublishQueue const&) = delete;
+    void operator=(PublishQueue const&) = delete;
+
+    ///
+    /// \brief Queues a copy of the message with the given \p topic, \p payload and \p qos
+    /// \returns false if the message was dropped because the queue was full or stopped
+    bool push(std::string_view topic, std::string_view payload, QOS qos);
+
+    ///
+    /// \brief Queues a copy of the message like push(), but never waits for room in a full queue. Can be called while
+    /// holding locks the draining thread needs
+    /// \returns false if the message was dropped because the queue was full or stopped
+    bool try_push(std::string_view topic, std::string_view payload, QOS qos);
+
+    ///
+    /// \brief Passes the queued messages in order to \p send until the queue is empty or \p send returns false, which
+    /// leaves that message at the front of the queue. Only one thread at a time may drain the queue
+    /// \returns the number of messages taken out of the queue
+    size_t drain(const std::function<bool(const QueuedPublish& message)>& send);
+
+    ///
+    /// \brief Wakes up all blocked publishers and rejects all further messages
+    void stop();
+
+    ///
+    /// \returns the current depth of the queue and its counters
+    PublishQueueStatistics get_statistics() const;
+
+private:
+    std::vector<QueuedPublish> slots;
+    size_t head{0};                ///< slot of the oldest queued message
+    size_t count{0};               ///< number of queued messages
+    bool front_in_use{false};      ///< whether drain() currently passes the front message to its callback
+    bool stopped{false};
+    PublishQueueOverflowPolicy overflow_policy;
+    std::chrono::milliseconds block_timeout;
+    mutable std::mutex mutex;
+    std::condition_variable space_cv;
+
+    uint64_t high_water_mark{0};
+    uint64_t messages_queued{0};
+    uint64_t messages_sent{0};
+    uint64_t queue_full{0};
+    uint64_t messages_dropped{0};
+    uint64_t send_buffer_full{0};
+
+    QueuedPublish& slot(size_t index);
+    bool enqueue(std::string_view topic, std::string_view payload, QOS qos, bool may_wait);
+    /// \brief Drops the oldest queued QoS 0 message that is not in use by drain()
+    /// \returns false if there is no such message
+    bool drop_oldest_qos0();
+    void count_dropped_message();
+};
+
+} // namespace Everest
+
+#endif // UTILS_PUBLISH_QUEUE_HPP
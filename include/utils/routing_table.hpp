@@ -0,0 +1,105 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_ROUTING_TABLE_HPP
+#define UTILS_ROUTING_TABLE_HPP
+
+#include <chrono>
+#include <map>
+#include <memory>
+#include <optional>
+#include <set>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+#include <utils/config.hpp>
+#include <utils/schema_validator_cache.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+/// \brief Everything needed to call or to provide a cmd of an implementation
+struct CmdRoute {
+    const json* definition{nullptr};      ///< The definition of the cmd in the interface
+    std::set<std::string> argument_names; ///< The names of the arguments declared in the interface
+    std::map<std::string, std::shared_ptr<const SchemaValidator>> argument_validators; ///< Only set if validation is on
+    std::shared_ptr<const SchemaValidator> result_validator; ///< Only set if validation is on and a result is declared
+    QOS qos{QOS::QOS2};                                      ///< The QoS of calls and results
+    std::string description;                                 ///< "<printable identifier>-><cmd>()" for log messages
+};
+
+/// \brief Everything needed to publish or to subscribe to a var of an implementation
+struct VarRoute {
+    const json* definition{nullptr};                  ///< The definition of the var in the interface
+    std::shared_ptr<const SchemaValidator> validator; ///< Only set if validation is on
+    QOS qos{QOS::QOS2};                               ///< The QoS the var is published with
+    bool coalesce{false};                             ///< Whether the var is listed in the var_coalescing config
+};
+
+/// \brief The topics, cmds and vars of one implementation of a module
+struct ImplementationRoute {
+    std::string module_id;
+    std::string impl_id;
+    std::string identifier; ///< The printable identifier of the implementation
+    std::string cmd_topic;
+    std::string var_topic;
+    QOS result_qos{QOS::QOS0}; ///< The highest QoS of all cmds, results of all cmds are received on one topic
+    json interface;            ///< The interface definition the definitions of cmds and vars point into
+    std::unordered_map<std::string, CmdRoute> cmds;
+    std::unordered_map<std::string, VarRoute> vars;
+};
+
+/// \brief A connection of a requirement to an implementation of another module
+struct ConnectionRoute {
+    const ImplementationRoute* implementation{nullptr};
+    std::optional<std::chrono::milliseconds> cmd_timeout; ///< The cmd_timeout_ms configured for the connection
+};
+
+///
+/// \brief Immutable table of the implementations a module provides and the ones its requirements are connected to
+///
+/// Resolving a requirement, formatting topics and identifiers and looking up the cmd and var definitions and their
+/// QoS in the config is done once when the table is built, so calling cmds and publishing vars only needs a few hash
+/// lookups. The table is built after the config was loaded and is not changed afterwards, so it can be read by multiple
+/// threads without locking.
+///
+class RoutingTable {
+public:
+    ///
+    /// \brief Builds the routes of the module \p module_id from the given \p config. The schemas of all cmds and vars
+    /// are compiled with the given \p validators if validation is enabled. The mqtt_qos config of the module overrides
+    /// the QoS declared in the interfaces, its var_coalescing config selects the vars that are coalesced
+    RoutingTable(Config& config, const std::string& module_id, SchemaValidatorCache& validators);
+
+    RoutingTable(RoutingTable const&) = delete;
+    void operator=(RoutingTable const&) = delete;
+
+    ///
+    /// \returns the connection of the requirement \p req, nullptr if it is not connected. The index of a requirement
+    /// with exactly one connection is ignored
+    const ConnectionRoute* find_connection(const Requirement& req) const;
+
+    ///
+    /// \returns the implementation \p impl_id provided by the module itself, nullptr if it does not provide it
+    const ImplementationRoute* find_implementation(const std::string& impl_id) const;
+
+private:
+    struct RequirementRoute {
+        std::vector<ConnectionRoute> connections;
+        bool single{false}; ///< whether the requirement has exactly one connection, its index is ignored then
+    };
+
+    /// implementations by module id and implementation id, both provided and required ones
+    std::map<std::pair<std::string, std::string>, ImplementationRoute> implementations;
+    std::unordered_map<std::string, const ImplementationRoute*> provided;
+    std::unordered_map<std::string, RequirementRoute> requirements;
+
+    const ImplementationRoute& add_implementation(Config& config, const json& interfaces, const json& main_config,
+                                                  SchemaValidatorCache& validators, const std::string& module_id,
+                                                  const std::string& impl_id);
+};
+
+} // namespace Everest
+
+#endif // UTILS_ROUTING_TABLE_HPP
@@ -0,0 +1,132 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SCHEMA_VALIDATOR_CACHE_HPP
+#define UTILS_SCHEMA_VALIDATOR_CACHE_HPP
+
+#include <atomic>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <unordered_map>
+#include <vector>
+
+#include <nlohmann/json-schema.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+using json_uri = nlohmann::json_uri;
+using json_validator = nlohmann::json_schema::json_validator;
+
+/// \brief How thoroughly messages are checked against the schemas of cmds and vars
+enum class SchemaValidationMode {
+    Off,      ///< Messages are not checked at all
+    Full,     ///< Every message is validated against its schema
+    Sampled,  ///< The first messages of every cmd and var are validated, afterwards only every nth message
+    TypeOnly, ///< Only the json type of a message and the presence of required properties are checked, $refs to
+              ///< other schemas are followed. Messages whose schema has neither are counted as skipped
+};
+
+/// \brief Settings of the per-message schema validation
+struct SchemaValidationSettings {
+    SchemaValidationMode mode = SchemaValidationMode::Off;
+    uint64_t sample_first = 100; ///< Sampled: number of messages per cmd and var that are always validated
+    uint64_t sample_every = 100; ///< Sampled: afterwards only every nth message is validated
+};
+
+/// \brief Counters of the per-message schema validation
+struct SchemaValidationStatistics {
+    uint64_t validated{0};    ///< Number of messages validated against their full schema
+    uint64_t type_checked{0}; ///< Number of messages of which only the type was checked
+    uint64_t skipped{0};      ///< Number of messages that were not checked
+};
+
+///
+/// \brief Checks messages against one compiled json schema according to the configured SchemaValidationMode
+///
+class SchemaValidator {
+public:
+    struct Counters {
+        std::atomic<uint64_t> validated{0};
+        std::atomic<uint64_t> type_checked{0};
+        std::atomic<uint64_t> skipped{0};
+    };
+
+    ///
+    /// \brief Prepares checking messages against \p schema. The schema is only compiled if the mode of the given
+    /// \p settings needs it. Throws if it cannot be compiled
+    SchemaValidator(const json& schema, const SchemaValidationSettings& settings,
+                    const std::function<void(const json_uri& uri, json& schema)>& loader,
+                    const std::function<void(const std::string& format, const std::string& value)>& format_checker,
+                    std::shared_ptr<Counters> counters);
+
+    ///
+    /// \brief Checks the given \p value, throws if it does not match the schema
+    void validate(const json& value) const;
+
+private:
+    SchemaValidationSettings settings;
+    std::optional<json_validator> validator;
+    std::vector<json::value_t> types;   ///< allowed json types, empty if any type is allowed
+    std::vector<std::string> required; ///< required properties of objects
+    std::shared_ptr<Counters> counters;
+    mutable std::atomic<uint64_t> messages{0};
+
+    void check_type(const json& value) const;
+};
+
+///
+/// \brief Caches compiled json schema validators, so a schema and its $refs are only resolved once
+///
+/// Validators are identified by a key chosen by the user, e.g. "module/impl/var/name". Returned validators are
+/// immutable and can be shared by multiple threads.
+///
+class SchemaValidatorCache {
+public:
+    using SchemaLoader = std::function<void(const json_uri& uri, json& schema)>;
+    using FormatChecker = std::function<void(const std::string& format, const std::string& value)>;
+
+    ///
+    /// \brief Creates a cache whose validators resolve $refs with the given \p loader and check formats with the
+    /// given \p format_checker. The validators check messages according to the given \p settings
+    SchemaValidatorCache(SchemaLoader loader, FormatChecker format_checker,
+                         SchemaValidationSettings settings = {SchemaValidationMode::Full});
+
+    SchemaValidatorCache(SchemaValidatorCache const&) = delete;
+    void operator=(SchemaValidatorCache const&) = delete;
+
+    ///
+    /// \returns the validator stored under \p key, compiling the given \p schema into a new validator if there is none
+    /// yet. Throws if the \p schema cannot be compiled
+    std::shared_ptr<const SchemaValidator> get(const std::string& key, const json& schema);
+
+    ///
+    /// \returns true if messages are checked at all, i.e. the validation mode is not SchemaValidationMode::Off
+    bool is_enabled() const;
+
+    ///
+    /// \brief Counts a message that was not checked because validation is off
+    void count_skipped();
+
+    ///
+    /// \returns the number of cached validators
+    size_t size() const;
+
+    ///
+    /// \returns a snapshot of the validation counters of all validators of this cache
+    SchemaValidationStatistics get_statistics() const;
+
+private:
+    SchemaLoader loader;
+    FormatChecker format_checker;
+    SchemaValidationSettings settings;
+    std::shared_ptr<SchemaValidator::Counters> counters;
+    mutable std::mutex validators_mutex;
+    std::unordered_map<std::string, std::shared_ptr<const SchemaValidator>> validators;
+};
+
+} // namespace Everest
+
+#endif // UTILS_SCHEMA_VALIDATOR_CACHE_HPP
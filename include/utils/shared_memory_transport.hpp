@@ -0,0 +1,136 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SHARED_MEMORY_TRANSPORT_HPP
+#define UTILS_SHARED_MEMORY_TRANSPORT_HPP
+
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <deque>
+#include <memory>
+#include <mutex>
+#include <optional>
+#include <string>
+#include <string_view>
+#include <unordered_map>
+
+#include <nlohmann/json.hpp>
+
+#include <utils/mqtt_statistics.hpp>
+#include <utils/payload_encoding.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+
+///
+/// \brief Hands large payloads over to modules on the same host via POSIX shared memory instead of the MQTT broker
+///
+/// The publisher copies a payload into a shared memory segment of its own and publishes a small descriptor instead of
+/// the payload. Subscribers map the segment and parse the payload in place, so it is neither copied through the
+/// broker nor into the MQTT receive buffers.
+///
+/// Every process that subscribes to a topic registers itself as a reader of the topic in a small shared registry. A
+/// segment starts with the number of readers registered when it was published, every registered reader counts it down
+/// once it mapped the segment and the publisher releases the segment when the count reached zero. A slow reader
+/// therefore still finds the payload, just as the QoS of the descriptor promises. The lease only bounds how long a
+/// segment is held for readers that never read it, e.g. because they crashed. Readers that receive a descriptor
+/// without being registered for its exact topic, e.g. via a wildcard subscription, read the segment while it is held.
+///
+class SharedMemoryTransport {
+public:
+    ///
+    /// \brief Creates a transport for payloads of at least \p threshold bytes, 0 disables it. At most \p max_size bytes
+    /// are held in segments, larger payloads fall back to being published via the broker. Segments that were not read
+    /// by all their readers are released \p lease after they were published
+    SharedMemoryTransport(size_t threshold, size_t max_size,
+                          std::chrono::milliseconds lease = std::chrono::milliseconds(10000));
+
+    ///
+    /// \brief Releases all segments that are still held and the registrations of this process as a reader
+    ~SharedMemoryTransport();
+
+    SharedMemoryTransport(SharedMemoryTransport const&) = delete;
+    void operator=(SharedMemoryTransport const&) = delete;
+
+    ///
+    /// \returns true if a payload of \p size bytes should be handed over via shared memory
+    bool accepts(size_t size) const;
+
+    ///
+    /// \brief Registers this process as a reader of the segments published on \p topic from now on. Has to be called
+    /// before the topic is subscribed, does nothing if the transport is disabled
+    void subscribe(const std::string& topic);
+
+    ///
+    /// \brief Removes the registration of this process as a reader of the segments published on \p topic
+    void unsubscribe(const std::string& topic);
+
+    ///
+    /// \brief Copies \p data published on \p topic into a new segment and releases the segments that are no longer
+    /// needed
+    /// \returns the descriptor to publish instead of \p data or std::nullopt if the payload has to be published via
+    /// the broker, which is also the case if no reader is registered for \p topic
+    std::optional<std::string> publish(const std::string& topic, std::string_view data);
+
+    ///
+    /// \brief Releases the segments that were read by all their readers or whose lease has ended
+    void release_segments();
+
+    ///
+    /// \returns true if \p payload is a descriptor of a segment and not a payload itself
+    static bool is_descriptor(std::string_view payload);
+
+    ///
+    /// \brief Maps the segment referenced by \p descriptor, which was received on \p topic, and decodes the payload
+    /// in place from the given \p encoding
+    /// \returns the decoded payload or nullptr if the segment is no longer available
+    /// \throws nlohmann::json::parse_error if the payload is not valid in this encoding
+    std::shared_ptr<const json> read(const std::string& topic, std::string_view descriptor, PayloadEncoding encoding);
+
+    ///
+    /// \returns a snapshot of the counters of the transport
+    SharedMemoryStatistics get_statistics() const;
+
+private:
+    struct Segment {
+        std::string name;
+        size_t size;
+        std::chrono::steady_clock::time_point expires;
+        void* mapping; ///< the whole segment including its header, mapped until the segment is released
+    };
+
+    struct Registration {
+        std::atomic<uint64_t>* readers; ///< the mapped registry of the topic
+        uint32_t sequence;              ///< the registration sequence number of this process in the registry
+    };
+
+    size_t threshold;
+    size_t max_size;
+    std::chrono::milliseconds lease;
+    std::string name_prefix;
+    uint64_t next_segment{0};
+    std::deque<Segment> segments; ///< segments held by this publisher, oldest first
+    std::mutex segments_mutex;
+    std::atomic<uint64_t> bytes_held{0};
+    std::unordered_map<std::string, std::atomic<uint64_t>*> publish_registries; ///< registries of the published topics
+    std::unordered_map<std::string, Registration> registrations; ///< registrations of this process by topic
+    std::mutex registrations_mutex;
+
+    std::atomic<uint64_t> segments_published{0};
+    std::atomic<uint64_t> segments_released{0};
+    std::atomic<uint64_t> segments_expired{0};
+    std::atomic<uint64_t> publish_fallbacks{0};
+    std::atomic<uint64_t> segments_read{0};
+    std::atomic<uint64_t> segments_missed{0};
+
+    /// \brief releases the segments that are no longer needed, the caller has to hold the segments_mutex
+    void release_segments_locked(std::chrono::steady_clock::time_point now);
+
+    /// \returns the registry of readers of \p topic mapped into this process, nullptr if it cannot be opened
+    static std::atomic<uint64_t>* map_registry(const std::string& topic);
+};
+
+} // namespace Everest
+
+#endif // UTILS_SHARED_MEMORY_TRANSPORT_HPP
@@ -0,0 +1,114 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SINGLE_PRODUCER_RING_HPP
+#define UTILS_SINGLE_PRODUCER_RING_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <memory>
+#include <optional>
+
+namespace Everest {
+
+///
+/// \brief Bounded lock-free ring buffer with a single producer and any number of consumers
+///
+/// Only one thread at a time may call push() and was_empty_before_push(). pop() may be called by any thread, also
+/// concurrently with each other and with push(): every slot carries a sequence number (like the bounded queue by
+/// D. Vyukov) and the read position is claimed with a compare-and-swap, so every element is taken out exactly once.
+/// This lets the producer take the oldest element out of a full ring while the consumer is popping as well, which
+/// implements a drop-oldest overflow policy without any lock.
+///
+template <typename T> class SingleProducerRing {
+public:
+    ///
+    /// \brief Creates a ring with room for at least \p capacity elements, the capacity is rounded up to a power of two
+    explicit SingleProducerRing(size_t capacity) {
+        size_t rounded_capacity = 2;
+        while (rounded_capacity < capacity) {
+            rounded_capacity *= 2;
+        }
+        this->mask = rounded_capacity - 1;
+        this->slots = std::make_unique<Slot[]>(rounded_capacity);
+        for (size_t i = 0; i < rounded_capacity; i++) {
+            this->slots[i].sequence.store(i, std::memory_order_relaxed);
+        }
+    }
+
+    SingleProducerRing(SingleProducerRing const&) = delete;
+    void operator=(SingleProducerRing const&) = delete;
+
+    ///
+    /// \brief Appends \p value to the ring
+    /// \returns false if the ring is full, \p value is left untouched in that case
+    bool push(T& value) {
+        const auto position = this->write_position.load(std::memory_order_relaxed);
+        auto& slot = this->slots[position & this->mask];
+        if (slot.sequence.load(std::memory_order_acquire) != position) {
+            return false;
+        }
+        slot.value = std::move(value);
+        // sequentially consistent, so a following was_empty_before_push() and the consumer agree on the ring state
+        slot.sequence.store(position + 1, std::memory_order_seq_cst);
+        this->write_position.store(position + 1, std::memory_order_relaxed);
+        return true;
+    }
+
+    ///
+    /// \brief Takes the oldest element out of the ring, may be called by any thread
+    /// \returns the element or std::nullopt if the ring is empty
+    std::optional<T> pop() {
+        auto position = this->read_position.load(std::memory_order_relaxed);
+        while (true) {
+            auto& slot = this->slots[position & this->mask];
+            const auto sequence = slot.sequence.load(std::memory_order_seq_cst);
+            if (sequence < position + 1) {
+                return std::nullopt;
+            }
+            if (sequence == position + 1) {
+                if (this->read_position.compare_exchange_weak(position, position + 1, std::memory_order_seq_cst,
+                                                              std::memory_order_relaxed)) {
+                    std::optional<T> value(std::move(slot.value));
+                    slot.value = T();
+                    slot.sequence.store(position + this->mask + 1, std::memory_order_release);
+                    return value;
+                }
+            } else {
+                // somebody else took this element already
+                position = this->read_position.load(std::memory_order_relaxed);
+            }
+        }
+    }
+
+    ///
+    /// \returns true if the ring contained no other element than the one just pushed. Only the producer may call this,
+    /// right after a successful push(). Used to signal the consumer only on the transition from empty to non-empty
+    bool was_empty_before_push() const {
+        return this->read_position.load(std::memory_order_seq_cst) + 1 >=
+               this->write_position.load(std::memory_order_relaxed);
+    }
+
+    ///
+    /// \returns the number of elements the ring can hold
+    size_t capacity() const {
+        return this->mask + 1;
+    }
+
+private:
+    // keep the state of the producer and the consumers on separate cache lines
+    static constexpr size_t cache_line_size = 64;
+
+    struct Slot {
+        std::atomic<size_t> sequence{0};
+        T value{};
+    };
+
+    std::unique_ptr<Slot[]> slots;
+    size_t mask{0};
+    alignas(cache_line_size) std::atomic<size_t> write_position{0};
+    alignas(cache_line_size) std::atomic<size_t> read_position{0};
+};
+
+} // namespace Everest
+
+#endif // UTILS_SINGLE_PRODUCER_RING_HPP
@@ -0,0 +1,86 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_SUBSCRIPTION_BATCH_HPP
+#define UTILS_SUBSCRIPTION_BATCH_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <vector>
+
+#include <mqtt.h>
+
+#include <utils/mqtt_buffers.hpp>
+#include <utils/mqtt_statistics.hpp>
+#include <utils/types.hpp>
+
+namespace Everest {
+
+/// \brief A topic to subscribe to or to unsubscribe from
+struct SubscriptionChange {
+    std::string topic;    ///< The MQTT topic (filter)
+    QOS qos{QOS::QOS0};   ///< The maximum QoS level of a subscription
+    bool subscribe{true}; ///< Whether to subscribe to the topic or to unsubscribe from it
+};
+
+///
+/// \brief Packs a MQTT 3.1.1 SUBSCRIBE packet with the given \p packet_id for the subscriptions from \p first to
+/// \p last into the \p buffer of \p size bytes
+/// \returns the size of the packet or 0 if it does not fit into the buffer
+size_t pack_subscribe_request(uint8_t* buffer, size_t size, uint16_t packet_id, const SubscriptionChange* first,
+                              const SubscriptionChange* last);
+
+///
+/// \brief Collects the subscription changes of registered handlers and hands them to MQTT-C in as few packets as
+/// possible
+///
+/// A module registers hundreds of handlers while it initializes, subscribing to each topic on its own would send as
+/// many SUBSCRIBE packets and wake up the MQTT main loop as often. Instead the changes are collected until the main
+/// loop flushes them, consecutive subscriptions are then combined into SUBSCRIBE packets with many topics each. MQTT-C
+/// only packs a single topic per SUBSCRIBE, so the packets are built here and registered in its message queue.
+///
+class SubscriptionBatch {
+public:
+    ///
+    /// \brief Adds a subscription to \p topic with the given maximum \p qos
+    /// \returns true if it is the first pending change, the main loop then has to be woken up to flush it
+    bool subscribe(const std::string& topic, QOS qos);
+
+    ///
+    /// \brief Adds unsubscribing from \p topic
+    /// \returns true if it is the first pending change, the main loop then has to be woken up to flush it
+    bool unsubscribe(const std::string& topic);
+
+    ///
+    /// \returns whether changes are waiting to be flushed
+    bool pending() const;
+
+    ///
+    /// \brief Drops all pending changes, e.g. because the connection was lost and all topics are subscribed anew
+    void clear();
+
+    ///
+    /// \brief Queues the pending changes in order in the send buffer of the \p client, growing its \p buffers as
+    /// needed. The caller has to make sure the client is not used concurrently
+    void flush(struct mqtt_client& client, MQTTBuffers& buffers);
+
+    ///
+    /// \returns the number of subscribed topics and the packets they were sent in
+    SubscriptionStatistics get_statistics() const;
+
+private:
+    std::vector<SubscriptionChange> changes;
+    mutable std::mutex changes_mutex;
+    std::atomic<bool> changes_pending{false};
+    std::atomic<uint64_t> topics_subscribed{0};
+    std::atomic<uint64_t> subscribe_packets{0};
+    std::atomic<uint64_t> unsubscribe_packets{0};
+
+    bool add(SubscriptionChange change);
+};
+
+} // namespace Everest
+
+#endif // UTILS_SUBSCRIPTION_BATCH_HPP
@@ -0,0 +1,67 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_THREAD_POOL_HPP
+#define UTILS_THREAD_POOL_HPP
+
+#include <atomic>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+namespace Everest {
+
+///
+/// \brief A bounded pool of worker threads executing posted tasks
+///
+/// Every worker has its own task queue, idle workers steal tasks from the queues of busy workers. Tasks are not
+/// executed in any particular order, users that need ordering have to serialize their tasks themselves (see
+/// MessageHandler for an example of such a serial strand).
+///
+class ThreadPool {
+public:
+    using Task = std::function<void()>;
+
+    ///
+    /// \brief Starts a pool with \p number_of_threads workers, 0 selects a number based on the available hardware
+    explicit ThreadPool(size_t number_of_threads);
+
+    ///
+    /// \brief Stops and joins all workers, tasks that did not start yet are discarded
+    ~ThreadPool();
+
+    ThreadPool(ThreadPool const&) = delete;
+    void operator=(ThreadPool const&) = delete;
+
+    ///
+    /// \brief Posts a \p task for execution on one of the workers
+    void post(Task task);
+
+    ///
+    /// \returns the number of worker threads
+    size_t size() const;
+
+private:
+    struct WorkerQueue {
+        std::mutex mutex;
+        std::deque<Task> tasks;
+    };
+
+    std::vector<std::unique_ptr<WorkerQueue>> queues;
+    std::vector<std::thread> workers;
+    std::atomic<size_t> next_queue{0};
+    std::atomic<size_t> pending_tasks{0};
+    std::mutex idle_mutex;
+    std::condition_variable idle_cv;
+    bool running{true};
+
+    void run_worker(size_t index);
+    bool try_pop(size_t index, Task& task);
+};
+
+} // namespace Everest
+
+#endif // UTILS_THREAD_POOL_HPP
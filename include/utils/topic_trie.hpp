@@ -0,0 +1,188 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_TOPIC_TRIE_HPP
+#define UTILS_TOPIC_TRIE_HPP
+
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <string_view>
+
+namespace Everest {
+
+///
+/// \brief Routes MQTT topic names to values registered under (possibly wildcard) subscription topics.
+///
+/// Subscription topics are split into their topic levels and stored in a trie with dedicated nodes for the "+" and "#"
+/// wildcards, so looking up a topic name costs O(depth) and does not allocate. The matching semantics are the same
+/// as MQTTAbstractionImpl::check_topic_matches() for all valid topic names (i.e. topic names that do not contain
+/// wildcard characters themselves).
+///
+template <typename T> class TopicTrie {
+public:
+    ///
+    /// \brief registers \p value for the given subscription \p topic, an already registered value gets replaced
+    void insert(const std::string& topic, T value) {
+        Node* node = &this->root;
+        std::string_view rest = topic;
+        while (true) {
+            const auto level = next_level(rest);
+            if (level == "#") {
+                // everything below a "#" matches as soon as there is at least one remaining topic level, so there
+                // is no need to descend any further
+                auto& hash_node = child(node->hash);
+                if (hash_node.any_rest.insert_or_assign(topic, value).second) {
+                    this->subscription_count++;
+                }
+                if (only_hash_levels(rest)) {
+                    // "prefix/#", "prefix/#/#", ... also match "prefix" itself
+                    hash_node.zero_rest.insert_or_assign(topic, value);
+                }
+                break;
+            }
+
+            if (level == "+") {
+                node = &child(node->plus);
+            } else {
+                auto it = node->children.find(level);
+                if (it == node->children.end()) {
+                    it = node->children.emplace(std::string(level), std::make_unique<Node>()).first;
+                }
+                node = it->second.get();
+            }
+
+            if (rest.data() == nullptr) {
+                if (node->exact.insert_or_assign(topic, value).second) {
+                    this->subscription_count++;
+                }
+                break;
+            }
+        }
+    }
+
+    ///
+    /// \brief removes the value registered for the subscription \p topic
+    ///
+    /// \returns true if a value was removed
+    bool erase(const std::string& topic) {
+        Node* node = &this->root;
+        std::string_view rest = topic;
+        size_t erased = 0;
+        while (node != nullptr) {
+            const auto level = next_level(rest);
+            if (level == "#") {
+                if (node->hash) {
+                    erased = node->hash->any_rest.erase(topic);
+                    node->hash->zero_rest.erase(topic);
+                }
+                break;
+            }
+
+            if (level == "+") {
+                node = node->plus.get();
+            } else {
+                const auto it = node->children.find(level);
+                node = (it != node->children.end()) ? it->second.get() : nullptr;
+            }
+
+            if (node != nullptr && rest.data() == nullptr) {
+                erased = node->exact.erase(topic);
+                break;
+            }
+        }
+        // NOTE: empty nodes are kept, subscriptions are usually re-registered on the same topics
+        this->subscription_count -= erased;
+        return erased != 0;
+    }
+
+    ///
+    /// \brief calls \p callback with every value whose subscription topic matches the given topic \p name
+    template <typename Callback> void match(std::string_view name, Callback&& callback) const {
+        match_node(this->root, name, callback);
+    }
+
+    ///
+    /// \returns the number of registered subscription topics
+    size_t size() const {
+        return this->subscription_count;
+    }
+
+private:
+    struct Node {
+        std::map<std::string, std::unique_ptr<Node>, std::less<>> children; ///< exact topic levels
+        std::unique_ptr<Node> plus;                                          ///< the "+" topic level
+        std::unique_ptr<Node> hash;                                          ///< the "#" topic level
+        std::map<std::string, T, std::less<>> exact;     ///< subscriptions ending at this node
+        std::map<std::string, T, std::less<>> any_rest;  ///< "#" subscriptions, matching one or more levels
+        std::map<std::string, T, std::less<>> zero_rest; ///< "#" subscriptions, also matching zero levels
+    };
+
+    Node root;
+    size_t subscription_count{0};
+
+    static Node& child(std::unique_ptr<Node>& node) {
+        if (!node) {
+            node = std::make_unique<Node>();
+        }
+        return *node;
+    }
+
+    /// \brief splits off the next topic level of \p rest, which is set to a null view after the last level
+    static std::string_view next_level(std::string_view& rest) {
+        const auto pos = rest.find('/');
+        if (pos == std::string_view::npos) {
+            const auto level = rest;
+            rest = std::string_view();
+            return level;
+        }
+        const auto level = rest.substr(0, pos);
+        rest.remove_prefix(pos + 1);
+        return level;
+    }
+
+    static bool only_hash_levels(std::string_view rest) {
+        while (rest.data() != nullptr) {
+            if (next_level(rest) != "#") {
+                return false;
+            }
+        }
+        return true;
+    }
+
+    template <typename Callback>
+    static void call_all(const std::map<std::string, T, std::less<>>& values, Callback& callback) {
+        for (const auto& entry : values) {
+            callback(entry.second);
+        }
+    }
+
+    // NOLINTNEXTLINE(misc-no-recursion): recursion depth is bounded by the number of topic levels
+    template <typename Callback> static void match_node(const Node& node, std::string_view rest, Callback& callback) {
+        if (rest.data() == nullptr) {
+            // all topic levels consumed
+            call_all(node.exact, callback);
+            if (node.hash) {
+                call_all(node.hash->zero_rest, callback);
+            }
+            return;
+        }
+
+        if (node.hash) {
+            call_all(node.hash->any_rest, callback);
+        }
+
+        const auto level = next_level(rest);
+        const auto it = node.children.find(level);
+        if (it != node.children.end()) {
+            match_node(*it->second, rest, callback);
+        }
+        if (node.plus) {
+            match_node(*node.plus, rest, callback);
+        }
+    }
+};
+
+} // namespace Everest
+
+#endif // UTILS_TOPIC_TRIE_HPP
@@ -3,7 +3,9 @@
 #ifndef UTILS_TYPES_HPP
 #define UTILS_TYPES_HPP
 
+#include <exception>
 #include <filesystem>
+#include <functional>
 #include <fmt/core.h>
 #include <map>
 #include <optional>
@@ -23,14 +25,14 @@ using ArgumentType = std::vector<std::string>;
 using Arguments = std::map<std::string, ArgumentType>;
 using ReturnType = std::vector<std::string>;
 using JsonCallback = std::function<void(json)>;
+using CmdResultCallback = std::function<void(json result, std::exception_ptr error)>;
 using ValueCallback = std::function<void(Value)>;
 using ConfigEntry = std::variant<std::string, bool, int, double>;
 using ConfigMap = std::map<std::string, ConfigEntry>;
 using ModuleConfigs = std::map<std::string, ConfigMap>;
 using Array = json::array_t;
 using Object = json::object_t;
-// TODO (aw): can we pass the handler arguments by const ref?
-using Handler = std::function<void(json)>;
+using Handler = std::function<void(const json&)>;
 using StringHandler = std::function<void(std::string)>;
 
 enum class HandlerType {
@@ -40,6 +42,7 @@ enum class HandlerType {
     SubscribeError,
     ClearErrorRequest,
     ExternalMQTT,
+    ExternalMQTTWithTopic,
     Unknown
 };
 
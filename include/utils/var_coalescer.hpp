@@ -0,0 +1,80 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_VAR_COALESCER_HPP
+#define UTILS_VAR_COALESCER_HPP
+
+#include <chrono>
+#include <condition_variable>
+#include <functional>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+
+/// \brief Values of several vars of one implementation, in the order they were published
+using VarBatch = std::vector<std::pair<std::string, json>>;
+
+///
+/// \returns the message published on the var topic of an implementation for the given \p vars. A single var is
+/// published as a plain var message, several vars are packed into one batch message
+json make_var_message(const VarBatch& vars);
+
+///
+/// \brief Collects the vars published by the implementations of a module for a time window and publishes them as
+/// one batch message per implementation
+///
+/// If a var is published more than once within a window only its last value is kept, at the position of its first
+/// value. The window of an implementation starts with the first var published after its previous batch.
+///
+class VarCoalescer {
+public:
+    using PublishFunc = std::function<void(const std::string& impl_id, const VarBatch& vars)>;
+
+    ///
+    /// \brief Starts coalescing vars over the given \p window, batches are handed to \p publish on a thread owned by
+    /// the coalescer
+    VarCoalescer(std::chrono::milliseconds window, PublishFunc publish);
+
+    ///
+    /// \brief Publishes the pending vars and stops the thread
+    ~VarCoalescer();
+
+    VarCoalescer(VarCoalescer const&) = delete;
+    void operator=(VarCoalescer const&) = delete;
+
+    ///
+    /// \brief Adds the \p value of the var \p var_name of the implementation \p impl_id to the current batch
+    void add(const std::string& impl_id, const std::string& var_name, json value);
+
+    ///
+    /// \brief Publishes the pending vars of all implementations right away
+    void flush();
+
+private:
+    struct Batch {
+        std::chrono::steady_clock::time_point deadline;
+        VarBatch vars;
+    };
+
+    std::chrono::milliseconds window;
+    PublishFunc publish;
+    std::map<std::string, Batch> batches; ///< pending vars by implementation id
+    std::mutex batches_mutex;
+    std::condition_variable batches_cv;
+    bool running{true};
+    std::thread thread;
+
+    void run();
+    void publish_batches(std::map<std::string, Batch> due_batches);
+};
+
+} // namespace Everest
+
+#endif // UTILS_VAR_COALESCER_HPP
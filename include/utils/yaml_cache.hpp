@@ -0,0 +1,99 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#ifndef UTILS_YAML_CACHE_HPP
+#define UTILS_YAML_CACHE_HPP
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <optional>
+#include <string>
+#include <string_view>
+
+#include <nlohmann/json.hpp>
+
+namespace Everest {
+using json = nlohmann::json;
+namespace fs = std::filesystem;
+
+///
+/// \brief Persistent cache of parsed and validated yaml files
+///
+/// Every entry stores the json a yaml file was turned into after parsing and validating it in CBOR, in a file in the
+/// cache directory named after the path of the yaml file and the schema it was validated against. An entry is only
+/// used if
+///  - it was written with the current version of the cache format,
+///  - it belongs to the same path,
+///  - the size and the modification time of the file did not change,
+///  - the hash of the content of the file did not change and
+///  - the hash of the schema the file was validated against did not change.
+/// Otherwise the file is parsed and validated again and the entry is replaced. Entries that cannot be read are
+/// ignored and failing to write the cache only disables it, so a broken cache never prevents loading a config.
+///
+/// Multiple threads can load files through the same cache at the same time. Copies of a cache share their statistics.
+///
+class YamlCache {
+public:
+    /// \brief Turns a parsed yaml file into the json that is cached, throws if the file is not valid
+    using Processor = std::function<json(json)>;
+
+    struct Statistics {
+        std::size_t hits{0};   ///< files taken from the cache
+        std::size_t misses{0}; ///< files that were parsed and validated
+    };
+
+    ///
+    /// \brief Creates a disabled cache that parses every file
+    YamlCache() = default;
+
+    ///
+    /// \brief Creates a cache that stores its entries in \p cache_dir, which is created when the first entry is written
+    explicit YamlCache(fs::path cache_dir);
+
+    ///
+    /// \returns the yaml file at \p path parsed and turned into json by \p process, which validates it against
+    /// \p schema. The json is taken from the cache if neither the file nor the schema changed since it was stored
+    json load(const fs::path& path, const json& schema, const Processor& process);
+
+    ///
+    /// \returns the parsed yaml file at \p path, from the cache if the file did not change since it was stored
+    json load(const fs::path& path);
+
+    ///
+    /// \brief Removes all entries from the cache directory
+    /// \returns the number of removed entries
+    std::size_t clear() const;
+
+    ///
+    /// \returns whether the cache stores entries
+    bool is_enabled() const;
+
+    ///
+    /// \returns the number of files taken from the cache and parsed since the cache was created
+    Statistics get_statistics() const;
+
+    ///
+    /// \returns the 64 bit FNV-1a hash of \p data
+    static std::uint64_t hash(std::string_view data);
+
+private:
+    struct State {
+        std::atomic<std::size_t> hits{0};
+        std::atomic<std::size_t> misses{0};
+        std::atomic<std::size_t> temporary_files{0}; ///< keeps the names of concurrently written entries unique
+        std::atomic<bool> write_failed{false};
+    };
+
+    fs::path cache_dir;
+    std::shared_ptr<State> state{std::make_shared<State>()};
+
+    std::optional<json> read_entry(const fs::path& entry_path, const json& key) const;
+    void write_entry(const fs::path& entry_path, const json& key, const json& value);
+};
+
+} // namespace Everest
+
+#endif // UTILS_YAML_CACHE_HPP
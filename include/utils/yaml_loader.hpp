@@ -4,6 +4,7 @@
 #define UTILS_YAML_LOADER_HPP
 
 #include <filesystem>
+#include <string>
 
 #include <nlohmann/json.hpp>
 
@@ -11,6 +12,9 @@ namespace Everest {
 
 nlohmann::ordered_json load_yaml(const std::filesystem::path& path);
 
+/// \brief parses the yaml document \p content that was already read from a file
+nlohmann::ordered_json parse_yaml(const std::string& content);
+
 }
 
 #endif // UTILS_YAML_LOADER_HPP
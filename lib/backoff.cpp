@@ -0,0 +1,28 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+
+#include <utils/backoff.hpp>
+
+namespace Everest {
+
+Backoff::Backoff(std::chrono::milliseconds initial_delay, std::chrono::milliseconds max_delay) :
+    initial_delay(initial_delay),
+    max_delay(std::max(max_delay, initial_delay)),
+    delay(initial_delay),
+    random(std::random_device{}()) {
+}
+
+std::chrono::milliseconds Backoff::next() {
+    const auto count = this->delay.count();
+    std::uniform_int_distribution<std::chrono::milliseconds::rep> jitter(0, count / 2);
+    const auto next_delay = std::chrono::milliseconds(count - jitter(this->random));
+    this->delay = std::min(this->delay * 2, this->max_delay);
+    return next_delay;
+}
+
+void Backoff::reset() {
+    this->delay = this->initial_delay;
+}
+
+} // namespace Everest
@@ -1,8 +1,15 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
 #include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <condition_variable>
+#include <exception>
 #include <fstream>
+#include <functional>
 #include <list>
+#include <mutex>
+#include <numeric>
 #include <set>
 #include <sstream>
 
@@ -14,6 +21,7 @@
 #include <framework/runtime.hpp>
 #include <utils/config.hpp>
 #include <utils/formatter.hpp>
+#include <utils/thread_pool.hpp>
 #include <utils/yaml_loader.hpp>
 
 namespace Everest {
@@ -33,6 +41,9 @@ public:
     const std::string what;
 };
 
+// version of the format written by Config::serialize(), blobs of other versions are rejected
+static constexpr int config_blob_version = 1;
+
 static json draft07 = R"(
 {
     "$ref": "http://json-schema.org/draft-07/schema#"
@@ -211,6 +222,52 @@ static auto get_requirements_for_probe_module(const std::string& probe_module_id
     return requirements;
 }
 
+///
+/// \brief runs \p task for every index below \p count on the \p pool and waits until all of them finished
+///
+/// \returns the exception thrown by the task of every index, so errors can be reported in a deterministic order
+static std::vector<std::exception_ptr> run_parallel(ThreadPool& pool, std::size_t count,
+                                                    const std::function<void(std::size_t)>& task) {
+    std::vector<std::exception_ptr> errors(count);
+    std::mutex done_mutex;
+    std::condition_variable done_cv;
+    std::size_t done = 0;
+
+    for (std::size_t index = 0; index < count; index++) {
+        pool.post([&, index]() {
+            try {
+                task(index);
+            } catch (...) {
+                errors[index] = std::current_exception();
+            }
+            // notify while holding the lock, the waiting thread owns the condition variable
+            std::lock_guard<std::mutex> lock(done_mutex);
+            done++;
+            done_cv.notify_one();
+        });
+    }
+
+    std::unique_lock<std::mutex> lock(done_mutex);
+    done_cv.wait(lock, [&]() { return done == count; });
+    return errors;
+}
+
+///
+/// \brief logs the error of a worker in the calling thread and throws it again
+[[noreturn]] static void rethrow_logged(const std::exception_ptr& error) {
+    try {
+        std::rethrow_exception(error);
+    } catch (const std::exception& e) {
+        EVLOG_error << e.what();
+        throw;
+    }
+}
+
+static std::int64_t elapsed_ms(const std::chrono::steady_clock::time_point& start_time) {
+    return std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start_time)
+        .count();
+}
+
 static void setup_probe_module_manifest(const std::string& probe_module_id, const json& config, json& manifests) {
     // setup basic information
     auto& manifest = manifests["ProbeModule"];
@@ -233,66 +290,75 @@ static void setup_probe_module_manifest(const std::string& probe_module_id, cons
     }
 }
 
-void Config::load_and_validate_manifest(const std::string& module_id, const json& module_config) {
-    std::string module_name = module_config["module"];
-
-    this->module_config_cache[module_id] = ConfigCache();
-    this->module_names[module_id] = module_name;
-    EVLOG_debug << fmt::format("Found module {}, loading and verifying manifest...", printable_identifier(module_id));
+json Config::load_manifest(const std::string& module_name) {
+    BOOST_LOG_FUNCTION();
 
+    json manifest;
     // load and validate module manifest.json
     fs::path manifest_path = this->rs->modules_dir / module_name / "manifest.yaml";
     try {
 
+        const auto validate_manifest = [this](json manifest) {
+            json_validator validator(Config::loader, Config::format_checker);
+            validator.set_root_schema(this->_schemas.manifest);
+            auto patch = validator.validate(manifest);
+            if (!patch.is_null()) {
+                // extend manifest with default values
+                manifest = manifest.patch(patch);
+            }
+            return manifest;
+        };
+
         if (module_name != "ProbeModule") {
+            EVLOG_debug << fmt::format("Loading module manifest file at: {}", fs::canonical(manifest_path).string());
+            manifest = this->yaml_cache.load(manifest_path, this->_schemas.manifest, validate_manifest);
+        } else {
             // FIXME (aw): this is implicit logic, because we know, that the ProbeModule manifest had been set up
             // manually already
-            EVLOG_debug << fmt::format("Loading module manifest file at: {}", fs::canonical(manifest_path).string());
-            this->manifests[module_name] = load_yaml(manifest_path);
-        }
-
-        json_validator validator(Config::loader, Config::format_checker);
-        validator.set_root_schema(this->_schemas.manifest);
-        auto patch = validator.validate(this->manifests[module_name]);
-        if (!patch.is_null()) {
-            // extend manifest with default values
-            this->manifests[module_name] = this->manifests[module_name].patch(patch);
+            manifest = validate_manifest(this->manifests.at(module_name));
         }
     } catch (const std::exception& e) {
-        EVLOG_AND_THROW(EverestConfigError(fmt::format("Failed to load and parse manifest file {}: {}",
-                                                       fs::weakly_canonical(manifest_path).string(), e.what())));
+        EVTHROW(EverestConfigError(fmt::format("Failed to load and parse manifest file {}: {}",
+                                               fs::weakly_canonical(manifest_path).string(), e.what())));
     }
 
     // validate user-defined default values for the config meta-schemas
     try {
-        validate_config_schema(this->manifests[module_name]["config"]);
+        validate_config_schema(manifest["config"]);
     } catch (const std::exception& e) {
-        EVLOG_AND_THROW(EverestConfigError(
+        EVTHROW(EverestConfigError(
             fmt::format("Failed to validate the module configuration meta-schema for module '{}'. Reason:\n{}",
                         module_name, e.what())));
     }
 
-    for (auto& impl : this->manifests[module_name]["provides"].items()) {
+    for (auto& impl : manifest["provides"].items()) {
         try {
             validate_config_schema(impl.value()["config"]);
         } catch (const std::exception& e) {
-            EVLOG_AND_THROW(
-                EverestConfigError(fmt::format("Failed to validate the implementation configuration meta-schema "
-                                               "for implementation '{}' in module '{}'. Reason:\n{}",
-                                               impl.key(), module_name, e.what())));
+            EVTHROW(EverestConfigError(fmt::format("Failed to validate the implementation configuration meta-schema "
+                                                   "for implementation '{}' in module '{}'. Reason:\n{}",
+                                                   impl.key(), module_name, e.what())));
         }
     }
 
+    return manifest;
+}
+
+void Config::setup_module(const std::string& module_id, const json& module_config) {
+    std::string module_name = module_config["module"];
+
+    this->module_config_cache[module_id] = ConfigCache();
+    this->module_names[module_id] = module_name;
+    EVLOG_debug << fmt::format("Found module {}, setting up interfaces and config...", printable_identifier(module_id));
+
     std::set<std::string> provided_impls = Config::keys(this->manifests[module_name]["provides"]);
 
     this->interfaces[module_name] = json({});
     this->module_config_cache[module_name].provides_impl = provided_impls;
 
     for (const auto& impl_id : provided_impls) {
-        EVLOG_debug << fmt::format("Loading interface for implementation: {}", impl_id);
         auto intf_name = this->manifests[module_name]["provides"][impl_id]["interface"].get<std::string>();
-        auto seen_interfaces = std::set<std::string>();
-        this->interfaces[module_name][impl_id] = resolve_interface(intf_name);
+        this->interfaces[module_name][impl_id] = this->interface_definitions.at(intf_name);
         this->module_config_cache[module_name].cmds[impl_id] = this->interfaces.at(module_name).at(impl_id).at("cmds");
     }
 
@@ -367,23 +433,84 @@ void Config::load_and_validate_manifest(const std::string& module_id, const json
 }
 
 std::tuple<json, int> Config::load_and_validate_with_schema(const fs::path& file_path, const json& schema) {
-    json json_to_validate = load_yaml(file_path);
     auto validation_ms = 0;
 
-    auto start_time_validate = std::chrono::system_clock::now();
-    json_validator validator(Config::loader, Config::format_checker);
-    validator.set_root_schema(schema);
-    validator.validate(json_to_validate);
-    auto end_time_validate = std::chrono::system_clock::now();
-    EVLOG_debug
-        << "YAML validation of " << file_path.string() << " took: "
-        << std::chrono::duration_cast<std::chrono::milliseconds>(end_time_validate - start_time_validate).count()
-        << "ms";
-
-    validation_ms =
-        std::chrono::duration_cast<std::chrono::milliseconds>(end_time_validate - start_time_validate).count();
-
-    return {json_to_validate, validation_ms};
+    auto validated_json = this->yaml_cache.load(file_path, schema, [&](json json_to_validate) {
+        auto start_time_validate = std::chrono::system_clock::now();
+        json_validator validator(Config::loader, Config::format_checker);
+        validator.set_root_schema(schema);
+        validator.validate(json_to_validate);
+        auto end_time_validate = std::chrono::system_clock::now();
+        EVLOG_debug
+            << "YAML validation of " << file_path.string() << " took: "
+            << std::chrono::duration_cast<std::chrono::milliseconds>(end_time_validate - start_time_validate).count()
+            << "ms";
+
+        validation_ms =
+            std::chrono::duration_cast<std::chrono::milliseconds>(end_time_validate - start_time_validate).count();
+        return json_to_validate;
+    });
+
+    return {validated_json, validation_ms};
+}
+
+json Config::load_and_validate_directory(ThreadPool& pool, const fs::path& directory, const json& schema,
+                                         const std::string& kind) {
+    BOOST_LOG_FUNCTION();
+
+    const auto start_time = std::chrono::steady_clock::now();
+
+    // sorted, so the files are merged and their errors are reported in the same order on every run
+    std::vector<fs::path> file_paths;
+    for (auto const& entry : fs::recursive_directory_iterator(directory)) {
+        if (fs::is_regular_file(entry.path()) && entry.path().extension() == ".yaml") {
+            file_paths.push_back(entry.path());
+        }
+    }
+    std::sort(file_paths.begin(), file_paths.end());
+
+    std::vector<json> loaded(file_paths.size());
+    std::vector<std::int64_t> parsing_ms(file_paths.size());
+    std::vector<int> validation_ms(file_paths.size());
+    const auto errors = run_parallel(pool, file_paths.size(), [&](std::size_t index) {
+        const auto file_start_time = std::chrono::steady_clock::now();
+        const auto& file_path = file_paths[index];
+        try {
+            EVLOG_verbose << fmt::format("Loading {} file at: {}", kind, fs::canonical(file_path).c_str());
+
+            auto [file_json, validate_ms] = load_and_validate_with_schema(file_path, schema);
+            validation_ms[index] = validate_ms;
+            loaded[index] = std::move(file_json[kind + "s"]);
+        } catch (const std::exception& e) {
+            EVTHROW(EverestConfigError(
+                fmt::format("Failed to load and parse {} file '{}', reason: {}", kind, file_path.string(), e.what())));
+        }
+        parsing_ms[index] = elapsed_ms(file_start_time);
+        EVLOG_debug << "Parsing of " << kind << " " << file_path.string() << " took: " << parsing_ms[index] << "ms";
+    });
+
+    json result = json::object();
+    std::int64_t total_time_parsing_ms = 0;
+    std::int64_t total_time_validation_ms = 0;
+    for (std::size_t index = 0; index < file_paths.size(); index++) {
+        if (errors[index]) {
+            rethrow_logged(errors[index]);
+        }
+        const auto file_key = std::string("/") + fs::relative(file_paths[index], directory).stem().string();
+        result[file_key] = std::move(loaded[index]);
+        total_time_parsing_ms += parsing_ms[index];
+        total_time_validation_ms += validation_ms[index];
+    }
+
+    // loading and validation times are summed over all files, the processing time is the wall clock time
+    auto title = kind + "s";
+    title[0] = static_cast<char>(std::toupper(static_cast<unsigned char>(title[0])));
+    EVLOG_info << "- " << title << " loaded in [" << total_time_parsing_ms - total_time_validation_ms << "ms]";
+    EVLOG_info << "- " << title << " validated [" << total_time_validation_ms << "ms]";
+    EVLOG_info << "- " << title << " processed in [" << elapsed_ms(start_time) << "ms] on " << pool.size()
+               << " threads";
+
+    return result;
 }
 
 Config::Config(std::shared_ptr<RuntimeSettings> rs) : Config(rs, false) {
@@ -399,6 +526,9 @@ Config::Config(std::shared_ptr<RuntimeSettings> rs, bool manager) : rs(rs), mana
     this->errors = json({});
     this->_schemas = Config::load_schemas(this->rs->schemas_dir);
     this->error_map = error::ErrorTypeMap(this->rs->errors_dir);
+    if (this->rs->config_cache) {
+        this->yaml_cache = YamlCache(this->rs->cache_dir);
+    }
 
     // load and process config file
     fs::path config_path = rs->config_file;
@@ -438,74 +568,23 @@ Config::Config(std::shared_ptr<RuntimeSettings> rs, bool manager) : rs(rs), mana
         EVLOG_AND_THROW(EverestConfigError(fmt::format("Failed to load and parse config file: {}", e.what())));
     }
 
+    // files are loaded and validated in parallel, the results are merged in a fixed order
+    ThreadPool pool(0);
+
     // load type files
     if (rs->validate_schema) {
-        int total_time_validation_ms = 0, total_time_parsing_ms = 0;
-        for (auto const& types_entry : fs::recursive_directory_iterator(this->rs->types_dir)) {
-            auto start_time = std::chrono::system_clock::now();
-            auto const& type_file_path = types_entry.path();
-            if (fs::is_regular_file(type_file_path) && type_file_path.extension() == ".yaml") {
-                auto type_path = std::string("/") + fs::relative(type_file_path, this->rs->types_dir).stem().string();
-
-                try {
-                    // load and validate type file, store validated result in this->types
-                    EVLOG_verbose << fmt::format("Loading type file at: {}", fs::canonical(type_file_path).c_str());
-
-                    auto [type_json, validate_ms] = load_and_validate_with_schema(type_file_path, this->_schemas.type);
-                    total_time_validation_ms += validate_ms;
-
-                    this->types[type_path] = type_json["types"];
-                } catch (const std::exception& e) {
-                    EVLOG_AND_THROW(EverestConfigError(fmt::format(
-                        "Failed to load and parse type file '{}', reason: {}", type_file_path.string(), e.what())));
-                }
-            }
-            auto end_time = std::chrono::system_clock::now();
-            total_time_parsing_ms +=
-                std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-            EVLOG_debug << "Parsing of type " << types_entry.path().string() << " took: "
-                        << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms";
-        }
-        EVLOG_info << "- Types loaded in [" << total_time_parsing_ms - total_time_validation_ms << "ms]";
-        EVLOG_info << "- Types validated [" << total_time_validation_ms << "ms]";
+        this->types = load_and_validate_directory(pool, this->rs->types_dir, this->_schemas.type, "type");
     }
 
     // load error files
     if (rs->validate_schema) {
-        int total_time_validation_ms = 0, total_time_parsing_ms = 0;
-        for (auto const& errors_entry : fs::recursive_directory_iterator(this->rs->errors_dir)) {
-            auto start_time = std::chrono::system_clock::now();
-            auto const& error_file_path = errors_entry.path();
-            if (fs::is_regular_file(error_file_path) && error_file_path.extension() == ".yaml") {
-                auto error_path =
-                    std::string("/") + fs::relative(error_file_path, this->rs->errors_dir).stem().string();
-
-                try {
-                    // load and validate error file, store validated result in this->errors
-                    EVLOG_verbose << fmt::format("Loading error file at: {}", fs::canonical(error_file_path).c_str());
-
-                    auto [error_json, validate_ms] =
-                        load_and_validate_with_schema(error_file_path, this->_schemas.error_declaration_list);
-                    total_time_validation_ms += validate_ms;
-
-                    this->errors[error_path] = error_json["errors"];
-                } catch (const std::exception& e) {
-                    EVLOG_AND_THROW(EverestConfigError(fmt::format(
-                        "Failed to load and parse error file '{}', reason: {}", error_file_path.string(), e.what())));
-                }
-            }
-            auto end_time = std::chrono::system_clock::now();
-            total_time_parsing_ms +=
-                std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count();
-            EVLOG_debug << "Parsing of error " << errors_entry.path().string() << " took: "
-                        << std::chrono::duration_cast<std::chrono::milliseconds>(end_time - start_time).count() << "ms";
-        }
-        EVLOG_info << "- Errors loaded in [" << total_time_parsing_ms - total_time_validation_ms << "ms]";
-        EVLOG_info << "- Errors validated [" << total_time_validation_ms << "ms]";
+        this->errors =
+            load_and_validate_directory(pool, this->rs->errors_dir, this->_schemas.error_declaration_list, "error");
     }
     std::optional<std::string> probe_module_id;
 
-    // load manifest files of configured modules
+    // collect the manifests of configured modules, every manifest is only loaded once
+    std::vector<std::string> manifest_names;
     for (auto& element : this->main.items()) {
         const auto& module_id = element.key();
         const auto& module_config = element.value();
@@ -518,15 +597,82 @@ Config::Config(std::shared_ptr<RuntimeSettings> rs, bool manager) : rs(rs), mana
             continue;
         }
 
-        load_and_validate_manifest(module_id, module_config);
+        const auto module_name = module_config.at("module").get<std::string>();
+        if (std::find(manifest_names.begin(), manifest_names.end(), module_name) == manifest_names.end()) {
+            manifest_names.push_back(module_name);
+        }
     }
 
-    if (probe_module_id) {
-        auto& manifest = this->manifests["ProbeModule"];
+    // load manifest files of configured modules
+    auto start_time = std::chrono::steady_clock::now();
+    std::vector<json> loaded(manifest_names.size());
+    std::vector<std::int64_t> loading_ms(manifest_names.size());
+    auto errors = run_parallel(pool, manifest_names.size(), [&](std::size_t index) {
+        const auto manifest_start_time = std::chrono::steady_clock::now();
+        loaded[index] = load_manifest(manifest_names[index]);
+        loading_ms[index] = elapsed_ms(manifest_start_time);
+    });
+    for (std::size_t index = 0; index < manifest_names.size(); index++) {
+        if (errors[index]) {
+            rethrow_logged(errors[index]);
+        }
+        this->manifests[manifest_names[index]] = std::move(loaded[index]);
+    }
 
+    if (probe_module_id) {
+        // the ProbeModule manifest is generated from the manifests of the modules it is connected to
         setup_probe_module_manifest(*probe_module_id, this->main, this->manifests);
 
-        load_and_validate_manifest(*probe_module_id, this->main.at(*probe_module_id));
+        try {
+            this->manifests["ProbeModule"] = load_manifest("ProbeModule");
+        } catch (const std::exception& e) {
+            EVLOG_error << e.what();
+            throw;
+        }
+    }
+    EVLOG_info << "- Manifests processed in [" << elapsed_ms(start_time) << "ms] on " << pool.size() << " threads, ["
+               << std::accumulate(loading_ms.begin(), loading_ms.end(), std::int64_t{0}) << "ms] summed over all files";
+
+    // load interface files of the implementations provided by configured modules, every interface is only loaded once
+    std::vector<std::string> interface_names;
+    for (auto& element : this->main.items()) {
+        const auto& module_name = element.value().at("module").get<std::string>();
+        for (const auto& impl : this->manifests.at(module_name).value("provides", json::object()).items()) {
+            const auto intf_name = impl.value().at("interface").get<std::string>();
+            if (std::find(interface_names.begin(), interface_names.end(), intf_name) == interface_names.end()) {
+                interface_names.push_back(intf_name);
+            }
+        }
+    }
+
+    start_time = std::chrono::steady_clock::now();
+    loaded = std::vector<json>(interface_names.size());
+    loading_ms = std::vector<std::int64_t>(interface_names.size());
+    errors = run_parallel(pool, interface_names.size(), [&](std::size_t index) {
+        const auto interface_start_time = std::chrono::steady_clock::now();
+        EVLOG_debug << fmt::format("Loading interface: {}", interface_names[index]);
+        loaded[index] = load_interface_file(interface_names[index]);
+        loading_ms[index] = elapsed_ms(interface_start_time);
+    });
+    for (std::size_t index = 0; index < interface_names.size(); index++) {
+        if (errors[index]) {
+            rethrow_logged(errors[index]);
+        }
+        this->interface_definitions[interface_names[index]] = std::move(loaded[index]);
+    }
+    EVLOG_info << "- Interfaces processed in [" << elapsed_ms(start_time) << "ms] on " << pool.size()
+               << " threads, [" << std::accumulate(loading_ms.begin(), loading_ms.end(), std::int64_t{0})
+               << "ms] summed over all files";
+
+    // set up interfaces and config maps of configured modules
+    for (auto& element : this->main.items()) {
+        if (element.key() != probe_module_id) {
+            setup_module(element.key(), element.value());
+        }
+    }
+
+    if (probe_module_id) {
+        setup_module(*probe_module_id, this->main.at(*probe_module_id));
     }
 
     // load telemetry configs
@@ -540,6 +686,101 @@ Config::Config(std::shared_ptr<RuntimeSettings> rs, bool manager) : rs(rs), mana
     }
 
     resolve_all_requirements();
+
+    if (manager && this->yaml_cache.is_enabled()) {
+        const auto statistics = this->yaml_cache.get_statistics();
+        EVLOG_info << fmt::format("- Config cache: {} files loaded from cache, {} files parsed and validated",
+                                  statistics.hits, statistics.misses);
+    }
+}
+
+Config::Config(std::shared_ptr<RuntimeSettings> rs, std::string_view blob) : rs(rs), manager(false) {
+    BOOST_LOG_FUNCTION();
+
+    json serialized;
+    try {
+        serialized = json::from_cbor(blob.begin(), blob.end());
+    } catch (const std::exception& e) {
+        EVTHROW(EverestConfigError(fmt::format("Failed to parse config blob: {}", e.what())));
+    }
+
+    if (serialized.value("version", 0) != config_blob_version) {
+        EVTHROW(EverestConfigError(fmt::format("Config blob has version {}, expected version {}",
+                                               serialized.value("version", 0), config_blob_version)));
+    }
+    // the blob only replaces loading the files if it was created from the same config with the same settings
+    if (serialized.at("config_file") != this->rs->config_file.string() ||
+        serialized.at("validate_schema") != this->rs->validate_schema) {
+        EVTHROW(EverestConfigError(fmt::format("Config blob was created from config file '{}', not from '{}'",
+                                               serialized.at("config_file").get<std::string>(),
+                                               this->rs->config_file.string())));
+    }
+
+    this->main = std::move(serialized.at("main"));
+    this->manifests = std::move(serialized.at("manifests"));
+    this->interfaces = std::move(serialized.at("interfaces"));
+    this->interface_definitions = std::move(serialized.at("interface_definitions"));
+    this->types = std::move(serialized.at("types"));
+    this->errors = std::move(serialized.at("errors"));
+
+    auto& schemas = serialized.at("schemas");
+    this->_schemas.config = std::move(schemas.at("config"));
+    this->_schemas.manifest = std::move(schemas.at("manifest"));
+    this->_schemas.interface = std::move(schemas.at("interface"));
+    this->_schemas.type = std::move(schemas.at("type"));
+    this->_schemas.error_declaration_list = std::move(schemas.at("error_declaration_list"));
+
+    this->error_map = error::ErrorTypeMap(serialized.at("error_types").get<std::map<error::ErrorType, std::string>>());
+    this->module_names = serialized.at("module_names").get<std::unordered_map<std::string, std::string>>();
+    for (auto& cache : serialized.at("module_config_cache").items()) {
+        auto& module_cache = this->module_config_cache[cache.key()];
+        module_cache.provides_impl = cache.value().at("provides_impl").get<std::set<std::string>>();
+        for (auto& cmds : cache.value().at("cmds").items()) {
+            module_cache.cmds[cmds.key()] = std::move(cmds.value());
+        }
+    }
+    for (const auto& telemetry : serialized.at("telemetry_configs").items()) {
+        auto& telemetry_config = this->telemetry_configs[telemetry.key()];
+        if (!telemetry.value().is_null()) {
+            telemetry_config.emplace(TelemetryConfig{telemetry.value().get<int>()});
+        }
+    }
+}
+
+std::vector<std::uint8_t> Config::serialize() const {
+    BOOST_LOG_FUNCTION();
+
+    json module_config_cache = json::object();
+    for (const auto& [key, cache] : this->module_config_cache) {
+        module_config_cache[key] = {{"provides_impl", cache.provides_impl}, {"cmds", cache.cmds}};
+    }
+    json telemetry_configs = json::object();
+    for (const auto& [module_id, telemetry_config] : this->telemetry_configs) {
+        telemetry_configs[module_id] = telemetry_config.has_value() ? json(telemetry_config->id) : json(nullptr);
+    }
+
+    const json serialized = {
+        {"version", config_blob_version},
+        {"config_file", this->rs->config_file.string()},
+        {"validate_schema", this->rs->validate_schema},
+        {"main", this->main},
+        {"manifests", this->manifests},
+        {"interfaces", this->interfaces},
+        {"interface_definitions", this->interface_definitions},
+        {"types", this->types},
+        {"errors", this->errors},
+        {"schemas",
+         {{"config", this->_schemas.config},
+          {"manifest", this->_schemas.manifest},
+          {"interface", this->_schemas.interface},
+          {"type", this->_schemas.type},
+          {"error_declaration_list", this->_schemas.error_declaration_list}}},
+        {"error_types", this->error_map.get_error_types()},
+        {"module_names", this->module_names},
+        {"module_config_cache", module_config_cache},
+        {"telemetry_configs", telemetry_configs},
+    };
+    return json::to_cbor(serialized);
 }
 
 error::ErrorTypeMap Config::get_error_map() const {
@@ -559,14 +800,6 @@ json Config::get_module_cmds(const std::string& module_name, const std::string&
     return this->module_config_cache.at(module_name).cmds.at(impl_id);
 }
 
-json Config::resolve_interface(const std::string& intf_name) {
-    // load and validate interface.json and mark interface as seen
-    auto intf_definition = load_interface_file(intf_name);
-
-    this->interface_definitions[intf_name] = intf_definition;
-    return intf_definition;
-}
-
 std::list<json> Config::resolve_error_ref(const std::string& reference) {
     BOOST_LOG_FUNCTION();
     std::string ref_prefix = "/errors/";
@@ -585,7 +818,7 @@ std::list<json> Config::resolve_error_ref(const std::string& reference) {
         is_error_list = false;
     }
     fs::path path = this->rs->errors_dir / (err_namespace + ".yaml");
-    json error_json = load_yaml(path);
+    json error_json = this->yaml_cache.load(path);
     std::list<json> errors;
     if (is_error_list) {
         for (auto& error : error_json.at("errors")) {
@@ -617,8 +850,8 @@ json Config::replace_error_refs(json& interface_json) {
                 errors_new[error.at("namespace")] = json::object();
             }
             if (errors_new.at(error.at("namespace")).contains(error.at("name"))) {
-                EVLOG_AND_THROW(EverestConfigError(fmt::format("Error name '{}' in namespace '{}' already referenced!",
-                                                               error.at("name"), error.at("namespace"))));
+                EVTHROW(EverestConfigError(fmt::format("Error name '{}' in namespace '{}' already referenced!",
+                                                       error.at("name"), error.at("namespace"))));
             }
             errors_new[error.at("namespace")][error.at("name")] = error;
         }
@@ -633,36 +866,37 @@ json Config::load_interface_file(const std::string& intf_name) {
     try {
         EVLOG_debug << fmt::format("Loading interface file at: {}", fs::canonical(intf_path).string());
 
-        json interface_json = load_yaml(intf_path);
-
-        // this subschema can not use allOf with the draft-07 schema because that will cause our validator to
-        // add all draft-07 default values which never validate (the {"not": true} default contradicts everything)
-        // --> validating against draft-07 will be done in an extra step below
-        json_validator validator(Config::loader, Config::format_checker);
-        validator.set_root_schema(this->_schemas.interface);
-        auto patch = validator.validate(interface_json);
-        if (!patch.is_null()) {
-            // extend config entry with default values
-            interface_json = interface_json.patch(patch);
-        }
-        interface_json = Config::replace_error_refs(interface_json);
+        auto interface_json = this->yaml_cache.load(intf_path, this->_schemas.interface, [this](json interface_json) {
+            // this subschema can not use allOf with the draft-07 schema because that will cause our validator to
+            // add all draft-07 default values which never validate (the {"not": true} default contradicts everything)
+            // --> validating against draft-07 will be done in an extra step below
+            json_validator validator(Config::loader, Config::format_checker);
+            validator.set_root_schema(this->_schemas.interface);
+            auto patch = validator.validate(interface_json);
+            if (!patch.is_null()) {
+                // extend config entry with default values
+                interface_json = interface_json.patch(patch);
+            }
 
-        // validate every cmd arg/result and var definition against draft-07 schema
-        validator.set_root_schema(draft07);
-        for (auto& var_entry : interface_json["vars"].items()) {
-            validator.validate(var_entry.value());
-        }
-        for (auto& cmd_entry : interface_json["cmds"].items()) {
-            for (auto& arguments_entry : interface_json["cmds"][cmd_entry.key()]["arguments"].items()) {
-                validator.validate(arguments_entry.value());
+            // validate every cmd arg/result and var definition against draft-07 schema
+            validator.set_root_schema(draft07);
+            for (auto& var_entry : interface_json["vars"].items()) {
+                validator.validate(var_entry.value());
             }
-            validator.validate(interface_json["cmds"][cmd_entry.key()]["result"]);
-        }
+            for (auto& cmd_entry : interface_json["cmds"].items()) {
+                for (auto& arguments_entry : interface_json["cmds"][cmd_entry.key()]["arguments"].items()) {
+                    validator.validate(arguments_entry.value());
+                }
+                validator.validate(interface_json["cmds"][cmd_entry.key()]["result"]);
+            }
+            return interface_json;
+        });
 
-        return interface_json;
+        // the referenced errors are not part of the cached interface, their files can change independently
+        return Config::replace_error_refs(interface_json);
     } catch (const std::exception& e) {
-        EVLOG_AND_THROW(EverestConfigError(fmt::format("Failed to load and parse interface file {}: {}",
-                                                       fs::weakly_canonical(intf_path).string(), e.what())));
+        EVTHROW(EverestConfigError(fmt::format("Failed to load and parse interface file {}: {}",
+                                               fs::weakly_canonical(intf_path).string(), e.what())));
     }
 }
 
@@ -701,15 +935,14 @@ bool Config::contains(const std::string& module_id) const {
     return this->main.contains(module_id);
 }
 
-json Config::get_main_config() {
+const json& Config::get_main_config() const {
     BOOST_LOG_FUNCTION();
     return this->main;
 }
 
-// FIXME (aw): check if module_id does not exist
-json Config::get_module_json_config(const std::string& module_id) {
+const json& Config::get_module_json_config(const std::string& module_id) const {
     BOOST_LOG_FUNCTION();
-    return this->main[module_id]["config_maps"];
+    return this->main.at(module_id).at("config_maps");
 }
 
 ModuleConfigs Config::get_module_configs(const std::string& module_id) const {
@@ -759,19 +992,24 @@ ModuleConfigs Config::get_module_configs(const std::string& module_id) const {
     return module_configs;
 }
 
-const json& Config::get_manifests() {
+const json& Config::get_manifests() const {
     BOOST_LOG_FUNCTION();
     return this->manifests;
 }
 
-json Config::get_interfaces() {
+const json& Config::get_interfaces() const {
     BOOST_LOG_FUNCTION();
     return this->interfaces;
 }
 
-json Config::get_interface_definition(const std::string& interface_name) {
+const json& Config::get_interface_definition(const std::string& interface_name) const {
     BOOST_LOG_FUNCTION();
-    return this->interface_definitions.value(interface_name, json());
+    static const json unknown_interface;
+    const auto interface_it = this->interface_definitions.find(interface_name);
+    if (interface_it == this->interface_definitions.end()) {
+        return unknown_interface;
+    }
+    return *interface_it;
 }
 
 json Config::load_schema(const fs::path& path) {
@@ -965,13 +1203,13 @@ std::optional<TelemetryConfig> Config::get_telemetry_config(const std::string& m
     return this->telemetry_configs.at(module_id);
 }
 
-std::string Config::mqtt_prefix(const std::string& module_id, const std::string& impl_id) {
+std::string Config::mqtt_prefix(const std::string& module_id, const std::string& impl_id) const {
     BOOST_LOG_FUNCTION();
 
     return fmt::format("{}{}/{}", this->rs->mqtt_everest_prefix, module_id, impl_id);
 }
 
-std::string Config::mqtt_module_prefix(const std::string& module_id) {
+std::string Config::mqtt_module_prefix(const std::string& module_id) const {
     BOOST_LOG_FUNCTION();
 
     return fmt::format("{}{}", this->rs->mqtt_everest_prefix, module_id);
@@ -0,0 +1,151 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <cerrno>
+#include <charconv>
+#include <cstdlib>
+#include <cstring>
+#include <string>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <framework/runtime.hpp>
+#include <utils/config_blob.hpp>
+
+namespace Everest {
+namespace {
+// a blob is only accepted if nobody can change it anymore while it is mapped
+constexpr int required_seals = F_SEAL_SEAL | F_SEAL_SHRINK | F_SEAL_GROW | F_SEAL_WRITE;
+} // namespace
+
+ConfigBlob::ConfigBlob(int fd, void* data, std::size_t size) : fd(fd), data(data), size(size) {
+}
+
+ConfigBlob::ConfigBlob(ConfigBlob&& other) noexcept : fd(other.fd), data(other.data), size(other.size) {
+    other.fd = -1;
+    other.data = MAP_FAILED;
+    other.size = 0;
+}
+
+ConfigBlob::~ConfigBlob() {
+    if (this->data != MAP_FAILED) {
+        munmap(this->data, this->size);
+    }
+    if (this->fd != -1) {
+        close(this->fd);
+    }
+}
+
+ConfigBlob ConfigBlob::create(const Config& config) {
+    BOOST_LOG_FUNCTION();
+
+    const auto serialized = config.serialize();
+
+    const int fd = memfd_create("everest-config", MFD_CLOEXEC | MFD_ALLOW_SEALING);
+    if (fd == -1) {
+        EVTHROW(EverestInternalError(fmt::format("Could not create memfd for the config blob: {}", strerror(errno))));
+    }
+    // owns the file descriptor from here on, so it is closed if anything below fails
+    ConfigBlob blob(fd, MAP_FAILED, serialized.size());
+
+    std::size_t written = 0;
+    while (written < serialized.size()) {
+        const auto result = write(fd, serialized.data() + written, serialized.size() - written);
+        if (result == -1 && errno == EINTR) {
+            continue;
+        }
+        if (result == -1) {
+            EVTHROW(EverestInternalError(fmt::format("Could not write the config blob: {}", strerror(errno))));
+        }
+        written += result;
+    }
+
+    if (fcntl(fd, F_ADD_SEALS, required_seals) == -1) {
+        EVTHROW(EverestInternalError(fmt::format("Could not seal the config blob: {}", strerror(errno))));
+    }
+
+    return blob;
+}
+
+ConfigBlob ConfigBlob::open(int fd) {
+    BOOST_LOG_FUNCTION();
+
+    ConfigBlob blob(fd, MAP_FAILED, 0);
+
+    const int seals = fcntl(fd, F_GET_SEALS);
+    if (seals == -1 || (seals & required_seals) != required_seals) {
+        EVTHROW(EverestInternalError(fmt::format("File descriptor {} is not a sealed config blob", fd)));
+    }
+
+    struct stat status {};
+    if (fstat(fd, &status) == -1 || status.st_size <= 0) {
+        EVTHROW(EverestInternalError(fmt::format("Config blob in file descriptor {} is empty", fd)));
+    }
+
+    void* data = mmap(nullptr, status.st_size, PROT_READ, MAP_PRIVATE, fd, 0);
+    if (data == MAP_FAILED) {
+        EVTHROW(EverestInternalError(fmt::format("Could not map the config blob: {}", strerror(errno))));
+    }
+    blob.data = data;
+    blob.size = status.st_size;
+
+    return blob;
+}
+
+void ConfigBlob::pass_to_exec() const {
+    // the memfd is created with close-on-exec, so only the spawned module inherits it and not every process the
+    // manager forks
+    fcntl(this->fd, F_SETFD, 0);
+    setenv(CONFIG_BLOB_FD_ENV, std::to_string(this->fd).c_str(), 1);
+}
+
+int ConfigBlob::get_fd() const {
+    return this->fd;
+}
+
+std::string_view ConfigBlob::get_data() const {
+    if (this->data == MAP_FAILED) {
+        return {};
+    }
+    return {static_cast<const char*>(this->data), this->size};
+}
+
+std::size_t ConfigBlob::get_size() const {
+    return this->size;
+}
+
+Config load_module_config(std::shared_ptr<RuntimeSettings> rs) {
+    BOOST_LOG_FUNCTION();
+
+    const char* fd_env = std::getenv(CONFIG_BLOB_FD_ENV);
+    if (fd_env == nullptr) {
+        return Config(rs);
+    }
+    const std::string fd_string = fd_env;
+    // processes started by the module do not inherit the blob
+    unsetenv(CONFIG_BLOB_FD_ENV);
+
+    try {
+        int fd = -1;
+        const auto [end, error] = std::from_chars(fd_string.data(), fd_string.data() + fd_string.size(), fd);
+        if (error != std::errc() || end != fd_string.data() + fd_string.size() || fd < 0) {
+            EVTHROW(EverestInternalError(fmt::format("Invalid config blob file descriptor '{}'", fd_string)));
+        }
+        const auto blob = ConfigBlob::open(fd);
+        return Config(rs, blob.get_data());
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Could not use the config blob of the manager, loading all config files: {}",
+                                     e.what());
+    }
+
+    return Config(rs);
+}
+
+} // namespace Everest
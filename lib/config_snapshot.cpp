@@ -0,0 +1,116 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/config_snapshot.hpp>
+
+namespace Everest {
+namespace {
+const json empty_object = json::object();
+
+const json& value_or_empty(const json& object, const std::string& key) {
+    const auto it = object.find(key);
+    return (it != object.end()) ? *it : empty_object;
+}
+} // namespace
+
+ConfigSnapshot::ConfigSnapshot(const Config& config) :
+    main(config.get_main_config()),
+    manifests(config.get_manifests()),
+    interfaces(config.get_interfaces()),
+    interface_definitions(json::object()) {
+    BOOST_LOG_FUNCTION();
+
+    // copy the definitions of all interfaces the modules provide or require first, the pointers into them stay valid
+    for (const auto& module : this->main.items()) {
+        const auto& manifest = value_or_empty(this->manifests, module.value().at("module"));
+        for (const auto& section : {"provides", "requires"}) {
+            for (const auto& impl : value_or_empty(manifest, section).items()) {
+                const std::string interface_name = impl.value().at("interface");
+                const auto& definition = config.get_interface_definition(interface_name);
+                if (!definition.is_null()) {
+                    this->interface_definitions[interface_name] = definition;
+                }
+            }
+        }
+    }
+    for (const auto& definition : this->interface_definitions.items()) {
+        this->interface_definitions_by_name[definition.key()] = &definition.value();
+    }
+
+    for (const auto& module_config : this->main.items()) {
+        auto& module = this->modules[module_config.key()];
+        module.module_id = module_config.key();
+        module.module_name = module_config.value().at("module");
+        module.identifier = fmt::format("{}:{}", module.module_id, module.module_name);
+        module.mqtt_prefix = config.mqtt_module_prefix(module.module_id);
+        module.config = &module_config.value();
+        module.manifest = &value_or_empty(this->manifests, module.module_name);
+
+        const auto& module_interfaces = value_or_empty(this->interfaces, module.module_name);
+        for (const auto& provides : value_or_empty(*module.manifest, "provides").items()) {
+            auto& implementation = module.implementations[provides.key()];
+            implementation.impl_id = provides.key();
+            implementation.interface_name = provides.value().at("interface");
+            implementation.identifier =
+                fmt::format("{}->{}:{}", module.identifier, implementation.impl_id, implementation.interface_name);
+            implementation.mqtt_prefix = config.mqtt_prefix(module.module_id, implementation.impl_id);
+            implementation.interface = &value_or_empty(module_interfaces, implementation.impl_id);
+
+            static const json unknown_interface;
+            const auto* definition = this->find_interface_definition(implementation.interface_name);
+            implementation.interface_definition = (definition != nullptr) ? definition : &unknown_interface;
+        }
+
+        this->ordered_modules.push_back(&module);
+    }
+}
+
+const json& ConfigSnapshot::get_main_config() const {
+    return this->main;
+}
+
+const json& ConfigSnapshot::get_manifests() const {
+    return this->manifests;
+}
+
+const json& ConfigSnapshot::get_interfaces() const {
+    return this->interfaces;
+}
+
+const std::vector<const ConfigSnapshot::Module*>& ConfigSnapshot::get_modules() const {
+    return this->ordered_modules;
+}
+
+const ConfigSnapshot::Module* ConfigSnapshot::find_module(const std::string& module_id) const {
+    const auto it = this->modules.find(module_id);
+    if (it == this->modules.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const ConfigSnapshot::Implementation* ConfigSnapshot::find_implementation(const std::string& module_id,
+                                                                          const std::string& impl_id) const {
+    const auto* module = this->find_module(module_id);
+    if (module == nullptr) {
+        return nullptr;
+    }
+    const auto it = module->implementations.find(impl_id);
+    if (it == module->implementations.end()) {
+        return nullptr;
+    }
+    return &it->second;
+}
+
+const json* ConfigSnapshot::find_interface_definition(const std::string& interface_name) const {
+    const auto it = this->interface_definitions_by_name.find(interface_name);
+    if (it == this->interface_definitions_by_name.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+} // namespace Everest
@@ -0,0 +1,743 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+#include <filesystem>
+
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/embedded_broker.hpp>
+
+namespace Everest {
+namespace {
+// MQTT control packet types
+constexpr uint8_t connect_packet = 1;
+constexpr uint8_t connack_packet = 2;
+constexpr uint8_t publish_packet = 3;
+constexpr uint8_t puback_packet = 4;
+constexpr uint8_t pubrec_packet = 5;
+constexpr uint8_t pubrel_packet = 6;
+constexpr uint8_t pubcomp_packet = 7;
+constexpr uint8_t subscribe_packet = 8;
+constexpr uint8_t suback_packet = 9;
+constexpr uint8_t unsubscribe_packet = 10;
+constexpr uint8_t unsuback_packet = 11;
+constexpr uint8_t pingreq_packet = 12;
+constexpr uint8_t pingresp_packet = 13;
+constexpr uint8_t disconnect_packet = 14;
+
+// a client that has more outbound data than this queued does not keep up and gets disconnected
+constexpr size_t max_client_backlog = 64 * 1024 * 1024;
+// as does a client that leaves this many QoS 1 and 2 messages unacknowledged
+constexpr size_t max_in_flight_messages = 16 * 1024;
+// QoS 1 and 2 messages that are not acknowledged within this time are sent again
+constexpr auto retransmission_timeout = std::chrono::seconds(10);
+constexpr auto retransmission_check_interval = std::chrono::seconds(1);
+
+constexpr uint8_t dup_flag = 0x08;
+// PUBREL packets have a fixed flags value of 2
+constexpr uint8_t pubrel_header = (pubrel_packet << 4) | 0x02;
+
+void append_remaining_length(std::string& out, size_t length) {
+    do {
+        auto byte = static_cast<uint8_t>(length % 128);
+        length /= 128;
+        if (length > 0) {
+            byte |= 0x80;
+        }
+        out.push_back(static_cast<char>(byte));
+    } while (length > 0);
+}
+
+void append_u16(std::string& out, uint16_t value) {
+    out.push_back(static_cast<char>(value >> 8));
+    out.push_back(static_cast<char>(value & 0xff));
+}
+
+/// \brief appends a packet that only consists of a packet id, like PUBACK
+void append_packet_id_packet(std::string& out, uint8_t header, uint16_t packet_id) {
+    out.push_back(static_cast<char>(header));
+    out.push_back(2);
+    append_u16(out, packet_id);
+}
+
+/// \brief reads the fields of a packet body, every read fails once the body is exhausted
+class PacketReader {
+public:
+    explicit PacketReader(std::string_view body) : body(body) {
+    }
+
+    bool read_byte(uint8_t& value) {
+        if (this->body.empty()) {
+            return false;
+        }
+        value = static_cast<uint8_t>(this->body.front());
+        this->body.remove_prefix(1);
+        return true;
+    }
+
+    bool read_u16(uint16_t& value) {
+        uint8_t high = 0;
+        uint8_t low = 0;
+        if (!this->read_byte(high) || !this->read_byte(low)) {
+            return false;
+        }
+        value = static_cast<uint16_t>((high << 8) | low);
+        return true;
+    }
+
+    bool read_string(std::string_view& value) {
+        uint16_t length = 0;
+        if (!this->read_u16(length) || this->body.size() < length) {
+            return false;
+        }
+        value = this->body.substr(0, length);
+        this->body.remove_prefix(length);
+        return true;
+    }
+
+    std::string_view rest() const {
+        return this->body;
+    }
+
+private:
+    std::string_view body;
+};
+
+/// \brief creates the \p directory of a socket accessible only by the current user and its group if it does not exist
+/// \returns false if it cannot be created or is not safe for a socket, i.e. others than the current user or root could
+/// replace the socket in it
+bool prepare_socket_directory(const std::string& directory) {
+    if (directory.empty()) {
+        return true;
+    }
+    std::error_code error;
+    std::filesystem::create_directories(std::filesystem::path(directory).parent_path(), error);
+    if (mkdir(directory.c_str(), S_IRWXU | S_IRGRP | S_IXGRP) == -1 && errno != EEXIST) {
+        EVLOG_error << fmt::format("Could not create the directory {} of the embedded MQTT broker: {}", directory,
+                                   strerror(errno));
+        return false;
+    }
+    struct stat directory_stat = {};
+    if (lstat(directory.c_str(), &directory_stat) == -1 || !S_ISDIR(directory_stat.st_mode)) {
+        EVLOG_error << fmt::format("{} is not a directory, the embedded MQTT broker cannot create its socket in it",
+                                   directory);
+        return false;
+    }
+    const bool trusted_owner = directory_stat.st_uid == geteuid() || directory_stat.st_uid == 0;
+    const bool replaceable = (directory_stat.st_mode & S_IWOTH) != 0 && (directory_stat.st_mode & S_ISVTX) == 0;
+    if (!trusted_owner || replaceable) {
+        EVLOG_error << fmt::format("The directory {} of the embedded MQTT broker can be modified by other users",
+                                   directory);
+        return false;
+    }
+    return true;
+}
+
+QOS to_qos(uint8_t level) {
+    switch (level) {
+    case 1:
+        return QOS::QOS1;
+    case 2:
+        return QOS::QOS2;
+    default:
+        return QOS::QOS0;
+    }
+}
+} // namespace
+
+EmbeddedBroker::EmbeddedBroker(const std::string& socket_path, const std::string& everest_prefix,
+                               std::unique_ptr<MQTTAbstraction> bridge) :
+    socket_path(socket_path), everest_prefix(everest_prefix), bridge(std::move(bridge)) {
+}
+
+EmbeddedBroker::~EmbeddedBroker() {
+    this->stop();
+}
+
+bool EmbeddedBroker::start() {
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (this->socket_path.size() >= sizeof(addr.sun_path)) {
+        EVLOG_error << fmt::format("Socket path of the embedded MQTT broker is too long: {}", this->socket_path);
+        return false;
+    }
+    strncpy(addr.sun_path, this->socket_path.c_str(), sizeof(addr.sun_path) - 1);
+
+    this->listen_fd = socket(AF_UNIX, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+    this->event_fd = eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (this->listen_fd == -1 || this->event_fd == -1) {
+        EVLOG_error << fmt::format("Could not create the socket of the embedded MQTT broker: {}", strerror(errno));
+        this->stop();
+        return false;
+    }
+
+    // every local user that can connect to the socket could call cmds of the modules, so it is only accessible by the
+    // user and group of the broker
+    if (!prepare_socket_directory(std::filesystem::path(this->socket_path).parent_path().string())) {
+        this->stop();
+        return false;
+    }
+    // a socket file left behind by a previous run would make bind fail
+    unlink(this->socket_path.c_str());
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast): sockaddr_un has to be passed as sockaddr
+    if (bind(this->listen_fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1 ||
+        chmod(this->socket_path.c_str(), S_IRUSR | S_IWUSR | S_IRGRP | S_IWGRP) == -1 ||
+        listen(this->listen_fd, SOMAXCONN) == -1) {
+        EVLOG_error << fmt::format("Embedded MQTT broker cannot listen on {}: {}", this->socket_path, strerror(errno));
+        this->stop();
+        return false;
+    }
+
+    this->running = true;
+    this->thread = std::thread(&EmbeddedBroker::run, this);
+    EVLOG_info << fmt::format("Embedded MQTT broker listening on {}", this->socket_path);
+    return true;
+}
+
+void EmbeddedBroker::stop() {
+    if (this->thread.joinable()) {
+        this->running = false;
+        eventfd_write(this->event_fd, 1);
+        this->thread.join();
+    }
+
+    // stops the handler threads of the bridge before the event fd they notify is closed
+    this->bridge_handlers.clear();
+    this->bridge.reset();
+
+    for (const auto& [fd, client] : this->clients) {
+        close(fd);
+    }
+    this->clients.clear();
+    this->subscribers.clear();
+    this->subscriber_routes = TopicTrie<const SubscribedClients*>();
+    this->client_count = 0;
+    this->subscription_count = 0;
+
+    if (this->listen_fd != -1) {
+        close(this->listen_fd);
+        this->listen_fd = -1;
+        unlink(this->socket_path.c_str());
+    }
+    if (this->event_fd != -1) {
+        close(this->event_fd);
+        this->event_fd = -1;
+    }
+}
+
+EmbeddedBrokerStatistics EmbeddedBroker::get_statistics() const {
+    EmbeddedBrokerStatistics statistics;
+    statistics.clients = this->client_count;
+    statistics.subscriptions = this->subscription_count;
+    statistics.messages_received = this->messages_received;
+    statistics.messages_delivered = this->messages_delivered;
+    statistics.messages_bridged = this->messages_bridged;
+    statistics.messages_retransmitted = this->messages_retransmitted;
+    statistics.clients_dropped = this->clients_dropped;
+    return statistics;
+}
+
+void EmbeddedBroker::run() {
+    std::vector<struct pollfd> pollfds;
+    std::vector<int> dropped;
+    while (this->running) {
+        pollfds.clear();
+        pollfds.push_back({this->event_fd, POLLIN, 0});
+        pollfds.push_back({this->listen_fd, POLLIN, 0});
+        bool in_flight = false;
+        for (const auto& [fd, client] : this->clients) {
+            const auto events = (client.out.size() > client.out_offset) ? (POLLIN | POLLOUT) : POLLIN;
+            pollfds.push_back({fd, static_cast<short>(events), 0});
+            in_flight = in_flight || !client.in_flight.empty();
+        }
+
+        // only wakes up to check for unacknowledged messages if there are any
+        int timeout_ms = -1;
+        if (in_flight) {
+            const auto until_retransmission = std::chrono::duration_cast<std::chrono::milliseconds>(
+                this->next_retransmission - std::chrono::steady_clock::now());
+            timeout_ms = static_cast<int>(std::max<int64_t>(0, until_retransmission.count()));
+        }
+
+        if (::poll(pollfds.data(), pollfds.size(), timeout_ms) == -1) {
+            if (errno == EINTR) {
+                continue;
+            }
+            EVLOG_error << fmt::format("Embedded MQTT broker stops, poll failed: {}", strerror(errno));
+            return;
+        }
+
+        if (pollfds.at(0).revents & POLLIN) {
+            eventfd_t eventfd_buffer = 0;
+            eventfd_read(this->event_fd, &eventfd_buffer);
+            this->deliver_bridged_messages();
+        }
+        if (pollfds.at(1).revents & POLLIN) {
+            this->accept_clients();
+        }
+        for (size_t i = 2; i < pollfds.size(); i++) {
+            if ((pollfds.at(i).revents & (POLLIN | POLLHUP | POLLERR)) == 0) {
+                continue;
+            }
+            if (!this->read_client(this->clients.at(pollfds.at(i).fd))) {
+                dropped.push_back(pollfds.at(i).fd);
+            }
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        if (in_flight && now >= this->next_retransmission) {
+            this->retransmit(now);
+            this->next_retransmission = now + retransmission_check_interval;
+        }
+
+        // everything delivered in this round is sent right away, what does not fit into the socket waits for POLLOUT
+        for (auto& [fd, client] : this->clients) {
+            if (client.in_flight.size() >= max_in_flight_messages) {
+                EVLOG_warning << fmt::format(
+                    "Embedded MQTT broker drops a client with {} unacknowledged messages", client.in_flight.size());
+                dropped.push_back(fd);
+            } else if (client.out.size() > client.out_offset && !this->write_client(client)) {
+                dropped.push_back(fd);
+            }
+        }
+        for (const auto fd : dropped) {
+            this->drop_client(fd);
+        }
+        dropped.clear();
+    }
+}
+
+void EmbeddedBroker::accept_clients() {
+    while (true) {
+        const int fd = accept4(this->listen_fd, nullptr, nullptr, SOCK_NONBLOCK | SOCK_CLOEXEC);
+        if (fd == -1) {
+            if (errno != EAGAIN && errno != EWOULDBLOCK && errno != EINTR) {
+                EVLOG_warning << fmt::format("Embedded MQTT broker could not accept a client: {}", strerror(errno));
+            }
+            return;
+        }
+        this->clients[fd].fd = fd;
+    }
+}
+
+bool EmbeddedBroker::read_client(Client& client) {
+    std::array<char, 64 * 1024> buffer{};
+    while (true) {
+        const auto received = recv(client.fd, buffer.data(), buffer.size(), 0);
+        if (received > 0) {
+            client.in.append(buffer.data(), static_cast<size_t>(received));
+            continue;
+        }
+        if (received == 0) {
+            client.disconnected = true;
+            return false;
+        }
+        if (errno == EINTR) {
+            continue;
+        }
+        if (errno == EAGAIN || errno == EWOULDBLOCK) {
+            break;
+        }
+        return false;
+    }
+
+    // handle all complete packets, a partial packet stays buffered until the rest arrives
+    size_t offset = 0;
+    while (client.in.size() - offset >= 2) {
+        size_t remaining_length = 0;
+        size_t length_bytes = 0;
+        bool complete = false;
+        while (length_bytes < 4 && offset + 1 + length_bytes < client.in.size()) {
+            const auto byte = static_cast<uint8_t>(client.in[offset + 1 + length_bytes]);
+            remaining_length |= static_cast<size_t>(byte & 0x7f) << (7 * length_bytes);
+            length_bytes++;
+            if ((byte & 0x80) == 0) {
+                complete = true;
+                break;
+            }
+        }
+        if (!complete) {
+            if (length_bytes == 4) {
+                return false;
+            }
+            break;
+        }
+
+        const auto packet_size = 1 + length_bytes + remaining_length;
+        if (client.in.size() - offset < packet_size) {
+            break;
+        }
+        const auto body = std::string_view(client.in).substr(offset + 1 + length_bytes, remaining_length);
+        if (!this->handle_packet(client, static_cast<uint8_t>(client.in[offset]), body)) {
+            return false;
+        }
+        offset += packet_size;
+    }
+    client.in.erase(0, offset);
+    return true;
+}
+
+bool EmbeddedBroker::write_client(Client& client) {
+    while (client.out_offset < client.out.size()) {
+        const auto sent =
+            send(client.fd, client.out.data() + client.out_offset, client.out.size() - client.out_offset, MSG_NOSIGNAL);
+        if (sent > 0) {
+            client.out_offset += static_cast<size_t>(sent);
+            continue;
+        }
+        if (sent == -1 && errno == EINTR) {
+            continue;
+        }
+        if (sent == -1 && (errno == EAGAIN || errno == EWOULDBLOCK)) {
+            break;
+        }
+        return false;
+    }
+
+    if (client.out_offset == client.out.size()) {
+        client.out.clear();
+        client.out_offset = 0;
+    } else if (client.out_offset > client.out.size() / 2) {
+        client.out.erase(0, client.out_offset);
+        client.out_offset = 0;
+    }
+
+    if (client.out.size() - client.out_offset > max_client_backlog) {
+        EVLOG_warning << fmt::format("Embedded MQTT broker disconnects a client with {} bytes of undelivered messages",
+                                     client.out.size() - client.out_offset);
+        return false;
+    }
+    return true;
+}
+
+bool EmbeddedBroker::handle_packet(Client& client, uint8_t header, std::string_view body) {
+    const uint8_t type = header >> 4;
+    if (!client.connected && type != connect_packet) {
+        return false;
+    }
+
+    PacketReader reader(body);
+    uint16_t packet_id = 0;
+    switch (type) {
+    case connect_packet: {
+        std::string_view protocol_name;
+        uint8_t protocol_level = 0;
+        if (client.connected || !reader.read_string(protocol_name) || !reader.read_byte(protocol_level)) {
+            return false;
+        }
+        // only MQTT 3.1.1 is supported, anything else is refused with "unacceptable protocol version"
+        const bool accepted = (protocol_name == "MQTT" && protocol_level == 4);
+        client.out.push_back(static_cast<char>(connack_packet << 4));
+        client.out.push_back(2);
+        client.out.push_back(0);
+        client.out.push_back(accepted ? 0 : 1);
+        if (!accepted) {
+            return false;
+        }
+        client.connected = true;
+        this->client_count++;
+        return true;
+    }
+    case publish_packet: {
+        const uint8_t qos_level = (header >> 1) & 0x03;
+        std::string_view topic;
+        if (qos_level == 3 || !reader.read_string(topic) || (qos_level > 0 && !reader.read_u16(packet_id))) {
+            return false;
+        }
+        if (topic.empty() || topic.find_first_of("+#") != std::string_view::npos) {
+            return false;
+        }
+        if (qos_level == 1) {
+            append_packet_id_packet(client.out, puback_packet << 4, packet_id);
+        } else if (qos_level == 2) {
+            append_packet_id_packet(client.out, pubrec_packet << 4, packet_id);
+            // a retransmission of a publish that was not released yet must not be delivered twice
+            if (!client.unreleased_packet_ids.insert(packet_id).second) {
+                return true;
+            }
+        }
+        this->publish(std::string(topic), reader.rest(), to_qos(qos_level));
+        return true;
+    }
+    case pubrel_packet:
+        if (!reader.read_u16(packet_id)) {
+            return false;
+        }
+        client.unreleased_packet_ids.erase(packet_id);
+        append_packet_id_packet(client.out, pubcomp_packet << 4, packet_id);
+        return true;
+    case puback_packet:
+    case pubcomp_packet:
+        // the delivery of a QoS 1 or 2 message is complete
+        if (!reader.read_u16(packet_id)) {
+            return false;
+        }
+        client.in_flight.erase(packet_id);
+        return true;
+    case pubrec_packet: {
+        if (!reader.read_u16(packet_id)) {
+            return false;
+        }
+        // the client has the QoS 2 message, from now on only the PUBREL is sent again until the PUBCOMP arrives
+        const auto in_flight_it = client.in_flight.find(packet_id);
+        if (in_flight_it != client.in_flight.end()) {
+            in_flight_it->second.received = true;
+            in_flight_it->second.packet.clear();
+            in_flight_it->second.sent = std::chrono::steady_clock::now();
+        }
+        append_packet_id_packet(client.out, pubrel_header, packet_id);
+        return true;
+    }
+    case subscribe_packet: {
+        if (!reader.read_u16(packet_id)) {
+            return false;
+        }
+        std::string return_codes;
+        std::string_view topic_filter;
+        uint8_t requested_qos = 0;
+        while (reader.read_string(topic_filter)) {
+            if (topic_filter.empty() || !reader.read_byte(requested_qos)) {
+                return false;
+            }
+            // the requested QoS is granted, anything else is refused with the failure return code
+            if (requested_qos > 2) {
+                return_codes.push_back(static_cast<char>(0x80));
+                continue;
+            }
+            this->subscribe(client, std::string(topic_filter), to_qos(requested_qos));
+            return_codes.push_back(static_cast<char>(requested_qos));
+        }
+        if (return_codes.empty()) {
+            return false;
+        }
+        client.out.push_back(static_cast<char>(suback_packet << 4));
+        append_remaining_length(client.out, 2 + return_codes.size());
+        append_u16(client.out, packet_id);
+        client.out.append(return_codes);
+        return true;
+    }
+    case unsubscribe_packet: {
+        if (!reader.read_u16(packet_id)) {
+            return false;
+        }
+        std::string_view topic_filter;
+        while (reader.read_string(topic_filter)) {
+            this->unsubscribe(client, std::string(topic_filter));
+        }
+        append_packet_id_packet(client.out, unsuback_packet << 4, packet_id);
+        return true;
+    }
+    case pingreq_packet:
+        client.out.push_back(static_cast<char>(pingresp_packet << 4));
+        client.out.push_back(0);
+        return true;
+    case disconnect_packet:
+        client.disconnected = true;
+        return false;
+    default:
+        return false;
+    }
+}
+
+void EmbeddedBroker::publish(const std::string& topic, std::string_view payload, QOS qos) {
+    this->messages_received++;
+
+    // external topics are only delivered by the external broker, also to local subscribers
+    if (this->bridge != nullptr && this->is_external(topic)) {
+        this->messages_bridged++;
+        this->bridge->publish(topic, std::string(payload), qos);
+        return;
+    }
+
+    // every subscribed client gets a message once, even if several of its subscriptions match, with the highest QoS
+    // granted to them
+    std::vector<std::pair<int, QOS>> recipients;
+    this->subscriber_routes.match(topic, [&recipients](const SubscribedClients* subscribed_clients) {
+        recipients.insert(recipients.end(), subscribed_clients->begin(), subscribed_clients->end());
+    });
+    std::sort(recipients.begin(), recipients.end(), [](const auto& lhs, const auto& rhs) {
+        return lhs.first < rhs.first || (lhs.first == rhs.first && lhs.second > rhs.second);
+    });
+    recipients.erase(std::unique(recipients.begin(), recipients.end(),
+                                 [](const auto& lhs, const auto& rhs) { return lhs.first == rhs.first; }),
+                     recipients.end());
+    for (const auto& [fd, granted_qos] : recipients) {
+        this->deliver(fd, topic, payload, std::min(qos, granted_qos));
+    }
+}
+
+void EmbeddedBroker::deliver(int fd, std::string_view topic, std::string_view payload, QOS qos) {
+    auto& client = this->clients.at(fd);
+    // the client is disconnected after this round anyway
+    if (qos != QOS::QOS0 && client.in_flight.size() >= max_in_flight_messages) {
+        return;
+    }
+
+    auto& out = client.out;
+    const auto packet_start = out.size();
+    uint8_t header = publish_packet << 4;
+    uint16_t packet_id = 0;
+    if (qos != QOS::QOS0) {
+        header |= static_cast<uint8_t>(qos) << 1;
+        do {
+            client.last_packet_id++;
+        } while (client.last_packet_id == 0 || client.in_flight.count(client.last_packet_id) != 0);
+        packet_id = client.last_packet_id;
+    }
+    out.push_back(static_cast<char>(header));
+    append_remaining_length(out, 2 + topic.size() + (qos != QOS::QOS0 ? 2 : 0) + payload.size());
+    append_u16(out, static_cast<uint16_t>(topic.size()));
+    out.append(topic);
+    if (qos != QOS::QOS0) {
+        append_u16(out, packet_id);
+    }
+    out.append(payload);
+    if (qos != QOS::QOS0) {
+        client.in_flight.emplace(packet_id,
+                                 InFlightMessage{out.substr(packet_start), false, std::chrono::steady_clock::now()});
+    }
+    this->messages_delivered++;
+}
+
+void EmbeddedBroker::retransmit(std::chrono::steady_clock::time_point now) {
+    for (auto& [fd, client] : this->clients) {
+        for (auto& [packet_id, message] : client.in_flight) {
+            if (now - message.sent < retransmission_timeout) {
+                continue;
+            }
+            if (message.received) {
+                append_packet_id_packet(client.out, pubrel_header, packet_id);
+            } else {
+                // the DUP flag tells the client that it might have received the message before
+                client.out.push_back(static_cast<char>(static_cast<uint8_t>(message.packet.front()) | dup_flag));
+                client.out.append(message.packet, 1, std::string::npos);
+            }
+            message.sent = now;
+            this->messages_retransmitted++;
+        }
+    }
+}
+
+void EmbeddedBroker::subscribe(Client& client, const std::string& topic_filter, QOS qos) {
+    // subscribing to a topic filter again only replaces the granted QoS
+    const auto [subscribers_it, first_subscriber] = this->subscribers.try_emplace(topic_filter);
+    subscribers_it->second[client.fd] = qos;
+    client.subscriptions.insert(topic_filter);
+    if (!first_subscriber) {
+        return;
+    }
+
+    this->subscription_count++;
+    if (this->bridge == nullptr || !this->is_external(topic_filter)) {
+        this->subscriber_routes.insert(topic_filter, &subscribers_it->second);
+        return;
+    }
+    this->bridged_routes.insert(topic_filter, &*subscribers_it);
+
+    // the messages for this topic filter are received from the external broker on a thread of the bridge
+    auto handler = std::make_shared<TypedHandler>(
+        HandlerType::ExternalMQTTWithTopic, std::make_shared<Handler>([this, topic_filter](const json& data) {
+            {
+                const std::lock_guard<std::mutex> lock(this->bridged_messages_mutex);
+                this->bridged_messages.push_back(BridgedMessage{topic_filter, data.at("topic").get<std::string>(),
+                                                                data.at("payload").get<std::string>()});
+            }
+            eventfd_write(this->event_fd, 1);
+        }));
+    this->bridge->register_handler(topic_filter, handler, QOS::QOS2);
+    this->bridge_handlers.emplace(topic_filter, std::move(handler));
+}
+
+void EmbeddedBroker::unsubscribe(Client& client, const std::string& topic_filter) {
+    if (client.subscriptions.erase(topic_filter) == 0) {
+        return;
+    }
+    const auto subscribers_it = this->subscribers.find(topic_filter);
+    subscribers_it->second.erase(client.fd);
+    if (!subscribers_it->second.empty()) {
+        return;
+    }
+
+    this->subscription_count--;
+    const auto bridge_handler_it = this->bridge_handlers.find(topic_filter);
+    if (bridge_handler_it != this->bridge_handlers.end()) {
+        this->bridge->unregister_handler(topic_filter, bridge_handler_it->second);
+        this->bridge_handlers.erase(bridge_handler_it);
+        this->bridged_routes.erase(topic_filter);
+    } else {
+        this->subscriber_routes.erase(topic_filter);
+    }
+    this->subscribers.erase(subscribers_it);
+}
+
+void EmbeddedBroker::drop_client(int fd) {
+    const auto client_it = this->clients.find(fd);
+    if (client_it == this->clients.end()) {
+        return;
+    }
+
+    auto& client = client_it->second;
+    const auto subscriptions = client.subscriptions;
+    for (const auto& topic_filter : subscriptions) {
+        this->unsubscribe(client, topic_filter);
+    }
+    if (client.connected) {
+        this->client_count--;
+    }
+    if (!client.disconnected) {
+        this->clients_dropped++;
+    }
+    close(fd);
+    this->clients.erase(client_it);
+}
+
+void EmbeddedBroker::deliver_bridged_messages() {
+    std::vector<BridgedMessage> messages;
+    {
+        const std::lock_guard<std::mutex> lock(this->bridged_messages_mutex);
+        messages.swap(this->bridged_messages);
+    }
+
+    for (const auto& message : messages) {
+        // the bridge receives a message once for every subscribed topic filter matching its topic, a client only gets
+        // it for the first of its matching topic filters, with the QoS granted to it
+        std::map<int, const Subscribers*> first_subscriptions;
+        this->bridged_routes.match(message.topic, [&first_subscriptions](const Subscribers* subscribers) {
+            for (const auto& [fd, granted_qos] : subscribers->second) {
+                const auto [first_it, inserted] = first_subscriptions.emplace(fd, subscribers);
+                if (!inserted && subscribers->first < first_it->second->first) {
+                    first_it->second = subscribers;
+                }
+            }
+        });
+
+        bool delivered = false;
+        for (const auto& [fd, subscription] : first_subscriptions) {
+            if (subscription->first == message.topic_filter) {
+                this->deliver(fd, message.topic, message.payload, subscription->second.at(fd));
+                delivered = true;
+            }
+        }
+        if (delivered) {
+            this->messages_bridged++;
+        }
+    }
+}
+
+bool EmbeddedBroker::is_external(std::string_view topic) const {
+    return topic.substr(0, this->everest_prefix.size()) != this->everest_prefix;
+}
+
+} // namespace Everest
@@ -16,6 +16,9 @@ ErrorTypeMap::ErrorTypeMap(std::filesystem::path error_types_dir) {
     load_error_types(error_types_dir);
 }
 
+ErrorTypeMap::ErrorTypeMap(std::map<ErrorType, std::string> error_types) : error_types(std::move(error_types)) {
+}
+
 void ErrorTypeMap::load_error_types(std::filesystem::path error_types_dir) {
     BOOST_LOG_FUNCTION();
 
@@ -69,5 +72,9 @@ bool ErrorTypeMap::has(const ErrorType& error_type) const {
     return error_types.find(error_type) != error_types.end();
 }
 
+const std::map<ErrorType, std::string>& ErrorTypeMap::get_error_types() const {
+    return error_types;
+}
+
 } // namespace error
 } // namespace Everest
@@ -1,5 +1,7 @@
 // SPDX-License-Identifier: Apache-2.0
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <array>
+#include <charconv>
 #include <future>
 #include <map>
 #include <set>
@@ -26,16 +28,53 @@ namespace Everest {
 const auto remote_cmd_res_timeout_seconds = 300;
 const std::array<std::string, 3> TELEMETRY_RESERVED_KEYS = {{"connector_id"}};
 
+namespace {
+/// \returns the printable identifier of the implementation that raised or cleared an error
+std::string printable_origin(const ConfigSnapshot& snapshot, const json& origin) {
+    const auto& module_id = origin.at("module").get_ref<const std::string&>();
+    const auto& impl_id = origin.at("implementation").get_ref<const std::string&>();
+    const auto* implementation = snapshot.find_implementation(module_id, impl_id);
+    if (implementation == nullptr) {
+        return fmt::format("{}->{}", module_id, impl_id);
+    }
+    return implementation->identifier;
+}
+
+QOS get_var_qos(const ImplementationRoute& implementation, const std::string& var_name) {
+    const auto var_it = implementation.vars.find(var_name);
+    return (var_it != implementation.vars.end()) ? var_it->second.qos : QOS::QOS2;
+}
+
+bool is_coalesced(const ImplementationRoute& implementation, const std::string& var_name) {
+    const auto var_it = implementation.vars.find(var_name);
+    return var_it != implementation.vars.end() && var_it->second.coalesce;
+}
+} // namespace
+
 Everest::Everest(std::string module_id_, const Config& config_, bool validate_data_with_schema,
                  const std::string& mqtt_server_address, int mqtt_server_port, const std::string& mqtt_everest_prefix,
                  const std::string& mqtt_external_prefix, const std::string& telemetry_prefix, bool telemetry_enabled) :
-    mqtt_abstraction(mqtt_server_address, std::to_string(mqtt_server_port), mqtt_everest_prefix, mqtt_external_prefix),
+    Everest(std::move(module_id_), config_,
+            SchemaValidationSettings{validate_data_with_schema ? SchemaValidationMode::Full
+                                                               : SchemaValidationMode::Off},
+            MQTTSettings{mqtt_server_address, mqtt_server_port, mqtt_everest_prefix, mqtt_external_prefix},
+            telemetry_prefix, telemetry_enabled) {
+}
+
+Everest::Everest(std::string module_id_, const Config& config_, const SchemaValidationSettings& schema_validation,
+                 const MQTTSettings& mqtt_settings, const std::string& telemetry_prefix, bool telemetry_enabled) :
+    mqtt_abstraction(mqtt_settings),
     config(std::move(config_)),
+    validators([this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
+               Config::format_checker, schema_validation),
     module_id(std::move(module_id_)),
     remote_cmd_res_timeout(remote_cmd_res_timeout_seconds),
-    validate_data_with_schema(validate_data_with_schema),
-    mqtt_everest_prefix(mqtt_everest_prefix),
-    mqtt_external_prefix(mqtt_external_prefix),
+    // results of all callers of a cmd are published on the same topic, so call ids need to be unique across modules
+    // and module restarts
+    call_id_prefix(
+        fmt::format("{}-{}-", module_id, boost::uuids::to_string(boost::uuids::random_generator()()).substr(0, 8))),
+    mqtt_everest_prefix(mqtt_settings.everest_prefix),
+    mqtt_external_prefix(mqtt_settings.external_prefix),
     telemetry_prefix(telemetry_prefix),
     telemetry_enabled(telemetry_enabled) {
     BOOST_LOG_FUNCTION();
@@ -50,14 +89,23 @@ Everest::Everest(std::string module_id_, const Config& config_, bool validate_da
 
     this->module_name = module_config_it->at("module");
     this->module_manifest = this->config.get_manifests()[this->module_name];
-    this->module_classes = this->config.get_interfaces()[this->module_name];
+    this->config_snapshot = std::make_shared<const ConfigSnapshot>(this->config);
+    this->routing = std::make_unique<const RoutingTable>(this->config, this->module_id, this->validators);
     this->telemetry_config = this->config.get_telemetry_config(this->module_id);
 
+    // only the vars listed in the var_coalescing config are coalesced, all others are published right away
+    const auto var_coalescing_window_ms = module_config_it->value("var_coalescing_window_ms", 0);
+    if (var_coalescing_window_ms > 0 && !module_config_it->value("var_coalescing", json::object()).empty()) {
+        this->var_coalescer = std::make_unique<VarCoalescer>(
+            std::chrono::milliseconds(var_coalescing_window_ms),
+            [this](const std::string& impl_id, const VarBatch& vars) { this->publish_var_batch(impl_id, vars); });
+    }
+
     this->ready_received = false;
     this->on_ready = nullptr;
 
     // register handler for global ready signal
-    Handler handle_ready_wrapper = [this](json data) { this->handle_ready(data); };
+    Handler handle_ready_wrapper = [this](const json& data) { this->handle_ready(data); };
     std::shared_ptr<TypedHandler> everest_ready =
         std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, std::make_shared<Handler>(handle_ready_wrapper));
     this->mqtt_abstraction.register_handler(fmt::format("{}ready", mqtt_everest_prefix), everest_ready, QOS::QOS2);
@@ -163,160 +211,249 @@ void Everest::disconnect() {
     this->mqtt_abstraction.disconnect();
 }
 
-json Everest::call_cmd(const Requirement& req, const std::string& cmd_name, json json_args) {
+json Everest::call_cmd(const Requirement& req, const std::string& cmd_name, json json_args,
+                       std::optional<std::chrono::milliseconds> timeout) {
     BOOST_LOG_FUNCTION();
 
-    // resolve requirement
-    json connections = this->config.resolve_requirement(this->module_id, req.id);
-    auto& connection = connections; // this is for a min/max == 1 requirement
-    if (connections.is_array()) {   // this is for every other requirement
-        connection = connections[req.index];
-    }
+    auto res_future = this->call_cmd_async(req, cmd_name, std::move(json_args), timeout);
+    auto result = res_future.get();
+    EVLOG_debug << "res future ready";
+    return result;
+}
 
-    // extract manifest definition of this command
-    json cmd_definition = get_cmd_definition(connection["module_id"], connection["implementation_id"], cmd_name, true);
+std::future<json> Everest::call_cmd_async(const Requirement& req, const std::string& cmd_name, json json_args,
+                                          std::optional<std::chrono::milliseconds> timeout) {
+    BOOST_LOG_FUNCTION();
 
-    json return_type = cmd_definition.at("result").at("type");
+    std::future<json> res_future;
+    this->send_cmd(req, cmd_name, json_args, timeout,
+                   [this, &res_future](const std::string& call_id, const std::string& description,
+                                       std::chrono::milliseconds timeout) {
+                       res_future = this->pending_calls.add(call_id, description, timeout);
+                   });
+    return res_future;
+}
 
-    std::set<std::string> arg_names = Config::keys(json_args);
+void Everest::call_cmd_async(const Requirement& req, const std::string& cmd_name, json json_args,
+                             CmdResultCallback callback, std::optional<std::chrono::milliseconds> timeout) {
+    BOOST_LOG_FUNCTION();
 
-    // check args against manifest
-    if (this->validate_data_with_schema) {
-        if (cmd_definition["arguments"].size() != json_args.size()) {
-            EVLOG_AND_THROW(EverestApiError(
-                fmt::format("Call to {}->{}({}): Argument cound does not match manifest!",
-                            this->config.printable_identifier(connection["module_id"], connection["implementation_id"]),
-                            cmd_name, fmt::join(arg_names, ", "))));
-        }
+    this->send_cmd(req, cmd_name, json_args, timeout,
+                   [this, &callback](const std::string& call_id, const std::string& description,
+                                     std::chrono::milliseconds timeout) {
+                       this->pending_calls.add(call_id, description, timeout, std::move(callback));
+                   });
+}
 
-        std::set<std::string> unknown_arguments;
-        std::set<std::string> cmd_arguments;
-        if (cmd_definition.contains("arguments")) {
-            cmd_arguments = Config::keys(cmd_definition["arguments"]);
-        }
+void Everest::send_cmd(const Requirement& req, const std::string& cmd_name, json& json_args,
+                       std::optional<std::chrono::milliseconds> timeout,
+                       const std::function<void(const std::string& call_id, const std::string& description,
+                                                std::chrono::milliseconds timeout)>& add_pending_call) {
+    BOOST_LOG_FUNCTION();
 
-        std::set_difference(arg_names.begin(), arg_names.end(), cmd_arguments.begin(), cmd_arguments.end(),
-                            std::inserter(unknown_arguments, unknown_arguments.end()));
+    const auto& connection = this->resolve_connection(req);
+    const auto& implementation = *connection.implementation;
+    const auto& cmd = this->get_cmd_route(implementation, cmd_name, true);
 
-        if (!unknown_arguments.empty()) {
-            EVLOG_AND_THROW(EverestApiError(fmt::format(
-                "Call to {}->{}({}): Argument names do not match manifest: {} != {}!",
-                this->config.printable_identifier(connection["module_id"], connection["implementation_id"]), cmd_name,
-                fmt::join(arg_names, ","), fmt::join(arg_names, ","), fmt::join(cmd_arguments, ","))));
+    // check args against manifest
+    if (this->validators.is_enabled()) {
+        const auto arguments_do_not_match = [&](const char* problem) {
+            const auto arg_names = Config::keys(json_args);
+            EVLOG_AND_THROW(EverestApiError(fmt::format("Call to {}->{}({}): {} {} != {}!", implementation.identifier,
+                                                        cmd_name, fmt::join(arg_names, ","), problem,
+                                                        fmt::join(arg_names, ","),
+                                                        fmt::join(cmd.argument_names, ","))));
+        };
+
+        if (cmd.argument_names.size() != json_args.size()) {
+            arguments_do_not_match("Argument count does not match manifest:");
         }
-    }
 
-    if (this->validate_data_with_schema) {
-        for (auto const& arg_name : arg_names) {
+        for (const auto& arg : json_args.items()) {
+            const auto validator_it = cmd.argument_validators.find(arg.key());
+            if (validator_it == cmd.argument_validators.end()) {
+                arguments_do_not_match("Argument names do not match manifest:");
+            }
             try {
-                json_validator validator(
-                    [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                    Config::format_checker);
-                validator.set_root_schema(cmd_definition["arguments"][arg_name]);
-                validator.validate(json_args[arg_name]);
+                validator_it->second->validate(arg.value());
             } catch (const std::exception& e) {
                 EVLOG_AND_THROW(EverestApiError(fmt::format(
                     "Call to {}->{}({}): Argument '{}' with value '{}' could not be validated with schema: {}",
-                    this->config.printable_identifier(connection["module_id"], connection["implementation_id"]),
-                    cmd_name, fmt::join(arg_names, ","), arg_name, json_args[arg_name].dump(2), e.what())));
+                    implementation.identifier, cmd_name, fmt::join(Config::keys(json_args), ","), arg.key(),
+                    arg.value().dump(2), e.what())));
             }
         }
+    } else {
+        this->validators.count_skipped();
     }
 
-    std::string call_id = boost::uuids::to_string(boost::uuids::random_generator()());
-
-    std::promise<json> res_promise;
-    std::future<json> res_future = res_promise.get_future();
-
-    Handler res_handler = [this, &res_promise, call_id, connection, cmd_name, return_type](json data) {
-        auto& data_id = data.at("id");
-        if (data_id != call_id) {
-            EVLOG_debug << fmt::format("RES: data_id != call_id ({} != {})", data_id, call_id);
-            return;
-        }
-
-        EVLOG_debug << fmt::format(
-            "Incoming res {} for {}->{}()", data_id,
-            this->config.printable_identifier(connection["module_id"], connection["implementation_id"]), cmd_name);
-
-        res_promise.set_value(std::move(data["retval"]));
-    };
+    // the timeout of the call takes precedence over the one configured for the connection
+    if (!timeout.has_value()) {
+        timeout = connection.cmd_timeout.value_or(this->remote_cmd_res_timeout);
+    }
 
-    const auto cmd_topic =
-        fmt::format("{}/cmd", this->config.mqtt_prefix(connection["module_id"], connection["implementation_id"]));
+    auto call_id = this->call_id_prefix;
+    std::array<char, 16> call_number{};
+    const auto call_number_end =
+        std::to_chars(call_number.data(), call_number.data() + call_number.size(), this->next_call_id++, 16).ptr;
+    call_id.append(call_number.data(), call_number_end);
+    add_pending_call(call_id, cmd.description, timeout.value());
 
-    std::shared_ptr<TypedHandler> res_token =
-        std::make_shared<TypedHandler>(cmd_name, call_id, HandlerType::Result, std::make_shared<Handler>(res_handler));
-    this->mqtt_abstraction.register_handler(cmd_topic, res_token, QOS::QOS2);
+    this->register_result_router(implementation);
 
     json cmd_publish_data =
         json::object({{"name", cmd_name},
                       {"type", "call"},
                       {"data", json::object({{"id", call_id}, {"args", json_args}, {"origin", this->module_id}})}});
 
-    this->mqtt_abstraction.publish(cmd_topic, cmd_publish_data, QOS::QOS2);
+    if (!this->mqtt_abstraction.publish(implementation.cmd_topic, cmd_publish_data, cmd.qos)) {
+        // the call never left this module, so its caller must not wait for the timeout
+        const auto message =
+            fmt::format("Could not send call of {}, the MQTT publish queue is full or stopped", cmd.description);
+        EVLOG_error << message;
+        this->pending_calls.fail(call_id, std::make_exception_ptr(EverestTimeoutError(message)));
+    }
+}
 
-    // wait for result future
-    std::chrono::time_point<std::chrono::steady_clock> res_wait =
-        std::chrono::steady_clock::now() + this->remote_cmd_res_timeout;
-    std::future_status res_future_status;
-    do {
-        res_future_status = res_future.wait_until(res_wait);
-    } while (res_future_status == std::future_status::deferred);
+void Everest::register_result_router(const ImplementationRoute& implementation) {
+    BOOST_LOG_FUNCTION();
 
-    json result;
-    if (res_future_status == std::future_status::timeout) {
-        EVLOG_AND_THROW(EverestTimeoutError(fmt::format(
-            "Timeout while waiting for result of {}->{}()",
-            this->config.printable_identifier(connection["module_id"], connection["implementation_id"]), cmd_name)));
-    } else if (res_future_status == std::future_status::ready) {
-        EVLOG_debug << "res future ready";
-        result = res_future.get();
+    const std::lock_guard<std::mutex> lock(this->result_routers_mutex);
+    if (!this->result_routers.insert(&implementation).second) {
+        return;
     }
-    this->mqtt_abstraction.unregister_handler(cmd_topic, res_token);
 
-    return result;
+    // a result handler without name and id receives all results on this topic, including the ones meant for other
+    // modules, which are simply not found in the table of pending calls
+    Handler router = [this](const json& data) {
+        const auto& data_id = data.at("id");
+        if (!data_id.is_string()) {
+            return;
+        }
+
+        const auto& call_id = data_id.get_ref<const std::string&>();
+        if (this->pending_calls.complete(call_id, data.at("retval"))) {
+            EVLOG_debug << fmt::format("Incoming res {}", call_id);
+        }
+    };
+
+    // the router receives the results of all cmds of the implementation, so it needs the highest QoS of them
+    this->mqtt_abstraction.register_handler(
+        implementation.cmd_topic,
+        std::make_shared<TypedHandler>(HandlerType::Result, std::make_shared<Handler>(router)),
+        implementation.result_qos);
 }
 
 void Everest::publish_var(const std::string& impl_id, const std::string& var_name, json value) {
     BOOST_LOG_FUNCTION();
 
-    // check arguments
-    if (this->validate_data_with_schema) {
-        auto impl_intf = this->module_classes[impl_id];
+    const auto& implementation = this->get_provided_implementation(impl_id);
+    this->check_var(implementation, var_name, value);
 
-        if (!module_manifest["provides"].contains(impl_id)) {
-            EVLOG_AND_THROW(EverestApiError(fmt::format("Implementation '{}' not declared in manifest of module '{}'!",
-                                                        impl_id, this->config.get_main_config())));
+    if (this->var_coalescer != nullptr && is_coalesced(implementation, var_name)) {
+        this->var_coalescer->add(impl_id, var_name, std::move(value));
+        return;
+    }
+
+    json var_publish_data = {{"name", var_name}, {"data", value}};
+
+    this->mqtt_abstraction.publish(implementation.var_topic, var_publish_data,
+                                   get_var_qos(implementation, var_name));
+}
+
+void Everest::publish_vars(const std::string& impl_id, VarBatch vars) {
+    BOOST_LOG_FUNCTION();
+
+    if (vars.empty()) {
+        return;
+    }
+
+    const auto& implementation = this->get_provided_implementation(impl_id);
+    for (const auto& [var_name, value] : vars) {
+        this->check_var(implementation, var_name, value);
+    }
+
+    if (this->var_coalescer != nullptr) {
+        // going through the coalescer keeps the order with coalesced vars published before, the other vars are
+        // published right away
+        VarBatch direct_vars;
+        for (auto& [var_name, value] : vars) {
+            if (is_coalesced(implementation, var_name)) {
+                this->var_coalescer->add(impl_id, var_name, std::move(value));
+            } else {
+                direct_vars.emplace_back(var_name, std::move(value));
+            }
+        }
+        if (direct_vars.empty()) {
+            return;
         }
+        vars = std::move(direct_vars);
+    }
 
-        if (!impl_intf["vars"].contains(var_name)) {
-            EVLOG_AND_THROW(
-                EverestApiError(fmt::format("{} does not declare var '{}' in manifest!",
-                                            this->config.printable_identifier(this->module_id, impl_id), var_name)));
+    this->publish_var_batch(impl_id, vars);
+}
+
+void Everest::publish_var_batch(const std::string& impl_id, const VarBatch& vars) {
+    const auto& implementation = this->get_provided_implementation(impl_id);
+
+    // the batch is published with the highest QoS of its vars
+    auto qos = QOS::QOS0;
+    for (const auto& var : vars) {
+        qos = std::max(qos, get_var_qos(implementation, var.first));
+    }
+
+    this->mqtt_abstraction.publish(implementation.var_topic, make_var_message(vars), qos);
+}
+
+const ConnectionRoute& Everest::resolve_connection(const Requirement& req) {
+    const auto* connection = this->routing->find_connection(req);
+    if (connection == nullptr) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Requirement '{}' with index {} of {} is not connected!", req.id,
+                                                    req.index, this->config.printable_identifier(this->module_id))));
+    }
+    return *connection;
+}
+
+const ImplementationRoute& Everest::get_provided_implementation(const std::string& impl_id) {
+    const auto* implementation = this->routing->find_implementation(impl_id);
+    if (implementation == nullptr) {
+        EVLOG_AND_THROW(EverestApiError(fmt::format("Implementation '{}' not declared in manifest of module {}!",
+                                                    impl_id, this->config.printable_identifier(this->module_id))));
+    }
+    return *implementation;
+}
+
+const CmdRoute& Everest::get_cmd_route(const ImplementationRoute& implementation, const std::string& cmd_name,
+                                       bool is_call) {
+    const auto cmd_it = implementation.cmds.find(cmd_name);
+    if (cmd_it == implementation.cmds.end()) {
+        // throws with a description of what is missing
+        this->get_cmd_definition(implementation.module_id, implementation.impl_id, cmd_name, is_call);
+        EVLOG_AND_THROW(EverestApiError(fmt::format("{}: cmd '{}' not found!", implementation.identifier, cmd_name)));
+    }
+    return cmd_it->second;
+}
+
+void Everest::check_var(const ImplementationRoute& implementation, const std::string& var_name, const json& value) {
+    // check arguments
+    if (this->validators.is_enabled()) {
+        const auto var_it = implementation.vars.find(var_name);
+        if (var_it == implementation.vars.end()) {
+            EVLOG_AND_THROW(EverestApiError(
+                fmt::format("{} does not declare var '{}' in manifest!", implementation.identifier, var_name)));
         }
 
         // validate var contents before publishing
-        auto var_definition = impl_intf["vars"][var_name];
         try {
-            json_validator validator(
-                [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                Config::format_checker);
-            validator.set_root_schema(var_definition);
-            validator.validate(value);
+            var_it->second.validator->validate(value);
         } catch (const std::exception& e) {
             EVLOG_AND_THROW(EverestApiError(fmt::format(
                 "Publish var of {} with variable name '{}' with value: {}\ncould not be validated with schema: {}",
-                this->config.printable_identifier(this->module_id, impl_id), var_name, value.dump(2), e.what())));
+                implementation.identifier, var_name, value.dump(2), e.what())));
         }
+    } else {
+        this->validators.count_skipped();
     }
-
-    const auto var_topic = fmt::format("{}/var", this->config.mqtt_prefix(this->module_id, impl_id));
-
-    json var_publish_data = {{"name", var_name}, {"data", value}};
-
-    // FIXME(kai): implement an efficient way of choosing qos for each variable
-    this->mqtt_abstraction.publish(var_topic, var_publish_data, QOS::QOS2);
 }
 
 void Everest::subscribe_var(const Requirement& req, const std::string& var_name, const JsonCallback& callback) {
@@ -324,55 +461,40 @@ void Everest::subscribe_var(const Requirement& req, const std::string& var_name,
 
     EVLOG_debug << fmt::format("subscribing to var: {}:{}", req.id, var_name);
 
-    // resolve requirement
-    json connections = this->config.resolve_requirement(this->module_id, req.id);
-    auto& connection = connections; // this is for a min/max == 1 requirement
-    if (connections.is_array()) {   // this is for every other requirement
-        connection = connections[req.index];
-    }
-
-    auto requirement_module_id = connection["module_id"].get<std::string>();
-    auto module_name = this->config.get_module_name(requirement_module_id);
-    auto requirement_impl_id = connection["implementation_id"].get<std::string>();
-    auto requirement_impl_manifest = this->config.get_interfaces()[module_name][requirement_impl_id];
-
-    if (!requirement_impl_manifest["vars"].contains(var_name)) {
+    const auto& implementation = *this->resolve_connection(req).implementation;
+    const auto var_it = implementation.vars.find(var_name);
+    if (var_it == implementation.vars.end()) {
         EVLOG_AND_THROW(EverestApiError(
-            fmt::format("{}->{}: Variable not defined in manifest!",
-                        this->config.printable_identifier(requirement_module_id, requirement_impl_id), var_name)));
+            fmt::format("{}->{}: Variable not defined in manifest!", implementation.identifier, var_name)));
     }
 
-    auto requirement_manifest_vardef = requirement_impl_manifest["vars"][var_name];
+    // the schema was compiled with the routing table, the handler only needs to run the validator
+    const auto& validator = var_it->second.validator;
+    const auto& identifier = implementation.identifier;
 
-    Handler handler = [this, requirement_module_id, requirement_impl_id, requirement_manifest_vardef, var_name,
-                       callback](json const& data) {
-        EVLOG_debug << fmt::format(
-            "Incoming {}->{}", this->config.printable_identifier(requirement_module_id, requirement_impl_id), var_name);
+    Handler handler = [this, &identifier, validator, var_name, callback](json const& data) {
+        EVLOG_debug << fmt::format("Incoming {}->{}", identifier, var_name);
 
-        if (this->validate_data_with_schema) {
+        if (validator != nullptr) {
             // check data and ignore it if not matching (publishing it should have been prohibited already)
             try {
-                json_validator validator(
-                    [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                    Config::format_checker);
-                validator.set_root_schema(requirement_manifest_vardef);
-                validator.validate(data);
+                validator->validate(data);
             } catch (const std::exception& e) {
                 EVLOG_warning << fmt::format("Ignoring incoming var '{}' because not matching manifest schema: {}",
                                              var_name, e.what());
                 return;
             }
+        } else {
+            this->validators.count_skipped();
         }
 
         callback(data);
     };
 
-    const auto var_topic = fmt::format("{}/var", this->config.mqtt_prefix(requirement_module_id, requirement_impl_id));
-
     // TODO(kai): multiple subscription should be perfectly fine here!
     std::shared_ptr<TypedHandler> token =
         std::make_shared<TypedHandler>(var_name, HandlerType::SubscribeVar, std::make_shared<Handler>(handler));
-    this->mqtt_abstraction.register_handler(var_topic, token, QOS::QOS2);
+    this->mqtt_abstraction.register_handler(implementation.var_topic, token, var_it->second.qos);
 }
 
 void Everest::subscribe_error(const Requirement& req, const std::string& error_type, const JsonCallback& callback) {
@@ -433,31 +555,22 @@ void Everest::subscribe_all_errors(const JsonCallback& callback) {
                                                         this->config.printable_identifier(this->module_id)));
     }
 
-    Handler handler = [this, callback](json const& data) {
-        EVLOG_debug << fmt::format(
-            "Incoming error {}->{}",
-            this->config.printable_identifier(data.at("origin").at("module"), data.at("origin").at("implementation")),
-            data.at("type"));
+    const auto handler = std::make_shared<Handler>([snapshot = this->config_snapshot, callback](json const& data) {
+        EVLOG_debug << fmt::format("Incoming error {}->{}", printable_origin(*snapshot, data.at("origin")),
+                                   data.at("type"));
         callback(data);
-    };
+    });
 
-    for (std::string module_id : Config::keys(this->config.get_main_config())) {
-        const std::string module_name = this->config.get_module_name(module_id);
-        const json provides = this->config.get_manifests().at(module_name).at("provides");
-        for (const auto& impl : provides.items()) {
-            const std::string impl_id = impl.key();
-            const std::string interface = impl.value().at("interface");
-            const json errors = this->config.get_interface_definition(interface).at("errors");
+    // all errors of all implementations share one handler
+    for (const auto* module : this->config_snapshot->get_modules()) {
+        for (const auto& [impl_id, implementation] : module->implementations) {
+            const auto& errors = implementation.interface_definition->at("errors");
             for (const auto& error_namespace_it : errors.items()) {
-                const std::string error_type_namespace = error_namespace_it.key();
                 for (const auto& error_name_it : error_namespace_it.value().items()) {
-                    const std::string error_type_name = error_name_it.key();
-                    const std::string error_topic =
-                        fmt::format("{}/error/{}/{}", this->config.mqtt_prefix(module_id, impl_id),
-                                    error_type_namespace, error_type_name);
-                    std::shared_ptr<TypedHandler> token =
-                        std::make_shared<TypedHandler>(HandlerType::SubscribeError, std::make_shared<Handler>(handler));
-                    this->mqtt_abstraction.register_handler(error_topic, token, QOS::QOS2);
+                    const auto error_topic = fmt::format("{}/error/{}/{}", implementation.mqtt_prefix,
+                                                         error_namespace_it.key(), error_name_it.key());
+                    this->mqtt_abstraction.register_handler(
+                        error_topic, std::make_shared<TypedHandler>(HandlerType::SubscribeError, handler), QOS::QOS2);
                 }
             }
         }
@@ -480,7 +593,7 @@ void Everest::subscribe_error_cleared(const Requirement& req, const std::string&
     std::string requirement_module_id = connection.at("module_id");
     std::string module_name = this->config.get_module_name(requirement_module_id);
     std::string requirement_impl_id = connection.at("implementation_id");
-    json requirement_impl_if = this->config.get_interfaces()[module_name][requirement_impl_id];
+    json requirement_impl_if = this->config.get_interfaces().at(module_name).at(requirement_impl_id);
 
     // check if requirement is allowed to publish this error_type
     // split error_type at '/'
@@ -522,31 +635,22 @@ void Everest::subscribe_all_errors_cleared(const JsonCallback& callback) {
                                                         this->config.printable_identifier(this->module_id)));
     }
 
-    Handler handler = [this, callback](json const& data) {
-        EVLOG_debug << fmt::format(
-            "Incoming error cleared {}->{}",
-            this->config.printable_identifier(data.at("origin").at("module"), data.at("origin").at("implementation")),
-            data.at("type"));
+    const auto handler = std::make_shared<Handler>([snapshot = this->config_snapshot, callback](json const& data) {
+        EVLOG_debug << fmt::format("Incoming error cleared {}->{}", printable_origin(*snapshot, data.at("origin")),
+                                   data.at("type"));
         callback(data);
-    };
+    });
 
-    for (std::string module_id : Config::keys(this->config.get_main_config())) {
-        const std::string module_name = this->config.get_module_name(module_id);
-        const json provides = this->config.get_manifests().at(module_name).at("provides");
-        for (const auto& impl : provides.items()) {
-            const std::string impl_id = impl.key();
-            const std::string interface = impl.value().at("interface");
-            const json errors = this->config.get_interface_definition(interface).at("errors");
+    // all errors of all implementations share one handler
+    for (const auto* module : this->config_snapshot->get_modules()) {
+        for (const auto& [impl_id, implementation] : module->implementations) {
+            const auto& errors = implementation.interface_definition->at("errors");
             for (const auto& error_namespace_it : errors.items()) {
-                const std::string error_type_namespace = error_namespace_it.key();
                 for (const auto& error_name_it : error_namespace_it.value().items()) {
-                    const std::string error_type_name = error_name_it.key();
-                    const std::string error_topic =
-                        fmt::format("{}/error-cleared/{}/{}", this->config.mqtt_prefix(module_id, impl_id),
-                                    error_type_namespace, error_type_name);
-                    std::shared_ptr<TypedHandler> token =
-                        std::make_shared<TypedHandler>(HandlerType::SubscribeError, std::make_shared<Handler>(handler));
-                    this->mqtt_abstraction.register_handler(error_topic, token, QOS::QOS2);
+                    const auto error_topic = fmt::format("{}/error-cleared/{}/{}", implementation.mqtt_prefix,
+                                                         error_namespace_it.key(), error_name_it.key());
+                    this->mqtt_abstraction.register_handler(
+                        error_topic, std::make_shared<TypedHandler>(HandlerType::SubscribeError, handler), QOS::QOS2);
                 }
             }
         }
@@ -619,14 +723,14 @@ json Everest::request_clear_error(const error::RequestClearErrorOption request_t
     std::string request_id = error::UUID().uuid;
     std::promise<json> res_promise;
     std::future<json> res_future = res_promise.get_future();
-    Handler res_handler = [this, &res_promise, request_id](json data) {
+    Handler res_handler = [this, &res_promise, request_id](const json& data) {
         auto& data_id = data.at("id");
         if (data_id != request_id) {
             EVLOG_debug << fmt::format("RES: data_id != request_id ({} != {})", data_id, request_id);
             return;
         }
         EVLOG_debug << fmt::format("Incoming res {} for request clear error", data_id);
-        res_promise.set_value(std::move(data));
+        res_promise.set_value(data);
     };
     const auto request_topic = fmt::format("{}request-clear-error", this->mqtt_everest_prefix);
     std::shared_ptr<TypedHandler> res_token = std::make_shared<TypedHandler>(
@@ -754,7 +858,7 @@ void Everest::signal_ready() {
 /// \brief Ready handler for global readyness (e.g. all modules are ready now).
 /// This will called when receiving the global ready signal from manager.
 ///
-void Everest::handle_ready(json data) {
+void Everest::handle_ready(const json& data) {
     BOOST_LOG_FUNCTION();
 
     EVLOG_debug << fmt::format("handle_ready: {}", data.dump());
@@ -791,77 +895,64 @@ void Everest::handle_ready(json data) {
 void Everest::provide_cmd(const std::string impl_id, const std::string cmd_name, const JsonCommand handler) {
     BOOST_LOG_FUNCTION();
 
-    // extract manifest definition of this command
-    json cmd_definition = get_cmd_definition(this->module_id, impl_id, cmd_name, false);
+    const auto& implementation = this->get_provided_implementation(impl_id);
+    const auto& cmd = this->get_cmd_route(implementation, cmd_name, false);
 
     if (this->registered_cmds.count(impl_id) != 0 && this->registered_cmds[impl_id].count(cmd_name) != 0) {
         EVLOG_AND_THROW(EverestApiError(fmt::format(
             "{}->{}(...): Handler for this cmd already registered (you can not register a cmd handler twice)!",
-            this->config.printable_identifier(this->module_id, impl_id), cmd_name)));
+            implementation.identifier, cmd_name)));
     }
 
-    const auto cmd_topic = fmt::format("{}/cmd", this->config.mqtt_prefix(this->module_id, impl_id));
-
-    // define command wrapper
-    Handler wrapper = [this, cmd_topic, impl_id, cmd_name, handler, cmd_definition](json data) {
+    // define command wrapper, the schemas were compiled with the routing table
+    Handler wrapper = [this, &implementation, &cmd, cmd_name, handler](const json& data) {
         BOOST_LOG_FUNCTION();
 
-        std::set<std::string> arg_names;
-        if (cmd_definition.contains("arguments")) {
-            arg_names = Config::keys(cmd_definition["arguments"]);
-        }
-
-        EVLOG_debug << fmt::format("Incoming {}->{}({}) for <handler>",
-                                   this->config.printable_identifier(this->module_id, impl_id), cmd_name,
-                                   fmt::join(arg_names, ","));
+        EVLOG_debug << fmt::format("Incoming {}->{}({}) for <handler>", implementation.identifier, cmd_name,
+                                   fmt::join(cmd.argument_names, ","));
 
         // check data and ignore it if not matching (publishing it should have
         // been prohibited already)
-        if (this->validate_data_with_schema) {
+        if (this->validators.is_enabled()) {
             try {
-                for (auto const& arg_name : arg_names) {
-                    if (!data["args"].contains(arg_name)) {
+                for (auto const& [arg_name, validator] : cmd.argument_validators) {
+                    if (!data.at("args").contains(arg_name)) {
                         EVLOG_AND_THROW(std::invalid_argument(
-                            fmt::format("Missing argument {} for {}!", arg_name,
-                                        this->config.printable_identifier(this->module_id, impl_id))));
+                            fmt::format("Missing argument {} for {}!", arg_name, implementation.identifier)));
                     }
-                    json_validator validator(
-                        [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                        Config::format_checker);
-                    validator.set_root_schema(cmd_definition["arguments"][arg_name]);
-                    validator.validate(data["args"][arg_name]);
+                    validator->validate(data.at("args").at(arg_name));
                 }
             } catch (const std::exception& e) {
                 EVLOG_warning << fmt::format("Ignoring incoming cmd '{}' because not matching manifest schema: {}",
                                              cmd_name, e.what());
                 return;
             }
+        } else {
+            this->validators.count_skipped();
         }
 
         // publish results
         json res_data = json({});
-        res_data["id"] = data["id"];
+        res_data["id"] = data.at("id");
 
         // call real cmd handler
-        res_data["retval"] = handler(data["args"]);
+        res_data["retval"] = handler(data.at("args"));
 
         // check retval agains manifest
-        if (this->validate_data_with_schema) {
+        if (this->validators.is_enabled()) {
             try {
                 // only use validator on non-null return types
-                if (!(res_data["retval"].is_null() &&
-                      (!cmd_definition.contains("result") || cmd_definition["result"].is_null()))) {
-                    json_validator validator(
-                        [this](const json_uri& uri, json& schema) { this->config.ref_loader(uri, schema); },
-                        Config::format_checker);
-                    validator.set_root_schema(cmd_definition["result"]);
-                    validator.validate(res_data["retval"]);
+                if (!(res_data["retval"].is_null() && cmd.result_validator == nullptr)) {
+                    if (cmd.result_validator == nullptr) {
+                        throw std::invalid_argument("cmd does not declare a result");
+                    }
+                    cmd.result_validator->validate(res_data["retval"]);
                 }
 
             } catch (const std::exception& e) {
                 EVLOG_warning << fmt::format("Ignoring return value of cmd '{}' because the validation of the result "
                                              "failed: {}\ndefinition: {}\ndata: {}",
-                                             cmd_name, e.what(), cmd_definition, res_data);
+                                             cmd_name, e.what(), *cmd.definition, res_data);
                 return;
             }
         }
@@ -871,12 +962,12 @@ void Everest::provide_cmd(const std::string impl_id, const std::string cmd_name,
 
         json res_publish_data = json::object({{"name", cmd_name}, {"type", "result"}, {"data", res_data}});
 
-        this->mqtt_abstraction.publish(cmd_topic, res_publish_data);
+        this->mqtt_abstraction.publish(implementation.cmd_topic, res_publish_data, cmd.qos);
     };
 
     auto typed_handler =
         std::make_shared<TypedHandler>(cmd_name, HandlerType::Call, std::make_shared<Handler>(wrapper));
-    this->mqtt_abstraction.register_handler(cmd_topic, typed_handler, QOS::QOS2);
+    this->mqtt_abstraction.register_handler(implementation.cmd_topic, typed_handler, cmd.qos);
 
     // this list of registered cmds will be used later on to check if all cmds
     // defined in manifest are provided by code
@@ -996,6 +1087,10 @@ bool Everest::is_telemetry_enabled() {
     return (this->telemetry_enabled && this->telemetry_config.has_value());
 }
 
+SchemaValidationStatistics Everest::get_schema_validation_statistics() const {
+    return this->validators.get_statistics();
+}
+
 std::string Everest::check_args(const Arguments& func_args, json manifest_args) {
     BOOST_LOG_FUNCTION();
 
@@ -2,8 +2,12 @@
 // Copyright 2020 - 2022 Pionix GmbH and Contributors to EVerest
 #include <thread>
 
+#include <sys/eventfd.h>
+#include <unistd.h>
+
 #include <fmt/format.h>
 
+#include <everest/exceptions.hpp>
 #include <everest/logging.hpp>
 
 #include <utils/message_queue.hpp>
@@ -13,130 +17,309 @@ namespace Everest {
 Message::Message(const std::string& topic, const std::string& payload) : topic(topic), payload(payload) {
 }
 
-MessageQueue::MessageQueue(const std::function<void(std::shared_ptr<Message> message)>& message_callback) :
-    message_callback(message_callback), running(true) {
-    this->worker_thread = std::thread([this]() {
-        while (true) {
-            std::shared_ptr<Message> message;
-            std::unique_lock<std::mutex> lock(this->queue_ctrl_mutex);
-            this->cv.wait(lock, [this]() { return !this->message_queue.empty() || this->running == false; });
+namespace {
+// released messages with a larger payload buffer give it back instead of pinning the memory in the pool
+constexpr size_t max_pooled_payload_capacity = 64 * 1024;
+} // namespace
+
+struct MessagePool::Pool {
+    std::mutex free_messages_mutex;
+    std::vector<std::unique_ptr<Message>> free_messages;
+    size_t max_pooled_messages;
+    std::atomic<uint64_t> allocations{0};
+    std::atomic<uint64_t> reuses{0};
+
+    explicit Pool(size_t max_pooled_messages) : max_pooled_messages(max_pooled_messages) {
+        this->free_messages.reserve(max_pooled_messages);
+    }
+};
+
+MessagePool::MessagePool(size_t max_pooled_messages) : pool(std::make_shared<Pool>(max_pooled_messages)) {
+}
+
+std::shared_ptr<Message> MessagePool::acquire(std::string_view topic, std::string_view payload) {
+    std::unique_ptr<Message> message;
+    {
+        std::lock_guard<std::mutex> lock(this->pool->free_messages_mutex);
+        if (!this->pool->free_messages.empty()) {
+            message = std::move(this->pool->free_messages.back());
+            this->pool->free_messages.pop_back();
+        }
+    }
+
+    // the reference count of the returned shared_ptr always needs an allocation
+    uint64_t allocations = 1;
+    if (message == nullptr) {
+        message = std::make_unique<Message>();
+        allocations++;
+    }
+    if (message->topic.capacity() < topic.size()) {
+        allocations++;
+    }
+    if (message->payload.capacity() < payload.size()) {
+        allocations++;
+    }
+    message->topic.assign(topic.data(), topic.size());
+    message->payload.assign(payload.data(), payload.size());
+
+    this->pool->allocations += allocations;
+    if (allocations == 1) {
+        this->pool->reuses++;
+    }
+
+    std::weak_ptr<Pool> weak_pool = this->pool;
+    return std::shared_ptr<Message>(message.release(), [weak_pool](Message* released_message) {
+        std::unique_ptr<Message> message(released_message);
+        auto pool = weak_pool.lock();
+        if (pool == nullptr) {
+            return;
+        }
+        if (message->payload.capacity() > max_pooled_payload_capacity) {
+            std::string().swap(message->payload);
+        }
+        std::lock_guard<std::mutex> lock(pool->free_messages_mutex);
+        if (pool->free_messages.size() < pool->max_pooled_messages) {
+            pool->free_messages.push_back(std::move(message));
+        }
+    });
+}
+
+uint64_t MessagePool::get_allocations() const {
+    return this->pool->allocations;
+}
+
+uint64_t MessagePool::get_reuses() const {
+    return this->pool->reuses;
+}
+
+MessageQueue::MessageQueue(const std::function<void(std::shared_ptr<Message> message)>& message_callback,
+                           size_t capacity, MessageQueueOverflowPolicy overflow_policy) :
+    ring(capacity), overflow_policy(overflow_policy), message_callback(message_callback), running(true) {
+    this->wakeup_fd = eventfd(0, 0);
+    this->space_fd = eventfd(0, 0);
+    if (this->wakeup_fd == -1 || this->space_fd == -1) {
+        EVLOG_AND_THROW(EverestInternalError("Could not setup eventfd for message queue"));
+    }
+
+    this->worker_thread = std::thread([this]() { this->run(); });
+}
+
+void MessageQueue::run() {
+    while (this->running) {
+        while (auto message = this->ring.pop()) {
+            // pairs with the fence in add(): either the producer sees the free slot or we see it waiting
+            std::atomic_thread_fence(std::memory_order_seq_cst);
+            if (this->producer_waiting.exchange(false)) {
+                eventfd_write(this->space_fd, 1);
+            }
+
+            // pass the message to the message callback
+            this->message_callback(std::move(*message));
+
             if (!this->running) {
                 return;
             }
+        }
 
-            message = this->message_queue.front();
-            this->message_queue.pop();
-            lock.unlock();
+        // the producer signals as soon as it adds a message to the empty ring
+        eventfd_t eventfd_buffer = 0;
+        eventfd_read(this->wakeup_fd, &eventfd_buffer);
+    }
+}
 
-            // pass the message to the message callback
-            this->message_callback(message);
+void MessageQueue::add(std::shared_ptr<Message> message) {
+    if (!this->ring.push(message)) {
+        switch (this->overflow_policy) {
+        case MessageQueueOverflowPolicy::DropOldest:
+            // the slot of the dropped message is the one the next push uses
+            while (!this->ring.push(message)) {
+                if (this->ring.pop().has_value()) {
+                    this->count_dropped_message();
+                }
+            }
+            break;
+        case MessageQueueOverflowPolicy::DropNewest:
+            this->count_dropped_message();
+            return;
+        case MessageQueueOverflowPolicy::Block:
+        default:
+            while (true) {
+                this->producer_waiting = true;
+                // pairs with the fence in run(): either we see the free slot or the worker sees us waiting
+                std::atomic_thread_fence(std::memory_order_seq_cst);
+                if (this->ring.push(message)) {
+                    this->producer_waiting = false;
+                    break;
+                }
+                if (!this->running) {
+                    return;
+                }
+                eventfd_t eventfd_buffer = 0;
+                eventfd_read(this->space_fd, &eventfd_buffer);
+            }
+            break;
         }
-    });
+    }
+
+    if (this->ring.was_empty_before_push()) {
+        eventfd_write(this->wakeup_fd, 1);
+    }
 }
 
-void MessageQueue::add(std::shared_ptr<Message> message) {
-    {
-        std::lock_guard<std::mutex> lock(this->queue_ctrl_mutex);
-        this->message_queue.push(message);
+void MessageQueue::count_dropped_message() {
+    if (this->dropped++ == 0) {
+        EVLOG_warning << "Message queue is full, dropping received messages. Further drops are only counted";
     }
-    this->cv.notify_all();
 }
 
 void MessageQueue::stop() {
-    {
-        std::lock_guard<std::mutex> lock(this->queue_ctrl_mutex);
-        this->running = false;
-    }
-    this->cv.notify_all();
+    this->running = false;
+    eventfd_write(this->wakeup_fd, 1);
+    eventfd_write(this->space_fd, 1);
+}
+
+uint64_t MessageQueue::get_dropped() const {
+    return this->dropped;
 }
 
 MessageQueue::~MessageQueue() {
     stop();
     worker_thread.join();
+    close(this->wakeup_fd);
+    close(this->space_fd);
 }
 
-MessageHandler::MessageHandler() : running(true) {
-    this->handler_thread = std::thread([this]() {
-        while (true) {
-            std::unique_lock<std::mutex> lock(this->handler_ctrl_mutex);
-            this->cv.wait(lock, [this]() { return !this->message_queue.empty() || this->running == false; });
-            if (!this->running) {
-                return;
-            }
+namespace {
+// number of messages a strand delivers before it yields its worker to other topics
+constexpr size_t max_messages_per_run = 16;
 
-            auto message = std::move(this->message_queue.front());
-            this->message_queue.pop();
-            lock.unlock();
+bool is_result_message(const json& data) {
+    if (!data.is_object()) {
+        return false;
+    }
+    const auto type_it = data.find("type");
+    return type_it != data.end() && *type_it == "result";
+}
+} // namespace
 
-            auto data = *message.get();
+MessageHandler::MessageHandler(ThreadPool& thread_pool) :
+    thread_pool(thread_pool), scheduled(false), running(true) {
+}
 
-            // get the registered handlers
-            std::vector<std::shared_ptr<TypedHandler>> local_handlers;
-            {
-                const std::lock_guard<std::mutex> handlers_lock(handler_list_mutex);
-                for (auto handler : this->handlers) {
-                    local_handlers.push_back(handler);
-                }
-            }
+void MessageHandler::run() {
+    for (size_t i = 0; i < max_messages_per_run; i++) {
+        std::unique_lock<std::mutex> lock(this->handler_ctrl_mutex);
+        if (this->message_queue.empty() || !this->running) {
+            this->scheduled = false;
+            return;
+        }
 
-            // distribute this message to the registered handlers
-            for (auto handler_ : local_handlers) {
-                auto handler = *handler_.get()->handler;
+        auto [message, topic] = std::move(this->message_queue.front());
+        this->message_queue.pop();
+        lock.unlock();
 
-                if (handler_->type == HandlerType::Call) {
-                    // unpack call
-                    if (handler_->name != data.at("name")) {
-                        continue;
-                    }
-                    if (data.at("type") == "call") {
-                        handler(data.at("data"));
-                    }
-                } else if (handler_->type == HandlerType::Result) {
-                    // unpack result
-                    if (handler_->name != data.at("name")) {
-                        continue;
-                    }
-                    if (data.at("type") == "result") {
-                        // only deliver result to handler with matching id
-                        if (handler_->id == data.at("data").at("id")) {
-                            handler(data.at("data"));
-                        }
-                    }
-                } else if (handler_->type == HandlerType::SubscribeVar) {
-                    // unpack var
-                    if (handler_->name != data.at("name")) {
-                        continue;
-                    }
+        this->dispatch(*message, topic);
+    }
+
+    // more messages are waiting, continue with them after other strands had their turn
+    this->thread_pool.post([this]() { this->run(); });
+}
+
+void MessageHandler::dispatch(const json& data, const std::string& topic) {
+    // get the registered handlers
+    std::vector<std::shared_ptr<TypedHandler>> local_handlers;
+    {
+        const std::lock_guard<std::mutex> handlers_lock(handler_list_mutex);
+        for (auto handler : this->handlers) {
+            local_handlers.push_back(handler);
+        }
+    }
+
+    // distribute this message to the registered handlers
+    for (auto handler_ : local_handlers) {
+        const auto& handler = *handler_->handler;
+
+        if (handler_->type == HandlerType::Call) {
+            // unpack call
+            if (handler_->name != data.at("name")) {
+                continue;
+            }
+            if (data.at("type") == "call") {
+                handler(data.at("data"));
+            }
+        } else if (handler_->type == HandlerType::Result) {
+            // unpack result, a handler without a name receives all results of its topic
+            if (!handler_->name.empty() && handler_->name != data.at("name")) {
+                continue;
+            }
+            if (data.at("type") == "result") {
+                // only deliver result to handler with matching id
+                if (handler_->id.empty() || handler_->id == data.at("data").at("id")) {
                     handler(data.at("data"));
-                } else {
-                    // external or unknown, no preprocessing
-                    handler(data);
                 }
             }
+        } else if (handler_->type == HandlerType::SubscribeVar) {
+            // unpack var, a batch contains several vars in the order they were published
+            const auto batch_it = data.find("batch");
+            if (batch_it != data.end()) {
+                for (const auto& var : *batch_it) {
+                    if (handler_->name == var.at("name")) {
+                        handler(var.at("data"));
+                    }
+                }
+                continue;
+            }
+            if (handler_->name != data.at("name")) {
+                continue;
+            }
+            handler(data.at("data"));
+        } else if (handler_->type == HandlerType::ExternalMQTTWithTopic) {
+            // the handler is registered for a topic filter, so it needs to know the topic of the message
+            handler(json{{"topic", topic}, {"payload", data}});
+        } else {
+            // external or unknown, no preprocessing
+            handler(data);
         }
-    });
+    }
 }
 
-void MessageHandler::add(std::shared_ptr<json> message) {
+void MessageHandler::add(std::shared_ptr<const json> message, std::string topic) {
+    if (is_result_message(*message) && this->only_result_handlers()) {
+        // result handlers only hand over the result to a waiting caller, which might itself occupy a worker of the
+        // thread pool, so never queue them behind other work. Topics with other handlers keep their strand and order
+        this->dispatch(*message, topic);
+        return;
+    }
+
+    bool schedule = false;
     {
         std::lock_guard<std::mutex> lock(this->handler_ctrl_mutex);
-        this->message_queue.push(message);
+        if (!this->running) {
+            return;
+        }
+        this->message_queue.emplace(std::move(message), std::move(topic));
+        if (!this->scheduled) {
+            this->scheduled = true;
+            schedule = true;
+        }
+    }
+
+    if (schedule) {
+        this->thread_pool.post([this]() { this->run(); });
     }
-    this->cv.notify_all();
 }
 
 void MessageHandler::stop() {
-    {
-        std::lock_guard<std::mutex> lock(this->handler_ctrl_mutex);
-        this->running = false;
-    }
-    this->cv.notify_all();
+    std::lock_guard<std::mutex> lock(this->handler_ctrl_mutex);
+    this->running = false;
 }
 
 void MessageHandler::add_handler(std::shared_ptr<TypedHandler> handler) {
     {
         std::lock_guard<std::mutex> lock(this->handler_list_mutex);
-        this->handlers.insert(handler);
+        if (this->handlers.insert(handler).second && handler->type != HandlerType::Result) {
+            this->non_result_handlers++;
+        }
     }
 }
 
@@ -144,10 +327,18 @@ void MessageHandler::remove_handler(std::shared_ptr<TypedHandler> handler) {
     {
         std::lock_guard<std::mutex> lock(this->handler_list_mutex);
         auto it = std::find(this->handlers.begin(), this->handlers.end(), handler);
+        if (it != this->handlers.end() && (*it)->type != HandlerType::Result) {
+            this->non_result_handlers--;
+        }
         this->handlers.erase(it);
     }
 }
 
+bool MessageHandler::only_result_handlers() {
+    std::lock_guard<std::mutex> lock(this->handler_list_mutex);
+    return this->non_result_handlers == 0;
+}
+
 size_t MessageHandler::count_handlers() {
     size_t count = 0;
     {
@@ -158,8 +349,8 @@ size_t MessageHandler::count_handlers() {
 }
 
 MessageHandler::~MessageHandler() {
+    // NOTE: the thread pool has to be stopped before its message handlers get destroyed
     stop();
-    handler_thread.join();
 }
 
 } // namespace Everest
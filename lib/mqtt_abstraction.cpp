@@ -8,8 +8,12 @@
 namespace Everest {
 MQTTAbstraction::MQTTAbstraction(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
                                  const std::string& mqtt_everest_prefix, const std::string& mqtt_external_prefix) :
-    mqtt_abstraction(std::make_unique<MQTTAbstractionImpl>(mqtt_server_address, mqtt_server_port, mqtt_everest_prefix,
-                                                           mqtt_external_prefix)) {
+    MQTTAbstraction(MQTTSettings{mqtt_server_address, std::stoi(mqtt_server_port), mqtt_everest_prefix,
+                                 mqtt_external_prefix}) {
+}
+
+MQTTAbstraction::MQTTAbstraction(const MQTTSettings& mqtt_settings) :
+    mqtt_abstraction(std::make_unique<MQTTAbstractionImpl>(mqtt_settings)) {
     EVLOG_debug << "initialized mqtt_abstraction";
 }
 
@@ -25,24 +29,24 @@ void MQTTAbstraction::disconnect() {
     mqtt_abstraction->disconnect();
 }
 
-void MQTTAbstraction::publish(const std::string& topic, const json& json) {
+bool MQTTAbstraction::publish(const std::string& topic, const json& json) {
     BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, json);
+    return mqtt_abstraction->publish(topic, json);
 }
 
-void MQTTAbstraction::publish(const std::string& topic, const json& json, QOS qos) {
+bool MQTTAbstraction::publish(const std::string& topic, const json& json, QOS qos) {
     BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, json, qos);
+    return mqtt_abstraction->publish(topic, json, qos);
 }
 
-void MQTTAbstraction::publish(const std::string& topic, const std::string& data) {
+bool MQTTAbstraction::publish(const std::string& topic, const std::string& data) {
     BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, data);
+    return mqtt_abstraction->publish(topic, data);
 }
 
-void MQTTAbstraction::publish(const std::string& topic, const std::string& data, QOS qos) {
+bool MQTTAbstraction::publish(const std::string& topic, const std::string& data, QOS qos) {
     BOOST_LOG_FUNCTION();
-    mqtt_abstraction->publish(topic, data, qos);
+    return mqtt_abstraction->publish(topic, data, qos);
 }
 
 void MQTTAbstraction::subscribe(const std::string& topic) {
@@ -75,4 +79,9 @@ void MQTTAbstraction::unregister_handler(const std::string& topic, const Token&
     mqtt_abstraction->unregister_handler(topic, token);
 }
 
+MQTTStatistics MQTTAbstraction::get_statistics() const {
+    BOOST_LOG_FUNCTION();
+    return mqtt_abstraction->get_statistics();
+}
+
 } // namespace Everest
@@ -3,15 +3,16 @@
 #include <algorithm>
 #include <chrono>
 #include <cstdio>
+#include <cstring>
 #include <sstream>
 #include <thread>
 
 #include <fcntl.h>
 #include <netdb.h>
 #include <netinet/tcp.h>
-#include <poll.h>
 #include <sys/eventfd.h>
 #include <sys/socket.h>
+#include <sys/un.h>
 
 #include <boost/algorithm/string.hpp>
 #include <boost/algorithm/string/split.hpp>
@@ -24,75 +25,162 @@
 
 namespace Everest {
 const auto mqtt_keep_alive = 400;
+// upper bound of the fixed header, packet id and length fields of a MQTT control packet
+const auto mqtt_control_packet_size = 16;
+// capacity up to which the serialization buffer of a publishing thread is kept for the next publish
+const auto max_pooled_payload_size = 64 * 1024;
 
 MessageWithQOS::MessageWithQOS(const std::string& topic, const std::string& payload, QOS qos) :
     Message(topic, payload), qos(qos) {
 }
 
-MQTTAbstractionImpl::MQTTAbstractionImpl(const std::string& mqtt_server_address, const std::string& mqtt_server_port,
-                                         const std::string& mqtt_everest_prefix,
-                                         const std::string& mqtt_external_prefix) :
-    message_queue(([this](std::shared_ptr<Message> message) { this->on_mqtt_message(message); })),
-    mqtt_server_address(mqtt_server_address),
-    mqtt_server_port(mqtt_server_port),
-    mqtt_everest_prefix(mqtt_everest_prefix),
-    mqtt_external_prefix(mqtt_external_prefix),
+MQTTAbstractionImpl::MQTTAbstractionImpl(const MQTTSettings& mqtt_settings) :
+    shared_memory(mqtt_settings.shared_memory_threshold, mqtt_settings.shared_memory_max_size,
+                  mqtt_settings.shared_memory_lease),
+    handler_thread_pool(mqtt_settings.handler_threads),
+    message_queue(([this](std::shared_ptr<Message> message) { this->on_mqtt_message(message); }),
+                  mqtt_settings.message_queue_size, mqtt_settings.message_queue_overflow_policy),
+    publish_queue(mqtt_settings.publish_queue_size, mqtt_settings.publish_queue_overflow_policy,
+                  mqtt_settings.publish_queue_timeout),
+    offline_queue_size(mqtt_settings.offline_queue_size),
+    reconnect_backoff(mqtt_settings.reconnect_initial_backoff, mqtt_settings.reconnect_max_backoff),
+    mqtt_server_address(mqtt_settings.broker_host),
+    mqtt_server_port(std::to_string(mqtt_settings.broker_port)),
+    mqtt_server_socket_path(mqtt_settings.broker_socket_path),
+    mqtt_everest_prefix(mqtt_settings.everest_prefix),
+    mqtt_external_prefix(mqtt_settings.external_prefix),
+    everest_encoding(mqtt_settings.everest_encoding),
     mqtt_client{},
-    sendbuf{},
-    recvbuf{} {
+    mqtt_buffers(mqtt_settings.buffer_initial_size, mqtt_settings.buffer_max_size) {
     BOOST_LOG_FUNCTION();
 
     EVLOG_debug << "Initializing MQTT abstraction layer...";
-
-    this->mqtt_is_connected = false;
-
-    this->mqtt_client.publish_response_callback_state = &this->message_queue;
 }
 
 MQTTAbstractionImpl::~MQTTAbstractionImpl() {
     // FIXME (aw): verify that disconnecting is thread-safe!
-    if (this->mqtt_is_connected) {
+    if (!this->disconnect_requested) {
         disconnect();
     }
-    // this->mqtt_mainloop_thread.join();
+    // the main loop stops after the disconnect, it must not use any member once the destructor body is left
+    this->mqtt_mainloop_thread.stop();
 }
 
 bool MQTTAbstractionImpl::connect() {
     BOOST_LOG_FUNCTION();
 
-    EVLOG_debug << fmt::format("Connecting to MQTT broker: {}:{}", this->mqtt_server_address, this->mqtt_server_port);
+    if (!this->mqtt_server_socket_path.empty()) {
+        EVLOG_debug << fmt::format("Connecting to MQTT broker: {}", this->mqtt_server_socket_path);
+    } else {
+        EVLOG_debug << fmt::format("Connecting to MQTT broker: {}:{}", this->mqtt_server_address,
+                                   this->mqtt_server_port);
+    }
 
-    return connectBroker(this->mqtt_server_address.c_str(), this->mqtt_server_port.c_str());
+    return connectBroker();
 }
 
 void MQTTAbstractionImpl::disconnect() {
     BOOST_LOG_FUNCTION();
 
-    mqtt_disconnect(&this->mqtt_client);
+    if (this->mqtt_is_connected) {
+        const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+        // messages published before still go out ahead of the disconnect
+        this->send_queued_publishes();
+        this->mqtt_buffers.reserve_send_space(this->mqtt_client, mqtt_control_packet_size);
+        mqtt_disconnect(&this->mqtt_client);
+    }
+
+    {
+        // stops the main loop, also if it is waiting to reconnect. Only set once the disconnect is queued, so the main
+        // loop sends it in its final sync
+        const std::lock_guard<std::mutex> lock(this->reconnect_mutex);
+        this->disconnect_requested = true;
+    }
+    this->reconnect_cv.notify_all();
+    // blocked publishers give up, nothing is sent anymore
+    this->publish_queue.stop();
     // FIXME(kai): always set connected to false for the moment
     this->mqtt_is_connected = false;
+    // wakes up the main loop, so it sends the disconnect and stops
+    notify_write_data();
 }
 
-void MQTTAbstractionImpl::publish(const std::string& topic, const json& json) {
+bool MQTTAbstractionImpl::publish(const std::string& topic, const json& json) {
     BOOST_LOG_FUNCTION();
 
-    publish(topic, json, QOS::QOS2);
+    return publish(topic, json, QOS::QOS2);
 }
 
-void MQTTAbstractionImpl::publish(const std::string& topic, const json& json, QOS qos) {
+bool MQTTAbstractionImpl::publish(const std::string& topic, const json& json, QOS qos) {
     BOOST_LOG_FUNCTION();
 
-    std::string data = json.dump();
-    publish(topic, data, qos);
+    // every publishing thread serializes into its own buffer that keeps its capacity, so a publish usually does not
+    // allocate; mqtt_publish then copies the payload straight into the send buffer of MQTT-C
+    thread_local PayloadEncoder encoder;
+    const auto encoding =
+        (topic.find(this->mqtt_everest_prefix) == 0) ? this->everest_encoding : PayloadEncoding::Json;
+    const auto queued = publish(topic, encoder.encode(json, encoding), qos);
+    encoder.shrink_to(max_pooled_payload_size);
+    return queued;
 }
 
-void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data) {
+bool MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data) {
     BOOST_LOG_FUNCTION();
 
-    publish(topic, data, QOS::QOS0);
+    return publish(topic, data, QOS::QOS0);
+}
+
+bool MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data, QOS qos) {
+    BOOST_LOG_FUNCTION();
+
+    {
+        const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
+        if (!this->mqtt_is_connected) {
+            // buffered until the connection is (re)established, the oldest messages make room for new ones
+            this->messages_buffered++;
+            this->messages_before_connected.push_back(std::make_shared<MessageWithQOS>(topic, data, qos));
+            while (this->messages_before_connected.size() > this->offline_queue_size) {
+                this->messages_before_connected.pop_front();
+                this->offline_messages_dropped++;
+            }
+            return true;
+        }
+    }
+
+    // the publish queue is filled without holding any lock the main loop needs, so it can drain the queue while this
+    // publisher waits for room
+    const auto descriptor = share_payload(topic, data);
+    if (!this->publish_queue.push(topic, descriptor.has_value() ? descriptor.value() : data, qos)) {
+        return false;
+    }
+    notify_write_data();
+    return true;
+}
+
+std::optional<std::string> MQTTAbstractionImpl::share_payload(const std::string& topic, const std::string& data) {
+    // large payloads on everest topics are handed over via shared memory, only a descriptor goes through the broker
+    if (this->shared_memory.accepts(data.size()) && topic.find(this->mqtt_everest_prefix) == 0) {
+        return this->shared_memory.publish(topic, data);
+    }
+    return std::nullopt;
+}
+
+bool MQTTAbstractionImpl::send_queued_publishes() {
+    return this->publish_queue.drain([this](const QueuedPublish& message) {
+        // a handler registered before this message was published has to be subscribed before the message goes out,
+        // it might receive the reply to it
+        this->send_subscription_changes();
+        return this->send_publish(message.topic, message.payload, message.qos);
+    }) > 0;
 }
 
-void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& data, QOS qos) {
+void MQTTAbstractionImpl::send_subscription_changes() {
+    if (this->subscription_batch.pending()) {
+        this->subscription_batch.flush(this->mqtt_client, this->mqtt_buffers);
+    }
+}
+
+bool MQTTAbstractionImpl::send_publish(const std::string& topic, std::string_view payload, QOS qos) {
     BOOST_LOG_FUNCTION();
 
     auto publish_flags = 0;
@@ -111,19 +199,23 @@ void MQTTAbstractionImpl::publish(const std::string& topic, const std::string& d
         break;
     }
 
-    if (!this->mqtt_is_connected) {
-        const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
-        this->messages_before_connected.push_back(std::make_shared<MessageWithQOS>(topic, data, qos));
-        return;
+    const auto size = topic.size() + payload.size() + mqtt_control_packet_size;
+    if (!this->mqtt_buffers.reserve_send_space(this->mqtt_client, size)) {
+        if (this->mqtt_buffers.fits_send_buffer(size)) {
+            // the send buffer is full, the message has to wait until MQTT-C sent enough of it
+            return false;
+        }
+        EVLOG_error << fmt::format("Dropping message of {} bytes on topic {}, it exceeds the MQTT buffer limit",
+                                   payload.size(), topic);
+        return true;
     }
-
-    MQTTErrors error = mqtt_publish(&this->mqtt_client, topic.c_str(), data.c_str(), data.size(), publish_flags);
+    MQTTErrors error = mqtt_publish(&this->mqtt_client, topic.c_str(), payload.data(), payload.size(), publish_flags);
     if (error != MQTT_OK) {
         EVLOG_error << fmt::format("MQTT Error {}", mqtt_error_str(error));
     }
-    notify_write_data();
 
     EVLOG_debug << fmt::format("publishing to {}", topic);
+    return true;
 }
 
 void MQTTAbstractionImpl::subscribe(const std::string& topic) {
@@ -150,14 +242,22 @@ void MQTTAbstractionImpl::subscribe(const std::string& topic, QOS qos) {
         break;
     }
 
-    mqtt_subscribe(&this->mqtt_client, topic.c_str(), max_qos_level);
+    {
+        const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+        this->mqtt_buffers.reserve_send_space(this->mqtt_client, topic.size() + mqtt_control_packet_size);
+        mqtt_subscribe(&this->mqtt_client, topic.c_str(), max_qos_level);
+    }
     notify_write_data();
 }
 
 void MQTTAbstractionImpl::unsubscribe(const std::string& topic) {
     BOOST_LOG_FUNCTION();
 
-    mqtt_unsubscribe(&this->mqtt_client, topic.c_str());
+    {
+        const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+        this->mqtt_buffers.reserve_send_space(this->mqtt_client, topic.size() + mqtt_control_packet_size);
+        mqtt_unsubscribe(&this->mqtt_client, topic.c_str());
+    }
     notify_write_data();
 }
 
@@ -171,28 +271,57 @@ std::future<void> MQTTAbstractionImpl::spawn_main_loop_thread() {
 
     std::packaged_task<void(void)> task([this]() {
         try {
-            while (this->mqtt_is_connected) {
-
-                eventfd_t eventfd_buffer;
-                struct pollfd pollfds[2] = {{this->mqtt_socket_fd, POLLIN, 0}, {this->event_fd, POLLIN, 0}};
-                auto retval = ::poll(pollfds, 2, mqtt_poll_timeout_ms);
-
-                if (retval >= 0) {
-                    // check for write notification and reset it
-                    if (pollfds[1].revents & POLLIN) {
-                        // FIXME (aw): check for failure
-                        eventfd_read(this->event_fd, &eventfd_buffer);
+            this->event_loop.watch_notify_fd(this->event_fd);
+            this->event_loop.watch_socket(this->mqtt_socket_fd);
+            bool sync_due = true;
+            while (true) {
+                MQTTErrors error = MQTT_OK;
+                {
+                    const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+                    if (sync_due) {
+                        this->send_subscription_changes();
+                        this->send_queued_publishes();
+                        error = mqtt_sync(&this->mqtt_client);
+                        // a full buffer is grown and the client keeps going, the data is retried on the next sync
+                        if (error != MQTT_OK && this->mqtt_buffers.recover(this->mqtt_client, error)) {
+                            error = MQTT_OK;
+                            notify_write_data();
+                        }
+                        // acknowledgements handled by the sync may have made room for messages still waiting in the
+                        // publish queue, they are sent right away on the next iteration
+                        if (error == MQTT_OK && this->send_queued_publishes()) {
+                            notify_write_data();
+                        }
                     }
+                    this->mqtt_buffers.shrink_if_idle(this->mqtt_client);
+                    if (error == MQTT_OK) {
+                        this->event_loop.schedule(this->mqtt_client, mqtt_housekeeping_interval_s);
+                    }
+                }
+                this->shared_memory.release_segments();
 
-                    MQTTErrors error = mqtt_sync(&this->mqtt_client);
-                    if (error != MQTT_OK) {
-                        EVLOG_error << fmt::format("Error during MQTT sync: {}", mqtt_error_str(error));
+                if (error != MQTT_OK) {
+                    EVLOG_error << fmt::format("Error during MQTT sync: {}", mqtt_error_str(error));
 
-                        on_mqtt_disconnect();
+                    on_mqtt_disconnect();
 
+                    if (!reconnect()) {
                         return;
                     }
+                    this->event_loop.watch_socket(this->mqtt_socket_fd);
+                    sync_due = true;
+                    continue;
+                }
+                if (this->disconnect_requested) {
+                    // the disconnect and the last publishes may have been queued after the sync above, nobody sends
+                    // them once the main loop is gone
+                    const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+                    mqtt_sync(&this->mqtt_client);
+                    return;
                 }
+
+                // only syncs when there is something to do, not on housekeeping wake-ups
+                sync_due = this->event_loop.wait();
             }
         } catch (boost::exception& e) {
             EVLOG_critical << fmt::format("Caught MQTT mainloop boost::exception:\n{}",
@@ -217,45 +346,60 @@ void MQTTAbstractionImpl::on_mqtt_message(std::shared_ptr<Message> message) {
     const std::string& payload = message->payload;
 
     try {
-        std::shared_ptr<json> data;
+        // the payload is parsed exactly once, all handlers share the resulting immutable document
+        std::shared_ptr<const json> data;
         bool is_everest_topic = false;
         if (topic.find(mqtt_everest_prefix) == 0) {
             EVLOG_debug << fmt::format("topic {} starts with {}", topic, mqtt_everest_prefix);
             is_everest_topic = true;
             try {
-                data = std::make_shared<json>(json::parse(payload));
+                if (SharedMemoryTransport::is_descriptor(payload)) {
+                    data = this->shared_memory.read(topic, payload, this->everest_encoding);
+                    if (data == nullptr) {
+                        return;
+                    }
+                } else {
+                    data = std::make_shared<const json>(
+                        decode_payload(payload.data(), payload.data() + payload.size(), this->everest_encoding));
+                }
+                this->documents_parsed++;
             } catch (nlohmann::detail::parse_error& e) {
-                EVLOG_warning << fmt::format("Could not decode json for incoming topic '{}': {}", topic, payload);
+                this->parse_errors++;
+                EVLOG_warning << fmt::format("Could not decode payload for incoming topic '{}': {}", topic, e.what());
                 return;
             }
         } else {
             EVLOG_debug << fmt::format("Message parsing for topic '{}' not implemented. Wrapping in json object.",
                                        topic);
-            data = std::make_shared<json>(json(payload));
+            data = std::make_shared<const json>(payload);
         }
 
-        bool found = false;
+        // message handlers are never removed, so they can be used after the lock is released. Handing the message
+        // over without the lock allows handlers that are called directly to register and unregister handlers
+        std::vector<MessageHandler*> matching_handlers;
 
         std::unique_lock<std::mutex> lock(handlers_mutex);
-        std::vector<Handler> local_handlers;
-        for (auto& [handler_topic, handler] : this->message_handlers) {
-            bool topic_matches = false;
+        if (is_everest_topic) {
+            // everest topics never contain wildcards, so a direct lookup is enough
+            const auto handler_it = this->message_handlers.find(topic);
+            if (handler_it != this->message_handlers.end()) {
+                matching_handlers.push_back(&handler_it->second);
+            }
+        } else {
+            this->message_handler_routes.match(
+                topic, [&matching_handlers](MessageHandler* handler) { matching_handlers.push_back(handler); });
+        }
+        lock.unlock();
+
+        for (auto* handler : matching_handlers) {
             if (is_everest_topic) {
-                // everest topics never contain wildcards, so a direct comparison is enough
-                if (topic == handler_topic) {
-                    topic_matches = true;
-                }
+                handler->add(data);
             } else {
-                topic_matches = MQTTAbstractionImpl::check_topic_matches(topic, handler_topic);
-            }
-            if (topic_matches) {
-                found = true;
-                handler.add(data);
+                handler->add(data, topic);
             }
         }
-        lock.unlock();
 
-        if (!found) {
+        if (matching_handlers.empty()) {
             EVLOG_AND_THROW(
                 EverestInternalError(fmt::format("Internal error: topic '{}' should have a matching handler!", topic)));
         }
@@ -275,29 +419,91 @@ void MQTTAbstractionImpl::on_mqtt_connect() {
 
     EVLOG_debug << "Connected to MQTT broker";
 
-    // subscribe to all topics needed by currently registered handlers
+    // subscribe to all topics needed by currently registered handlers, changes from before are covered by that
     EVLOG_debug << "Subscribing to needed MQTT topics...";
     const std::lock_guard<std::mutex> lock(handlers_mutex);
+    this->subscription_batch.clear();
     for (auto const& [topic, handler] : this->message_handlers) {
+        const auto qos_it = this->subscription_qos.find(topic);
+        if (qos_it == this->subscription_qos.end()) {
+            continue;
+        }
         EVLOG_debug << fmt::format("Subscribing to {}", topic);
-        subscribe(topic); // FIXME(kai): get QOS from handler
+        this->subscription_batch.subscribe(topic, qos_it->second);
     }
 
     // this will allow new handlers to subscribe directly, if needed
     {
         const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
         this->mqtt_is_connected = true;
+        const std::lock_guard<std::mutex> buffers_lock(this->mqtt_buffers_mutex);
+        this->send_subscription_changes();
+        // messages that were queued before the connection was lost go out first
+        this->send_queued_publishes();
+        // buffered messages go out in order through the publish queue, the ones that do not fit into the send buffer
+        // yet are retried by the main loop
         for (auto& message : this->messages_before_connected) {
-            this->publish(message->topic, message->payload, message->qos);
+            const auto descriptor = share_payload(message->topic, message->payload);
+            if (!this->publish_queue.try_push(message->topic,
+                                              descriptor.has_value() ? descriptor.value() : message->payload,
+                                              message->qos)) {
+                this->offline_messages_dropped++;
+            }
         }
         this->messages_before_connected.clear();
+        this->send_queued_publishes();
     }
+    notify_write_data();
 }
 
 void MQTTAbstractionImpl::on_mqtt_disconnect() {
     BOOST_LOG_FUNCTION();
 
-    EVLOG_AND_THROW(EverestInternalError("Lost connection to MQTT broker"));
+    EVLOG_warning << "Lost connection to MQTT broker";
+    this->connection_losses++;
+
+    // from now on publishes are buffered until the connection is reestablished
+    {
+        const std::lock_guard<std::mutex> lock(messages_before_connected_mutex);
+        this->mqtt_is_connected = false;
+    }
+
+    // anything still queued in the MQTT-C client is lost with the connection
+    const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+    close(this->mqtt_socket_fd);
+    this->mqtt_socket_fd = -1;
+}
+
+bool MQTTAbstractionImpl::reconnect() {
+    BOOST_LOG_FUNCTION();
+
+    const auto outage_start = std::chrono::steady_clock::now();
+    this->reconnect_backoff.reset();
+    while (true) {
+        {
+            std::unique_lock<std::mutex> lock(this->reconnect_mutex);
+            if (this->reconnect_cv.wait_for(lock, this->reconnect_backoff.next(),
+                                            [this]() { return this->disconnect_requested.load(); })) {
+                return false;
+            }
+        }
+
+        this->reconnect_attempts++;
+        EVLOG_info << "Reconnecting to MQTT broker";
+        if (connectBroker()) {
+            const auto outage_ms = static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - outage_start)
+                    .count());
+            this->reconnects++;
+            this->last_outage_ms = outage_ms;
+            this->total_outage_ms += outage_ms;
+            if (outage_ms > this->longest_outage_ms) {
+                this->longest_outage_ms = outage_ms;
+            }
+            EVLOG_info << fmt::format("Reconnected to MQTT broker after {}ms", outage_ms);
+            return true;
+        }
+    }
 }
 
 void MQTTAbstractionImpl::register_handler(const std::string& topic, std::shared_ptr<TypedHandler> handler, QOS qos) {
@@ -325,6 +531,7 @@ void MQTTAbstractionImpl::register_handler(const std::string& topic, std::shared
                                    fmt::ptr(&handler->handler), handler->name, topic);
         break;
     case HandlerType::ExternalMQTT:
+    case HandlerType::ExternalMQTTWithTopic:
         EVLOG_debug << fmt::format("Registering external MQTT handler {} on topic {}", fmt::ptr(&handler->handler),
                                    topic);
         break;
@@ -335,18 +542,38 @@ void MQTTAbstractionImpl::register_handler(const std::string& topic, std::shared
 
     const std::lock_guard<std::mutex> lock(handlers_mutex);
 
-    if (this->message_handlers.count(topic) == 0) {
-        this->message_handlers.emplace(std::piecewise_construct, std::forward_as_tuple(topic), std::forward_as_tuple());
+    auto handler_it = this->message_handlers.find(topic);
+    if (handler_it == this->message_handlers.end()) {
+        handler_it = this->message_handlers
+                         .emplace(std::piecewise_construct, std::forward_as_tuple(topic),
+                                  std::forward_as_tuple(this->handler_thread_pool))
+                         .first;
+        this->message_handler_routes.insert(topic, &handler_it->second);
+    }
+    auto& topic_message_handler = handler_it->second;
+    topic_message_handler.add_handler(handler);
+
+    // a topic is subscribed with the highest QoS requested by its handlers
+    const auto [qos_it, first_handler] = this->subscription_qos.emplace(topic, qos);
+    const auto raise_qos = !first_handler && qos > qos_it->second;
+    if (raise_qos) {
+        qos_it->second = qos;
+    }
+    // large payloads on the topic are only held in shared memory for readers registered before they subscribed
+    if (first_handler && topic.find(this->mqtt_everest_prefix) == 0) {
+        this->shared_memory.subscribe(topic);
     }
-    this->message_handlers[topic].add_handler(handler);
 
-    // only subscribe for this topic if we aren't already and the mqtt client is connected
+    // only subscribe for this topic if we aren't already or need a higher QoS and the mqtt client is connected
     // if we are not connected the on_mqtt_connect() callback will subscribe to the topic
-    if (this->mqtt_is_connected && this->message_handlers[topic].count_handlers() == 1) {
+    // the subscription is sent by the main loop together with those of other handlers registered in the meantime
+    if (this->mqtt_is_connected && (first_handler || raise_qos)) {
         EVLOG_debug << fmt::format("Subscribing to {}", topic);
-        this->subscribe(topic, qos);
+        if (this->subscription_batch.subscribe(topic, qos_it->second)) {
+            notify_write_data();
+        }
     }
-    EVLOG_debug << fmt::format("#handler[{}] = {}", topic, this->message_handlers[topic].count_handlers());
+    EVLOG_debug << fmt::format("#handler[{}] = {}", topic, topic_message_handler.count_handlers());
 }
 
 void MQTTAbstractionImpl::unregister_handler(const std::string& topic, const Token& token) {
@@ -366,10 +593,14 @@ void MQTTAbstractionImpl::unregister_handler(const std::string& topic, const Tok
 
     // unsubscribe if this was the last handler for this topic
     if (number_of_handlers == 0) {
+        this->subscription_qos.erase(topic);
+        this->shared_memory.unsubscribe(topic);
         // TODO(kai): should we throw/log an error if we are not connected?
         if (this->mqtt_is_connected) {
             EVLOG_debug << fmt::format("Unsubscribing from {}", topic);
-            this->unsubscribe(topic);
+            if (this->subscription_batch.unsubscribe(topic)) {
+                notify_write_data();
+            }
         }
     }
 
@@ -377,40 +608,60 @@ void MQTTAbstractionImpl::unregister_handler(const std::string& topic, const Tok
     EVLOG_debug << fmt::format("#handler[{}] = {}", topic, handler_count);
 }
 
-bool MQTTAbstractionImpl::connectBroker(const char* host, const char* port) {
+bool MQTTAbstractionImpl::connectBroker() {
     BOOST_LOG_FUNCTION();
 
-    /* open the non-blocking TCP socket (connecting to the broker) */
-    mqtt_socket_fd = open_nb_socket(host, port);
+    /* open the non-blocking unix domain or TCP socket (connecting to the broker) */
+    const auto use_unix_socket = !this->mqtt_server_socket_path.empty();
+    if (use_unix_socket) {
+        mqtt_socket_fd = open_nb_unix_socket(this->mqtt_server_socket_path.c_str());
+    } else {
+        mqtt_socket_fd = open_nb_socket(this->mqtt_server_address.c_str(), this->mqtt_server_port.c_str());
+    }
 
     if (mqtt_socket_fd == -1) {
         EVLOG_error << fmt::format("Failed to open socket: {}", strerror(errno));
         return false;
     }
 
-    this->event_fd = eventfd(0, 0);
+    // the eventfd is kept across reconnects, the main loop polls it
+    if (this->event_fd == -1) {
+        this->event_fd = eventfd(0, 0);
+    }
     if (this->event_fd == -1) {
         close(this->mqtt_socket_fd);
+        this->mqtt_socket_fd = -1;
         EVLOG_error << "Could not setup eventfd for mqttc io";
         return false;
     }
 
     // Set TCP_NODELAY option. To take full advantage, this should also be set in mosquitto config.
-    // This avoids about 40ms latency on small MQTT publishes
-    int enable = 1;
-    setsockopt(mqtt_socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
-
-    mqtt_init(&this->mqtt_client, mqtt_socket_fd, static_cast<uint8_t*>(this->sendbuf), sizeof(this->sendbuf),
-              static_cast<uint8_t*>(this->recvbuf), sizeof(this->recvbuf), MQTTAbstractionImpl::publish_callback);
-    uint8_t connect_flags = MQTT_CONNECT_CLEAN_SESSION;
-    /* Send connection request to the broker. */
-    if (mqtt_connect(&this->mqtt_client, nullptr, nullptr, nullptr, 0, nullptr, nullptr, connect_flags,
-                     mqtt_keep_alive) == MQTT_OK) {
+    // This avoids about 40ms latency on small MQTT publishes, unix domain sockets do not delay small writes at all
+    if (!use_unix_socket) {
+        int enable = 1;
+        setsockopt(mqtt_socket_fd, IPPROTO_TCP, TCP_NODELAY, &enable, sizeof(enable));
+    }
+
+    MQTTErrors error = MQTT_OK;
+    {
+        // every connection starts with a fresh client, the state of a lost connection is discarded
+        const std::lock_guard<std::mutex> lock(this->mqtt_buffers_mutex);
+        this->mqtt_client = {};
+        this->mqtt_client.publish_response_callback_state = this;
+        this->mqtt_buffers.init(this->mqtt_client, mqtt_socket_fd, MQTTAbstractionImpl::publish_callback);
+        uint8_t connect_flags = MQTT_CONNECT_CLEAN_SESSION;
+        /* Send connection request to the broker. */
+        error = mqtt_connect(&this->mqtt_client, nullptr, nullptr, nullptr, 0, nullptr, nullptr, connect_flags,
+                             mqtt_keep_alive);
+    }
+    if (error == MQTT_OK) {
         // TODO(kai): async?
         on_mqtt_connect();
         return true;
     }
 
+    close(this->mqtt_socket_fd);
+    this->mqtt_socket_fd = -1;
     return false;
 }
 
@@ -463,6 +714,37 @@ int MQTTAbstractionImpl::open_nb_socket(const char* addr, const char* port) {
     return sockfd;
 }
 
+int MQTTAbstractionImpl::open_nb_unix_socket(const char* path) {
+    BOOST_LOG_FUNCTION();
+
+    struct sockaddr_un addr = {};
+    addr.sun_family = AF_UNIX;
+    if (strlen(path) >= sizeof(addr.sun_path)) {
+        errno = ENAMETOOLONG;
+        return -1;
+    }
+    strncpy(addr.sun_path, path, sizeof(addr.sun_path) - 1);
+
+    int sockfd = socket(AF_UNIX, SOCK_STREAM, 0);
+    if (sockfd == -1) {
+        return -1;
+    }
+
+    /* connect to server */
+    // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast): sockaddr_un has to be passed as sockaddr
+    if (::connect(sockfd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr)) == -1) {
+        const auto connect_errno = errno;
+        close(sockfd);
+        errno = connect_errno;
+        return -1;
+    }
+
+    /* make non-blocking */
+    fcntl(sockfd, F_SETFL, fcntl(sockfd, F_GETFL) | O_NONBLOCK); // NOLINT: We have no good alternative to fcntl
+
+    return sockfd;
+}
+
 // NOLINTNEXTLINE(misc-no-recursion)
 bool MQTTAbstractionImpl::check_topic_matches(const std::string& full_topic, const std::string& wildcard_topic) {
     BOOST_LOG_FUNCTION();
@@ -514,12 +796,42 @@ bool MQTTAbstractionImpl::check_topic_matches(const std::string& full_topic, con
 void MQTTAbstractionImpl::publish_callback(void** state, struct mqtt_response_publish* published) {
     BOOST_LOG_FUNCTION();
 
-    auto message_queue = static_cast<MessageQueue*>(*state);
+    auto* self = static_cast<MQTTAbstractionImpl*>(*state);
+
+    // topic_name and application_message point into the receive buffer of MQTT-C which gets reused after this
+    // callback returns, so this is the only place the message is copied: into a pooled buffer. The callback runs with
+    // mqtt_buffers_mutex held, so only the Block overflow policy of the message queue can stall the connection here
+    self->messages_received++;
+    self->mqtt_buffers.count_received_message(published->topic_name_size + published->application_message_size);
+    self->message_queue.add(self->message_pool.acquire(
+        std::string_view(static_cast<const char*>(published->topic_name), published->topic_name_size),
+        std::string_view(static_cast<const char*>(published->application_message),
+                         published->application_message_size)));
+}
 
-    // topic_name and application_message are NOT null-terminated, hence copy construct strings
-    message_queue->add(std::make_shared<Message>(
-        std::string(static_cast<const char*>(published->topic_name), published->topic_name_size),
-        std::string(static_cast<const char*>(published->application_message), published->application_message_size)));
+MQTTStatistics MQTTAbstractionImpl::get_statistics() const {
+    MQTTStatistics statistics;
+    statistics.inbound.messages_received = this->messages_received;
+    statistics.inbound.allocations = this->message_pool.get_allocations();
+    statistics.inbound.buffer_reuses = this->message_pool.get_reuses();
+    statistics.inbound.documents_parsed = this->documents_parsed;
+    statistics.inbound.parse_errors = this->parse_errors;
+    statistics.inbound.messages_dropped = this->message_queue.get_dropped();
+    statistics.buffers = this->mqtt_buffers.get_statistics();
+    statistics.connection.connected = this->mqtt_is_connected;
+    statistics.connection.connection_losses = this->connection_losses;
+    statistics.connection.reconnects = this->reconnects;
+    statistics.connection.reconnect_attempts = this->reconnect_attempts;
+    statistics.connection.messages_buffered = this->messages_buffered;
+    statistics.connection.messages_dropped = this->offline_messages_dropped;
+    statistics.connection.last_outage_ms = this->last_outage_ms;
+    statistics.connection.longest_outage_ms = this->longest_outage_ms;
+    statistics.connection.total_outage_ms = this->total_outage_ms;
+    statistics.shared_memory = this->shared_memory.get_statistics();
+    statistics.event_loop = this->event_loop.get_statistics();
+    statistics.publish_queue = this->publish_queue.get_statistics();
+    statistics.subscriptions = this->subscription_batch.get_statistics();
+    return statistics;
 }
 
 } // namespace Everest
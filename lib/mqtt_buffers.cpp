@@ -0,0 +1,208 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <cstring>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/mqtt_buffers.hpp>
+
+namespace Everest {
+namespace {
+// room left in the send buffer for the acknowledgements, pings and subscriptions MQTT-C queues by itself
+constexpr size_t send_headroom = 1024;
+// buffers are only shrunk back if they were not grown for this long
+constexpr auto shrink_after = std::chrono::seconds(30);
+constexpr size_t buffer_alignment = 64;
+
+size_t align(size_t size) {
+    return (size + buffer_alignment - 1) / buffer_alignment * buffer_alignment;
+}
+
+void update_high_water_mark(std::atomic<uint64_t>& high_water_mark, uint64_t value) {
+    auto current = high_water_mark.load();
+    while (current < value && !high_water_mark.compare_exchange_weak(current, value)) {
+    }
+}
+
+/// \returns the number of bytes queued in the send buffer: the packed messages at its start and the bookkeeping
+/// entries at its end
+size_t send_buffer_used(const struct mqtt_message_queue& mq) {
+    return static_cast<size_t>(mq.curr - static_cast<uint8_t*>(mq.mem_start)) +
+           static_cast<size_t>(mqtt_mq_length(&mq)) * sizeof(struct mqtt_queued_message);
+}
+
+/// \returns the size of the MQTT packet at the start of the receive buffer or 0 if its fixed header was not received
+/// completely yet
+size_t pending_packet_size(const uint8_t* data, size_t size) {
+    size_t remaining_length = 0;
+    for (size_t i = 1; i < size && i <= 4; i++) {
+        remaining_length |= static_cast<size_t>(data[i] & 0x7f) << (7 * (i - 1));
+        if ((data[i] & 0x80) == 0) {
+            return 1 + i + remaining_length;
+        }
+    }
+    return 0;
+}
+} // namespace
+
+MQTTBuffers::MQTTBuffers(size_t initial_size, size_t max_size) :
+    initial_size(align(initial_size)),
+    max_size(std::max(align(max_size), align(initial_size))),
+    send_buffer(std::make_unique<uint8_t[]>(this->initial_size)),
+    receive_buffer(std::make_unique<uint8_t[]>(this->initial_size)),
+    send_buffer_size(this->initial_size),
+    receive_buffer_size(this->initial_size),
+    last_grown(std::chrono::steady_clock::now()) {
+}
+
+MQTTErrors MQTTBuffers::init(struct mqtt_client& client, int socket_fd,
+                             void (*publish_callback)(void** state, struct mqtt_response_publish* publish)) {
+    if (this->send_buffer_size != this->initial_size || this->receive_buffer_size != this->initial_size) {
+        this->send_buffer = std::make_unique<uint8_t[]>(this->initial_size);
+        this->receive_buffer = std::make_unique<uint8_t[]>(this->initial_size);
+        this->send_buffer_size = this->initial_size;
+        this->receive_buffer_size = this->initial_size;
+        this->shrinks++;
+    }
+    return mqtt_init(&client, socket_fd, this->send_buffer.get(), this->send_buffer_size,
+                     this->receive_buffer.get(), this->receive_buffer_size, publish_callback);
+}
+
+bool MQTTBuffers::reserve_send_space(struct mqtt_client& client, size_t size) {
+    mqtt_mq_clean(&client.mq);
+
+    // one more bookkeeping entry is needed for the new message
+    const auto required_size = send_buffer_used(client.mq) + size + sizeof(struct mqtt_queued_message) + send_headroom;
+    update_high_water_mark(this->send_buffer_high_water_mark, required_size - send_headroom);
+    if (required_size <= this->send_buffer_size) {
+        return true;
+    }
+    if (required_size > this->max_size) {
+        return false;
+    }
+
+    this->resize_send_buffer(client, this->grown_size(this->send_buffer_size, required_size));
+    return true;
+}
+
+bool MQTTBuffers::fits_send_buffer(size_t size) const {
+    return size + sizeof(struct mqtt_queued_message) + send_headroom <= this->max_size;
+}
+
+bool MQTTBuffers::recover(struct mqtt_client& client, MQTTErrors error) {
+    if (error == MQTT_ERROR_SEND_BUFFER_IS_FULL) {
+        if (this->send_buffer_size >= this->max_size) {
+            return false;
+        }
+        mqtt_mq_clean(&client.mq);
+        this->resize_send_buffer(client, this->grown_size(this->send_buffer_size, this->send_buffer_size + 1));
+    } else if (error == MQTT_ERROR_RECV_BUFFER_TOO_SMALL) {
+        const auto received = static_cast<size_t>(client.recv_buffer.curr - client.recv_buffer.mem_start);
+        const auto required_size = std::max(pending_packet_size(client.recv_buffer.mem_start, received),
+                                            static_cast<size_t>(this->receive_buffer_size) + 1);
+        if (required_size > this->max_size) {
+            EVLOG_error << fmt::format("Received MQTT message of {} bytes exceeds the maximum buffer size of {} bytes",
+                                       required_size, this->max_size);
+            return false;
+        }
+        this->resize_receive_buffer(client, this->grown_size(this->receive_buffer_size, required_size));
+    } else {
+        return false;
+    }
+
+    client.error = MQTT_OK;
+    return true;
+}
+
+void MQTTBuffers::shrink_if_idle(struct mqtt_client& client) {
+    if (this->send_buffer_size == this->initial_size && this->receive_buffer_size == this->initial_size) {
+        return;
+    }
+    if (std::chrono::steady_clock::now() - this->last_grown < shrink_after) {
+        return;
+    }
+
+    if (this->send_buffer_size > this->initial_size) {
+        mqtt_mq_clean(&client.mq);
+        if (send_buffer_used(client.mq) + send_headroom <= this->initial_size) {
+            this->resize_send_buffer(client, this->initial_size);
+            this->shrinks++;
+        }
+    }
+    // only shrink the receive buffer in between messages
+    if (this->receive_buffer_size > this->initial_size && client.recv_buffer.curr == client.recv_buffer.mem_start) {
+        this->resize_receive_buffer(client, this->initial_size);
+        this->shrinks++;
+    }
+}
+
+void MQTTBuffers::count_received_message(size_t size) {
+    update_high_water_mark(this->receive_buffer_high_water_mark, size);
+}
+
+BufferStatistics MQTTBuffers::get_statistics() const {
+    BufferStatistics statistics;
+    statistics.send_buffer_size = this->send_buffer_size;
+    statistics.send_buffer_high_water_mark = this->send_buffer_high_water_mark;
+    statistics.receive_buffer_size = this->receive_buffer_size;
+    statistics.receive_buffer_high_water_mark = this->receive_buffer_high_water_mark;
+    statistics.grows = this->grows;
+    statistics.shrinks = this->shrinks;
+    return statistics;
+}
+
+void MQTTBuffers::resize_send_buffer(struct mqtt_client& client, size_t size) {
+    // after mqtt_mq_clean the packed messages are contiguous at the start of the buffer and their bookkeeping entries
+    // are contiguous at its end, the entries point into the messages
+    auto& mq = client.mq;
+    auto* old_start = static_cast<uint8_t*>(mq.mem_start);
+    const auto messages_size = static_cast<size_t>(mq.curr - old_start);
+    const auto entries = static_cast<size_t>(mqtt_mq_length(&mq));
+
+    auto buffer = std::make_unique<uint8_t[]>(size);
+    auto* new_start = buffer.get();
+    auto* new_tail = reinterpret_cast<struct mqtt_queued_message*>(new_start + size) - entries;
+    std::memcpy(new_start, old_start, messages_size);
+    std::memcpy(static_cast<void*>(new_tail), mq.queue_tail, entries * sizeof(struct mqtt_queued_message));
+    for (size_t i = 0; i < entries; i++) {
+        new_tail[i].start = new_start + (new_tail[i].start - old_start);
+    }
+
+    mq.mem_start = new_start;
+    mq.mem_end = new_start + size;
+    mq.curr = new_start + messages_size;
+    mq.queue_tail = new_tail;
+    mq.curr_sz = mqtt_mq_currsz(&mq);
+
+    this->send_buffer = std::move(buffer);
+    this->send_buffer_size = size;
+}
+
+void MQTTBuffers::resize_receive_buffer(struct mqtt_client& client, size_t size) {
+    auto& recv_buffer = client.recv_buffer;
+    const auto received = static_cast<size_t>(recv_buffer.curr - recv_buffer.mem_start);
+
+    auto buffer = std::make_unique<uint8_t[]>(size);
+    std::memcpy(buffer.get(), recv_buffer.mem_start, received);
+
+    recv_buffer.mem_start = buffer.get();
+    recv_buffer.mem_size = size;
+    recv_buffer.curr = buffer.get() + received;
+    recv_buffer.curr_sz = size - received;
+
+    this->receive_buffer = std::move(buffer);
+    this->receive_buffer_size = size;
+}
+
+size_t MQTTBuffers::grown_size(size_t current_size, size_t required_size) {
+    const auto size = std::min(std::max(align(required_size), current_size * 2), this->max_size);
+    EVLOG_debug << fmt::format("Growing MQTT buffer from {} to {} bytes", current_size, size);
+    this->grows++;
+    this->last_grown = std::chrono::steady_clock::now();
+    return size;
+}
+
+} // namespace Everest
@@ -0,0 +1,157 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <cstring>
+
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/timerfd.h>
+#include <unistd.h>
+
+#include <fmt/format.h>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <utils/mqtt_event_loop.hpp>
+
+namespace Everest {
+namespace {
+// MQTT-C reads the time with time(), which may lag a few milliseconds behind the realtime clock of the timer
+constexpr long time_lag_ns = 10 * 1000 * 1000;
+
+bool timer_expired_for(time_t deadline) {
+    struct timespec now = {};
+    clock_gettime(CLOCK_REALTIME, &now);
+    return now.tv_sec >= deadline;
+}
+} // namespace
+
+MQTTEventLoop::MQTTEventLoop() :
+    epoll_fd(epoll_create1(EPOLL_CLOEXEC)), timer_fd(timerfd_create(CLOCK_REALTIME, TFD_NONBLOCK | TFD_CLOEXEC)) {
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = this->timer_fd;
+    if (this->epoll_fd == -1 || this->timer_fd == -1 ||
+        epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, this->timer_fd, &event) == -1) {
+        const auto error = fmt::format("Could not set up the MQTT event loop: {}", strerror(errno));
+        close(this->epoll_fd);
+        close(this->timer_fd);
+        EVLOG_AND_THROW(EverestInternalError(error));
+    }
+}
+
+MQTTEventLoop::~MQTTEventLoop() {
+    close(this->epoll_fd);
+    close(this->timer_fd);
+}
+
+void MQTTEventLoop::watch_notify_fd(int notify_fd) {
+    this->notify_fd = notify_fd;
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = notify_fd;
+    if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, notify_fd, &event) == -1 && errno != EEXIST) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not watch the MQTT eventfd: {}", strerror(errno))));
+    }
+}
+
+void MQTTEventLoop::watch_socket(int socket_fd) {
+    // closing the socket of the previous connection removed it from the epoll instance
+    this->socket_fd = socket_fd;
+    this->socket_writable_watched = false;
+    struct epoll_event event = {};
+    event.events = EPOLLIN;
+    event.data.fd = socket_fd;
+    if (epoll_ctl(this->epoll_fd, EPOLL_CTL_ADD, socket_fd, &event) == -1) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Could not watch the MQTT socket: {}", strerror(errno))));
+    }
+}
+
+void MQTTEventLoop::schedule(const struct mqtt_client& client, time_t max_sleep_s) {
+    const auto now = time(nullptr);
+
+    // MQTT-C sends a ping once more than keep_alive seconds passed since it last sent something, and it retransmits a
+    // message once more than response_timeout seconds passed without an acknowledgement
+    auto deadline = client.time_of_last_send + client.keep_alive + 1;
+    bool unsent = false;
+    const auto queued = mqtt_mq_length(&client.mq);
+    for (ssize_t i = 0; i < queued; i++) {
+        const auto* message = mqtt_mq_get(&client.mq, i);
+        if (message->state == MQTT_QUEUED_UNSENT) {
+            unsent = true;
+        } else if (message->state == MQTT_QUEUED_AWAITING_ACK) {
+            deadline = std::min(deadline, message->time_sent + client.response_timeout + 1);
+        }
+    }
+    // a deadline that passed already was handled by the last sync, so the earliest next one is a second later
+    this->client_deadline = std::max(deadline, now + 1);
+
+    struct itimerspec timer = {};
+    timer.it_value.tv_sec = std::min(this->client_deadline, now + max_sleep_s);
+    timer.it_value.tv_nsec = time_lag_ns;
+    timerfd_settime(this->timer_fd, TFD_TIMER_ABSTIME, &timer, nullptr);
+
+    // data MQTT-C could not send because the socket was full is sent as soon as the socket is writable again
+    if (unsent != this->socket_writable_watched && this->socket_fd != -1) {
+        struct epoll_event event = {};
+        event.events = unsent ? (EPOLLIN | EPOLLOUT) : EPOLLIN;
+        event.data.fd = this->socket_fd;
+        epoll_ctl(this->epoll_fd, EPOLL_CTL_MOD, this->socket_fd, &event);
+        this->socket_writable_watched = unsent;
+    }
+}
+
+bool MQTTEventLoop::wait() {
+    std::array<struct epoll_event, 3> events{};
+    const int count = epoll_wait(this->epoll_fd, events.data(), static_cast<int>(events.size()), -1);
+    if (count == -1) {
+        if (errno == EINTR) {
+            return false;
+        }
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Waiting for MQTT events failed: {}", strerror(errno))));
+    }
+    this->wakeups++;
+
+    bool work = false;
+    for (int i = 0; i < count; i++) {
+        const auto fd = events.at(i).data.fd;
+        if (fd == this->timer_fd) {
+            uint64_t expirations = 0;
+            if (read(this->timer_fd, &expirations, sizeof(expirations)) == -1) {
+                // the timer was rearmed in the meantime
+                continue;
+            }
+            if (timer_expired_for(this->client_deadline)) {
+                this->timer_wakeups++;
+                work = true;
+            }
+        } else if (fd == this->notify_fd) {
+            eventfd_t value = 0;
+            eventfd_read(this->notify_fd, &value);
+            this->notify_wakeups++;
+            work = true;
+        } else {
+            this->socket_wakeups++;
+            work = true;
+        }
+    }
+    if (!work) {
+        this->housekeeping_wakeups++;
+    }
+    return work;
+}
+
+EventLoopStatistics MQTTEventLoop::get_statistics() const {
+    EventLoopStatistics statistics;
+    statistics.wakeups = this->wakeups;
+    statistics.socket_wakeups = this->socket_wakeups;
+    statistics.notify_wakeups = this->notify_wakeups;
+    statistics.timer_wakeups = this->timer_wakeups;
+    statistics.housekeeping_wakeups = this->housekeeping_wakeups;
+    return statistics;
+}
+
+} // namespace Everest
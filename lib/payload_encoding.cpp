@@ -0,0 +1,62 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <utils/payload_encoding.hpp>
+
+namespace Everest {
+
+std::string encode_payload(const json& data, PayloadEncoding encoding) {
+    std::string payload;
+    switch (encoding) {
+    case PayloadEncoding::Cbor:
+        json::to_cbor(data, payload);
+        break;
+    case PayloadEncoding::MessagePack:
+        json::to_msgpack(data, payload);
+        break;
+    case PayloadEncoding::Json:
+    default:
+        payload = data.dump();
+        break;
+    }
+    return payload;
+}
+
+const std::string& PayloadEncoder::encode(const json& data, PayloadEncoding encoding) {
+    switch (encoding) {
+    case PayloadEncoding::Cbor:
+        // to_cbor() and to_msgpack() append to the string, keeping its capacity from the previous payloads
+        this->payload.clear();
+        json::to_cbor(data, this->payload);
+        break;
+    case PayloadEncoding::MessagePack:
+        this->payload.clear();
+        json::to_msgpack(data, this->payload);
+        break;
+    case PayloadEncoding::Json:
+    default:
+        this->payload = data.dump();
+        break;
+    }
+    return this->payload;
+}
+
+void PayloadEncoder::shrink_to(std::size_t max_size) {
+    if (this->payload.capacity() > max_size) {
+        this->payload.clear();
+        this->payload.shrink_to_fit();
+    }
+}
+
+json decode_payload(const char* begin, const char* end, PayloadEncoding encoding) {
+    switch (encoding) {
+    case PayloadEncoding::Cbor:
+        return json::from_cbor(begin, end);
+    case PayloadEncoding::MessagePack:
+        return json::from_msgpack(begin, end);
+    case PayloadEncoding::Json:
+    default:
+        return json::parse(begin, end);
+    }
+}
+
+} // namespace Everest
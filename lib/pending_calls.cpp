@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/pending_calls.hpp>
+
+namespace Everest {
+
+PendingCalls::PendingCalls() {
+    this->thread = std::thread(&PendingCalls::run, this);
+}
+
+PendingCalls::~PendingCalls() {
+    {
+        const std::lock_guard<std::mutex> lock(this->calls_mutex);
+        this->running = false;
+    }
+    this->calls_cv.notify_one();
+    this->thread.join();
+}
+
+std::future<json> PendingCalls::add(const std::string& call_id, const std::string& description,
+                                    std::chrono::milliseconds timeout) {
+    Call call;
+    call.promise.emplace();
+    auto result = call.promise->get_future();
+    call.description = description;
+    this->insert(call_id, std::move(call), timeout);
+    return result;
+}
+
+void PendingCalls::add(const std::string& call_id, const std::string& description, std::chrono::milliseconds timeout,
+                       CmdResultCallback callback) {
+    Call call;
+    call.callback = std::move(callback);
+    call.description = description;
+    this->insert(call_id, std::move(call), timeout);
+}
+
+bool PendingCalls::complete(const std::string& call_id, json result) {
+    const std::lock_guard<std::mutex> lock(this->calls_mutex);
+    const auto call_it = this->calls.find(call_id);
+    if (call_it == this->calls.end()) {
+        return false;
+    }
+
+    this->finish(call_it->second, std::move(result), nullptr);
+    this->calls.erase(call_it);
+    return true;
+}
+
+bool PendingCalls::fail(const std::string& call_id, std::exception_ptr error) {
+    const std::lock_guard<std::mutex> lock(this->calls_mutex);
+    const auto call_it = this->calls.find(call_id);
+    if (call_it == this->calls.end()) {
+        return false;
+    }
+
+    this->finish(call_it->second, nullptr, std::move(error));
+    this->calls.erase(call_it);
+    return true;
+}
+
+size_t PendingCalls::size() const {
+    const std::lock_guard<std::mutex> lock(this->calls_mutex);
+    return this->calls.size();
+}
+
+void PendingCalls::insert(const std::string& call_id, Call call, std::chrono::milliseconds timeout) {
+    const std::lock_guard<std::mutex> lock(this->calls_mutex);
+    if (this->calls.find(call_id) != this->calls.end()) {
+        EVLOG_AND_THROW(EverestInternalError(fmt::format("Call id '{}' is already pending", call_id)));
+    }
+    call.deadline = this->deadlines.emplace(std::chrono::steady_clock::now() + timeout, call_id);
+    if (call.deadline == this->deadlines.begin()) {
+        // the thread has to wake up earlier than planned
+        this->calls_cv.notify_one();
+    }
+    this->calls.emplace(call_id, std::move(call));
+}
+
+void PendingCalls::finish(Call& call, json result, std::exception_ptr error) {
+    this->deadlines.erase(call.deadline);
+
+    if (call.promise.has_value()) {
+        if (error) {
+            call.promise->set_exception(error);
+        } else {
+            call.promise->set_value(std::move(result));
+        }
+        return;
+    }
+
+    this->callbacks.emplace_back([callback = std::move(call.callback), result = std::move(result), error]() mutable {
+        callback(std::move(result), error);
+    });
+    this->calls_cv.notify_one();
+}
+
+void PendingCalls::run() {
+    std::unique_lock<std::mutex> lock(this->calls_mutex);
+    while (this->running) {
+        if (!this->callbacks.empty()) {
+            auto callback = std::move(this->callbacks.front());
+            this->callbacks.pop_front();
+            lock.unlock();
+            try {
+                callback();
+            } catch (const std::exception& e) {
+                EVLOG_error << fmt::format("Result callback of a cmd call threw an exception: {}", e.what());
+            }
+            lock.lock();
+            continue;
+        }
+
+        if (this->deadlines.empty()) {
+            this->calls_cv.wait(lock);
+            continue;
+        }
+
+        const auto next_deadline = this->deadlines.begin();
+        if (next_deadline->first > std::chrono::steady_clock::now()) {
+            this->calls_cv.wait_until(lock, next_deadline->first);
+            continue;
+        }
+
+        const auto call_it = this->calls.find(next_deadline->second);
+        const auto message = fmt::format("Timeout while waiting for result of {}", call_it->second.description);
+        EVLOG_error << message;
+        this->finish(call_it->second, nullptr, std::make_exception_ptr(EverestTimeoutError(message)));
+        this->calls.erase(call_it);
+    }
+}
+
+} // namespace Everest
@@ -0,0 +1,153 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <utility>
+
+#include <everest/logging.hpp>
+
+#include <utils/publish_queue.hpp>
+
+namespace Everest {
+namespace {
+// slots holding a larger payload give it back once it was sent instead of pinning the memory
+constexpr size_t max_pooled_payload_capacity = 64 * 1024;
+} // namespace
+
+PublishQueue::PublishQueue(size_t capacity, PublishQueueOverflowPolicy overflow_policy,
+                           std::chrono::milliseconds block_timeout) :
+    slots(std::max<size_t>(capacity, 1)), overflow_policy(overflow_policy), block_timeout(block_timeout) {
+}
+
+QueuedPublish& PublishQueue::slot(size_t index) {
+    return this->slots.at((this->head + index) % this->slots.size());
+}
+
+bool PublishQueue::push(std::string_view topic, std::string_view payload, QOS qos) {
+    return this->enqueue(topic, payload, qos, true);
+}
+
+bool PublishQueue::try_push(std::string_view topic, std::string_view payload, QOS qos) {
+    return this->enqueue(topic, payload, qos, false);
+}
+
+bool PublishQueue::enqueue(std::string_view topic, std::string_view payload, QOS qos, bool may_wait) {
+    std::unique_lock<std::mutex> lock(this->mutex);
+    if (this->count == this->slots.size() && !this->stopped) {
+        this->queue_full++;
+        bool wait = false;
+        switch (this->overflow_policy) {
+        case PublishQueueOverflowPolicy::FailFast:
+            break;
+        case PublishQueueOverflowPolicy::DropOldestQoS0:
+            if (this->drop_oldest_qos0()) {
+                break;
+            }
+            // only messages that may be lost anyway are dropped, others wait for room like with Block
+            wait = (qos != QOS::QOS0);
+            break;
+        case PublishQueueOverflowPolicy::Block:
+        default:
+            wait = true;
+            break;
+        }
+        if (wait && may_wait) {
+            this->space_cv.wait_for(lock, this->block_timeout,
+                                    [this]() { return this->count < this->slots.size() || this->stopped; });
+        }
+    }
+
+    if (this->count == this->slots.size() || this->stopped) {
+        this->count_dropped_message();
+        return false;
+    }
+
+    auto& message = this->slot(this->count);
+    message.topic.assign(topic.data(), topic.size());
+    message.payload.assign(payload.data(), payload.size());
+    message.qos = qos;
+    this->count++;
+    this->messages_queued++;
+    this->high_water_mark = std::max<uint64_t>(this->high_water_mark, this->count);
+    return true;
+}
+
+bool PublishQueue::drop_oldest_qos0() {
+    for (size_t i = this->front_in_use ? 1 : 0; i < this->count; i++) {
+        if (this->slot(i).qos != QOS::QOS0) {
+            continue;
+        }
+        // the younger messages move up one slot, so the free slot is the one at the end
+        for (size_t j = i; j + 1 < this->count; j++) {
+            std::swap(this->slot(j), this->slot(j + 1));
+        }
+        this->count--;
+        this->count_dropped_message();
+        return true;
+    }
+    return false;
+}
+
+void PublishQueue::count_dropped_message() {
+    if (this->messages_dropped++ == 0) {
+        EVLOG_warning << "MQTT publish queue is full, dropping published messages. Further drops are only counted";
+    }
+}
+
+size_t PublishQueue::drain(const std::function<bool(const QueuedPublish& message)>& send) {
+    size_t sent = 0;
+    while (true) {
+        QueuedPublish* message = nullptr;
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            if (this->count == 0) {
+                break;
+            }
+            // publishers never touch the front slot while it is in use, so it can be sent without holding the lock
+            message = &this->slot(0);
+            this->front_in_use = true;
+        }
+
+        const auto accepted = send(*message);
+
+        {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            this->front_in_use = false;
+            if (!accepted) {
+                this->send_buffer_full++;
+                break;
+            }
+            if (message->payload.capacity() > max_pooled_payload_capacity) {
+                std::string().swap(message->payload);
+            }
+            this->head = (this->head + 1) % this->slots.size();
+            this->count--;
+            this->messages_sent++;
+        }
+        this->space_cv.notify_one();
+        sent++;
+    }
+    return sent;
+}
+
+void PublishQueue::stop() {
+    {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        this->stopped = true;
+    }
+    this->space_cv.notify_all();
+}
+
+PublishQueueStatistics PublishQueue::get_statistics() const {
+    const std::lock_guard<std::mutex> lock(this->mutex);
+    PublishQueueStatistics statistics;
+    statistics.queue_depth = this->count;
+    statistics.queue_high_water_mark = this->high_water_mark;
+    statistics.messages_queued = this->messages_queued;
+    statistics.messages_sent = this->messages_sent;
+    statistics.queue_full = this->queue_full;
+    statistics.messages_dropped = this->messages_dropped;
+    statistics.send_buffer_full = this->send_buffer_full;
+    return statistics;
+}
+
+} // namespace Everest
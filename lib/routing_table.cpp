@@ -0,0 +1,201 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+
+#include <everest/exceptions.hpp>
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/routing_table.hpp>
+
+namespace Everest {
+namespace {
+// keys of the validators in the SchemaValidatorCache
+std::string cmd_argument_validator_key(const std::string& module_id, const std::string& impl_id,
+                                       const std::string& cmd_name, const std::string& arg_name) {
+    return fmt::format("{}/{}/cmd/{}/arguments/{}", module_id, impl_id, cmd_name, arg_name);
+}
+
+std::string cmd_result_validator_key(const std::string& module_id, const std::string& impl_id,
+                                     const std::string& cmd_name) {
+    return fmt::format("{}/{}/cmd/{}/result", module_id, impl_id, cmd_name);
+}
+
+std::string var_validator_key(const std::string& module_id, const std::string& impl_id, const std::string& var_name) {
+    return fmt::format("{}/{}/var/{}", module_id, impl_id, var_name);
+}
+
+QOS to_qos(int level) {
+    switch (level) {
+    case 0:
+        return QOS::QOS0;
+    case 1:
+        return QOS::QOS1;
+    default:
+        return QOS::QOS2;
+    }
+}
+
+/// \returns the QoS of the var or cmd with the given \p definition, \p kind is either "vars" or "cmds". The mqtt_qos
+/// config of the module overrides the qos declared in the interface
+QOS get_qos(const json& main_config, const std::string& module_id, const std::string& impl_id, const std::string& kind,
+            const std::string& name, const json& definition) {
+    const auto override_ptr = json::json_pointer(fmt::format("/{}/mqtt_qos/{}/{}/{}", module_id, impl_id, kind, name));
+    if (main_config.contains(override_ptr)) {
+        return to_qos(main_config.at(override_ptr).get<int>());
+    }
+    return to_qos(definition.is_object() ? definition.value("qos", 2) : 2);
+}
+
+/// \returns true if the var \p name is listed in the var_coalescing config of the module
+bool is_coalesced(const json& main_config, const std::string& module_id, const std::string& impl_id,
+                  const std::string& name) {
+    const auto coalesced_ptr = json::json_pointer(fmt::format("/{}/var_coalescing/{}", module_id, impl_id));
+    if (!main_config.contains(coalesced_ptr)) {
+        return false;
+    }
+    const auto& coalesced = main_config.at(coalesced_ptr);
+    return std::find(coalesced.begin(), coalesced.end(), name) != coalesced.end();
+}
+
+const json empty_object = json::object();
+
+std::shared_ptr<const SchemaValidator> get_validator(SchemaValidatorCache& validators, const std::string& key,
+                                                     const json& schema, const std::string& identifier,
+                                                     const std::string& name) {
+    try {
+        return validators.get(key, schema);
+    } catch (const std::exception& e) {
+        EVLOG_AND_THROW(
+            EverestConfigError(fmt::format("Schema of {}->{} could not be compiled: {}", identifier, name, e.what())));
+    }
+}
+} // namespace
+
+RoutingTable::RoutingTable(Config& config, const std::string& module_id, SchemaValidatorCache& validators) {
+    BOOST_LOG_FUNCTION();
+
+    const auto& interfaces = config.get_interfaces();
+    const auto& main_config = config.get_main_config();
+    const auto& module_config = main_config.at(module_id);
+
+    const auto module_interfaces_it = interfaces.find(config.get_module_name(module_id));
+    const auto& module_interfaces = (module_interfaces_it != interfaces.end()) ? *module_interfaces_it : empty_object;
+    for (const auto& impl : module_interfaces.items()) {
+        this->provided[impl.key()] =
+            &this->add_implementation(config, interfaces, main_config, validators, module_id, impl.key());
+    }
+
+    const auto connections_it = module_config.find("connections");
+    if (connections_it == module_config.end()) {
+        return;
+    }
+    for (const auto& requirement : connections_it->items()) {
+        auto& requirement_route = this->requirements[requirement.key()];
+        const auto resolved = config.resolve_requirement(module_id, requirement.key());
+        requirement_route.single = !resolved.is_array();
+        const auto connections = requirement_route.single ? json::array({resolved}) : resolved;
+        for (const auto& connection : connections) {
+            ConnectionRoute route;
+            route.implementation =
+                &this->add_implementation(config, interfaces, main_config, validators, connection.at("module_id"),
+                                          connection.at("implementation_id"));
+            const auto cmd_timeout_it = connection.find("cmd_timeout_ms");
+            if (cmd_timeout_it != connection.end()) {
+                route.cmd_timeout = std::chrono::milliseconds(cmd_timeout_it->get<int64_t>());
+            }
+            requirement_route.connections.push_back(route);
+        }
+    }
+}
+
+const ImplementationRoute& RoutingTable::add_implementation(Config& config, const json& interfaces,
+                                                            const json& main_config, SchemaValidatorCache& validators,
+                                                            const std::string& module_id, const std::string& impl_id) {
+    const auto [it, inserted] = this->implementations.try_emplace({module_id, impl_id});
+    auto& route = it->second;
+    if (!inserted) {
+        return route;
+    }
+
+    route.module_id = module_id;
+    route.impl_id = impl_id;
+    route.identifier = config.printable_identifier(module_id, impl_id);
+    route.cmd_topic = fmt::format("{}/cmd", config.mqtt_prefix(module_id, impl_id));
+    route.var_topic = fmt::format("{}/var", config.mqtt_prefix(module_id, impl_id));
+    // the definitions of the routes point into the interface of the route, which is not changed afterwards
+    const auto module_interfaces_it = interfaces.find(config.get_module_name(module_id));
+    if (module_interfaces_it != interfaces.end()) {
+        route.interface = module_interfaces_it->value(impl_id, json::object());
+    }
+
+    const auto& cmds = route.interface.contains("cmds") ? route.interface.at("cmds") : empty_object;
+    for (const auto& cmd : cmds.items()) {
+        const auto& definition = cmd.value();
+        auto& cmd_route = route.cmds[cmd.key()];
+        cmd_route.definition = &definition;
+        cmd_route.qos = get_qos(main_config, module_id, impl_id, "cmds", cmd.key(), definition);
+        cmd_route.description = fmt::format("{}->{}()", route.identifier, cmd.key());
+        route.result_qos = std::max(route.result_qos, cmd_route.qos);
+
+        const auto arguments_it = definition.find("arguments");
+        if (arguments_it != definition.end()) {
+            cmd_route.argument_names = Config::keys(*arguments_it);
+        }
+        if (!validators.is_enabled()) {
+            continue;
+        }
+        for (const auto& arg_name : cmd_route.argument_names) {
+            cmd_route.argument_validators[arg_name] =
+                get_validator(validators, cmd_argument_validator_key(module_id, impl_id, cmd.key(), arg_name),
+                              arguments_it->at(arg_name), route.identifier, cmd.key());
+        }
+        const auto result_it = definition.find("result");
+        if (result_it != definition.end() && !result_it->is_null()) {
+            cmd_route.result_validator =
+                get_validator(validators, cmd_result_validator_key(module_id, impl_id, cmd.key()), *result_it,
+                              route.identifier, cmd.key());
+        }
+    }
+
+    const auto& vars = route.interface.contains("vars") ? route.interface.at("vars") : empty_object;
+    for (const auto& var : vars.items()) {
+        const auto& definition = var.value();
+        auto& var_route = route.vars[var.key()];
+        var_route.definition = &definition;
+        var_route.qos = get_qos(main_config, module_id, impl_id, "vars", var.key(), definition);
+        var_route.coalesce = is_coalesced(main_config, module_id, impl_id, var.key());
+        if (validators.is_enabled()) {
+            var_route.validator = get_validator(validators, var_validator_key(module_id, impl_id, var.key()),
+                                                definition, route.identifier, var.key());
+        }
+    }
+
+    return route;
+}
+
+const ConnectionRoute* RoutingTable::find_connection(const Requirement& req) const {
+    const auto it = this->requirements.find(req.id);
+    if (it == this->requirements.end() || it->second.connections.empty()) {
+        return nullptr;
+    }
+    const auto& requirement_route = it->second;
+    if (requirement_route.single) {
+        return &requirement_route.connections.front();
+    }
+    if (req.index >= requirement_route.connections.size()) {
+        return nullptr;
+    }
+    return &requirement_route.connections.at(req.index);
+}
+
+const ImplementationRoute* RoutingTable::find_implementation(const std::string& impl_id) const {
+    const auto it = this->provided.find(impl_id);
+    if (it == this->provided.end()) {
+        return nullptr;
+    }
+    return it->second;
+}
+
+} // namespace Everest
@@ -2,6 +2,7 @@
 // Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
 
 #include <framework/runtime.hpp>
+#include <utils/config_blob.hpp>
 #include <utils/error.hpp>
 #include <utils/error/error_json.hpp>
 #include <utils/error/error_manager.hpp>
@@ -78,6 +79,38 @@ void populate_module_info_path_from_runtime_settings(ModuleInfo& mi, std::shared
     mi.paths.share = rs->data_dir / defaults::MODULES_DIR / mi.name;
 }
 
+std::string get_mqtt_broker_address(const RuntimeSettings& rs) {
+    if (!rs.mqtt_broker_socket_path.empty()) {
+        return rs.mqtt_broker_socket_path;
+    }
+    return fmt::format("{}:{}", rs.mqtt_broker_host, rs.mqtt_broker_port);
+}
+
+MQTTSettings get_mqtt_settings(const RuntimeSettings& rs) {
+    MQTTSettings mqtt_settings;
+    mqtt_settings.broker_host = rs.mqtt_broker_host;
+    mqtt_settings.broker_port = rs.mqtt_broker_port;
+    mqtt_settings.broker_socket_path = rs.mqtt_broker_socket_path;
+    mqtt_settings.everest_prefix = rs.mqtt_everest_prefix;
+    mqtt_settings.external_prefix = rs.mqtt_external_prefix;
+    mqtt_settings.handler_threads = rs.message_handler_threads;
+    mqtt_settings.message_queue_size = rs.message_queue_size;
+    mqtt_settings.message_queue_overflow_policy = rs.message_queue_overflow_policy;
+    mqtt_settings.buffer_initial_size = rs.mqtt_buffer_initial_size;
+    mqtt_settings.buffer_max_size = rs.mqtt_buffer_max_size;
+    mqtt_settings.reconnect_initial_backoff = std::chrono::milliseconds(rs.mqtt_reconnect_initial_backoff_ms);
+    mqtt_settings.reconnect_max_backoff = std::chrono::milliseconds(rs.mqtt_reconnect_max_backoff_ms);
+    mqtt_settings.offline_queue_size = rs.mqtt_offline_queue_size;
+    mqtt_settings.shared_memory_threshold = rs.mqtt_shared_memory_threshold;
+    mqtt_settings.shared_memory_max_size = rs.mqtt_shared_memory_max_size;
+    mqtt_settings.shared_memory_lease = std::chrono::milliseconds(rs.mqtt_shared_memory_lease_ms);
+    mqtt_settings.everest_encoding = rs.mqtt_everest_encoding;
+    mqtt_settings.publish_queue_size = rs.mqtt_publish_queue_size;
+    mqtt_settings.publish_queue_overflow_policy = rs.mqtt_publish_queue_overflow_policy;
+    mqtt_settings.publish_queue_timeout = std::chrono::milliseconds(rs.mqtt_publish_queue_timeout_ms);
+    return mqtt_settings;
+}
+
 RuntimeSettings::RuntimeSettings(const std::string& prefix_, const std::string& config_) {
     // if prefix or config is empty, we assume they have not been set!
     // if they have been set, check their validity, otherwise bail out!
@@ -235,6 +268,20 @@ RuntimeSettings::RuntimeSettings(const std::string& prefix_, const std::string&
         www_dir = assert_dir(default_www_dir, "Default www directory");
     }
 
+    const auto settings_cache_dir_it = settings.find("cache_dir");
+    if (settings_cache_dir_it != settings.end()) {
+        cache_dir = get_prefixed_path_from_json(*settings_cache_dir_it, prefix);
+    } else {
+        // the cache directory is created on demand, so it does not have to exist
+        const auto default_cache_dir = fs::path(defaults::LOCALSTATE_DIR) / defaults::CACHE_DIR / defaults::NAMESPACE;
+        if (prefix.string() != "/usr") {
+            cache_dir = prefix / default_cache_dir;
+        } else {
+            cache_dir = fs::path("/") / default_cache_dir;
+        }
+    }
+    config_cache = settings.value("config_cache", defaults::CONFIG_CACHE);
+
     const auto settings_logging_config_file_it = settings.find("logging_config_file");
     if (settings_logging_config_file_it != settings.end()) {
         const auto settings_logging_config_file = get_prefixed_path_from_json(*settings_logging_config_file_it, prefix);
@@ -293,6 +340,34 @@ RuntimeSettings::RuntimeSettings(const std::string& prefix_, const std::string&
         mqtt_broker_port = std::stoi(mqtt_server_port);
     }
 
+    const auto settings_mqtt_broker_socket_path_it = settings.find("mqtt_broker_socket_path");
+    if (settings_mqtt_broker_socket_path_it != settings.end()) {
+        mqtt_broker_socket_path = settings_mqtt_broker_socket_path_it->get<std::string>();
+    } else {
+        mqtt_broker_socket_path = defaults::MQTT_BROKER_SOCKET_PATH;
+    }
+
+    // overwrite mqtt broker socket path with environment variable
+    // NOLINTNEXTLINE(concurrency-mt-unsafe): not problematic that this function is not threadsafe here
+    const char* mqtt_server_socket_path = std::getenv("MQTT_SERVER_SOCKET_PATH");
+    if (mqtt_server_socket_path != nullptr) {
+        mqtt_broker_socket_path = mqtt_server_socket_path;
+    }
+
+    mqtt_embedded_broker = settings.value("mqtt_embedded_broker", defaults::MQTT_EMBEDDED_BROKER);
+    mqtt_embedded_broker_bridge = settings.value("mqtt_embedded_broker_bridge", defaults::MQTT_EMBEDDED_BROKER_BRIDGE);
+    // the manager and the modules derive the socket of the embedded broker from the same settings, its directory is
+    // created by the broker and only accessible by the user and group it runs as
+    if (mqtt_embedded_broker && mqtt_broker_socket_path.empty()) {
+        const auto default_socket_path = fs::path(defaults::LOCALSTATE_DIR) / defaults::RUN_DIR / defaults::NAMESPACE /
+                                         defaults::MQTT_EMBEDDED_BROKER_SOCKET_NAME;
+        if (prefix.string() != "/usr") {
+            mqtt_broker_socket_path = (prefix / default_socket_path).string();
+        } else {
+            mqtt_broker_socket_path = (fs::path("/") / default_socket_path).string();
+        }
+    }
+
     const auto settings_mqtt_everest_prefix_it = settings.find("mqtt_everest_prefix");
     if (settings_mqtt_everest_prefix_it != settings.end()) {
         mqtt_everest_prefix = settings_mqtt_everest_prefix_it->get<std::string>();
@@ -342,6 +417,102 @@ RuntimeSettings::RuntimeSettings(const std::string& prefix_, const std::string&
     } else {
         validate_schema = defaults::VALIDATE_SCHEMA;
     }
+
+    const auto schema_validation_mode_name =
+        settings.value("schema_validation_mode", validate_schema ? "full" : "off");
+    if (schema_validation_mode_name == "off") {
+        schema_validation.mode = SchemaValidationMode::Off;
+    } else if (schema_validation_mode_name == "full") {
+        schema_validation.mode = SchemaValidationMode::Full;
+    } else if (schema_validation_mode_name == "sampled") {
+        schema_validation.mode = SchemaValidationMode::Sampled;
+    } else if (schema_validation_mode_name == "type_only") {
+        schema_validation.mode = SchemaValidationMode::TypeOnly;
+    } else {
+        throw BootException(fmt::format("Unknown schema_validation_mode '{}'", schema_validation_mode_name));
+    }
+    schema_validation.sample_first =
+        settings.value("schema_validation_sample_first", defaults::SCHEMA_VALIDATION_SAMPLE_FIRST);
+    schema_validation.sample_every =
+        settings.value("schema_validation_sample_every", defaults::SCHEMA_VALIDATION_SAMPLE_EVERY);
+
+    const auto settings_message_handler_threads_it = settings.find("message_handler_threads");
+    if (settings_message_handler_threads_it != settings.end()) {
+        message_handler_threads = settings_message_handler_threads_it->get<int>();
+    } else {
+        message_handler_threads = defaults::MESSAGE_HANDLER_THREADS;
+    }
+
+    const auto settings_message_queue_size_it = settings.find("message_queue_size");
+    if (settings_message_queue_size_it != settings.end()) {
+        message_queue_size = settings_message_queue_size_it->get<int>();
+    } else {
+        message_queue_size = defaults::MESSAGE_QUEUE_SIZE;
+    }
+
+    const auto message_queue_overflow_policy_name =
+        settings.value("message_queue_overflow_policy", defaults::MESSAGE_QUEUE_OVERFLOW_POLICY);
+    if (message_queue_overflow_policy_name == "block") {
+        EVLOG_warning << "message_queue_overflow_policy block stalls the MQTT connection while the queue is full";
+        message_queue_overflow_policy = MessageQueueOverflowPolicy::Block;
+    } else if (message_queue_overflow_policy_name == "drop_oldest") {
+        message_queue_overflow_policy = MessageQueueOverflowPolicy::DropOldest;
+    } else if (message_queue_overflow_policy_name == "drop_newest") {
+        message_queue_overflow_policy = MessageQueueOverflowPolicy::DropNewest;
+    } else {
+        throw BootException(
+            fmt::format("Unknown message_queue_overflow_policy '{}'", message_queue_overflow_policy_name));
+    }
+
+    mqtt_buffer_initial_size = settings.value("mqtt_buffer_initial_size", defaults::MQTT_BUFFER_INITIAL_SIZE);
+    mqtt_buffer_max_size = settings.value("mqtt_buffer_max_size", defaults::MQTT_BUFFER_MAX_SIZE);
+    if (mqtt_buffer_max_size < mqtt_buffer_initial_size) {
+        throw BootException(
+            fmt::format("mqtt_buffer_max_size ({}) must not be smaller than mqtt_buffer_initial_size ({})",
+                        mqtt_buffer_max_size, mqtt_buffer_initial_size));
+    }
+
+    mqtt_reconnect_initial_backoff_ms =
+        settings.value("mqtt_reconnect_initial_backoff_ms", defaults::MQTT_RECONNECT_INITIAL_BACKOFF_MS);
+    mqtt_reconnect_max_backoff_ms =
+        settings.value("mqtt_reconnect_max_backoff_ms", defaults::MQTT_RECONNECT_MAX_BACKOFF_MS);
+    if (mqtt_reconnect_max_backoff_ms < mqtt_reconnect_initial_backoff_ms) {
+        throw BootException(fmt::format(
+            "mqtt_reconnect_max_backoff_ms ({}) must not be smaller than mqtt_reconnect_initial_backoff_ms ({})",
+            mqtt_reconnect_max_backoff_ms, mqtt_reconnect_initial_backoff_ms));
+    }
+    mqtt_offline_queue_size = settings.value("mqtt_offline_queue_size", defaults::MQTT_OFFLINE_QUEUE_SIZE);
+    mqtt_shared_memory_threshold =
+        settings.value("mqtt_shared_memory_threshold", defaults::MQTT_SHARED_MEMORY_THRESHOLD);
+    mqtt_shared_memory_max_size = settings.value("mqtt_shared_memory_max_size", defaults::MQTT_SHARED_MEMORY_MAX_SIZE);
+    mqtt_shared_memory_lease_ms = settings.value("mqtt_shared_memory_lease_ms", defaults::MQTT_SHARED_MEMORY_LEASE_MS);
+
+    const auto mqtt_everest_encoding_name = settings.value("mqtt_everest_encoding", defaults::MQTT_EVEREST_ENCODING);
+    if (mqtt_everest_encoding_name == "json") {
+        mqtt_everest_encoding = PayloadEncoding::Json;
+    } else if (mqtt_everest_encoding_name == "cbor") {
+        mqtt_everest_encoding = PayloadEncoding::Cbor;
+    } else if (mqtt_everest_encoding_name == "msgpack") {
+        mqtt_everest_encoding = PayloadEncoding::MessagePack;
+    } else {
+        throw BootException(fmt::format("Unknown mqtt_everest_encoding '{}'", mqtt_everest_encoding_name));
+    }
+
+    mqtt_publish_queue_size = settings.value("mqtt_publish_queue_size", defaults::MQTT_PUBLISH_QUEUE_SIZE);
+    const auto mqtt_publish_queue_overflow_policy_name =
+        settings.value("mqtt_publish_queue_overflow_policy", defaults::MQTT_PUBLISH_QUEUE_OVERFLOW_POLICY);
+    if (mqtt_publish_queue_overflow_policy_name == "block") {
+        mqtt_publish_queue_overflow_policy = PublishQueueOverflowPolicy::Block;
+    } else if (mqtt_publish_queue_overflow_policy_name == "fail_fast") {
+        mqtt_publish_queue_overflow_policy = PublishQueueOverflowPolicy::FailFast;
+    } else if (mqtt_publish_queue_overflow_policy_name == "drop_oldest_qos0") {
+        mqtt_publish_queue_overflow_policy = PublishQueueOverflowPolicy::DropOldestQoS0;
+    } else {
+        throw BootException(
+            fmt::format("Unknown mqtt_publish_queue_overflow_policy '{}'", mqtt_publish_queue_overflow_policy_name));
+    }
+    mqtt_publish_queue_timeout_ms =
+        settings.value("mqtt_publish_queue_timeout_ms", defaults::MQTT_PUBLISH_QUEUE_TIMEOUT_MS);
     run_as_user = settings.value("run_as_user", "");
 }
 
@@ -368,7 +539,7 @@ int ModuleLoader::initialize() {
     auto& rs = this->runtime_settings;
     Logging::init(rs->logging_config_file.string(), this->module_id);
     try {
-        Config config = Config(rs);
+        Config config = load_module_config(rs);
 
         if (!config.contains(this->module_id)) {
             EVLOG_error << fmt::format("Module id '{}' not found in config!", this->module_id);
@@ -385,16 +556,14 @@ int ModuleLoader::initialize() {
         }
         Logging::update_process_name(module_identifier);
 
-        auto everest =
-            Everest(this->module_id, config, rs->validate_schema, rs->mqtt_broker_host, rs->mqtt_broker_port,
-                    rs->mqtt_everest_prefix, rs->mqtt_external_prefix, rs->telemetry_prefix, rs->telemetry_enabled);
+        auto everest = Everest(this->module_id, config, rs->schema_validation, get_mqtt_settings(*rs),
+                               rs->telemetry_prefix, rs->telemetry_enabled);
 
         // module import
         EVLOG_debug << fmt::format("Initializing module {}...", module_identifier);
 
         if (!everest.connect()) {
-            EVLOG_error << fmt::format("Cannot connect to MQTT broker at {}:{}", rs->mqtt_broker_host,
-                                       rs->mqtt_broker_port);
+            EVLOG_error << fmt::format("Cannot connect to MQTT broker at {}", get_mqtt_broker_address(*rs));
             return 1;
         }
 
@@ -404,10 +573,25 @@ int ModuleLoader::initialize() {
             return everest.call_cmd(req, cmd_name, args);
         };
 
+        module_adapter.call_async = [&everest](const Requirement& req, const std::string& cmd_name, Parameters args,
+                                               std::optional<std::chrono::milliseconds> timeout) {
+            return everest.call_cmd_async(req, cmd_name, std::move(args), timeout);
+        };
+
+        module_adapter.call_async_callback = [&everest](const Requirement& req, const std::string& cmd_name,
+                                                        Parameters args, CmdResultCallback callback,
+                                                        std::optional<std::chrono::milliseconds> timeout) {
+            everest.call_cmd_async(req, cmd_name, std::move(args), std::move(callback), timeout);
+        };
+
         module_adapter.publish = [&everest](const std::string& param1, const std::string& param2, Value param3) {
             return everest.publish_var(param1, param2, param3);
         };
 
+        module_adapter.publish_batch = [&everest](const std::string& impl_id, VarBatch vars) {
+            everest.publish_vars(impl_id, std::move(vars));
+        };
+
         module_adapter.subscribe = [&everest](const Requirement& req, const std::string& var_name,
                                               const ValueCallback& callback) {
             return everest.subscribe_var(req, var_name, callback);
@@ -474,7 +658,7 @@ int ModuleLoader::initialize() {
 
         // FIXME (aw): would be nice to move this config related thing toward the module_init function
         std::vector<cmd> cmds =
-            this->callbacks.everest_register(config.get_main_config()[this->module_id]["connections"]);
+            this->callbacks.everest_register(config.get_main_config().at(this->module_id).at("connections"));
 
         for (auto const& command : cmds) {
             everest.provide_cmd(command);
@@ -0,0 +1,198 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+#include <stdexcept>
+
+#include <fmt/format.h>
+
+#include <utils/schema_validator_cache.hpp>
+
+namespace Everest {
+
+namespace {
+// maps a json schema "type" to the json value types it allows
+void add_types(const json& type, std::vector<json::value_t>& types) {
+    if (!type.is_string()) {
+        return;
+    }
+    const auto& name = type.get_ref<const std::string&>();
+    if (name == "null") {
+        types.push_back(json::value_t::null);
+    } else if (name == "boolean") {
+        types.push_back(json::value_t::boolean);
+    } else if (name == "object") {
+        types.push_back(json::value_t::object);
+    } else if (name == "array") {
+        types.push_back(json::value_t::array);
+    } else if (name == "string") {
+        types.push_back(json::value_t::string);
+    } else if (name == "integer") {
+        types.push_back(json::value_t::number_integer);
+        types.push_back(json::value_t::number_unsigned);
+    } else if (name == "number") {
+        types.push_back(json::value_t::number_integer);
+        types.push_back(json::value_t::number_unsigned);
+        types.push_back(json::value_t::number_float);
+    }
+}
+
+// limits chains of schemas that only refer to other schemas, so reference cycles cannot hang the constructor
+constexpr int max_ref_depth = 16;
+
+// follows the $refs of a schema that only refers to another schema, like most cmd and var definitions do with types
+std::optional<json> resolve_refs(const json& schema,
+                                 const std::function<void(const json_uri& uri, json& schema)>& loader) {
+    json document = schema;
+    json resolved = schema;
+    for (int depth = 0; depth < max_ref_depth; depth++) {
+        if (!resolved.is_object()) {
+            return resolved;
+        }
+        const auto ref_it = resolved.find("$ref");
+        if (ref_it == resolved.end() || !ref_it->is_string()) {
+            return resolved;
+        }
+        const auto ref = ref_it->get<std::string>();
+        try {
+            if (!ref.empty() && ref.front() == '#') {
+                // reference into the document the current schema was taken from
+                resolved = document.at(json::json_pointer(ref.substr(1)));
+            } else {
+                const json_uri uri(ref);
+                json loaded;
+                loader(uri, loaded);
+                document = std::move(loaded);
+                resolved = document.at(uri.pointer());
+            }
+        } catch (const std::exception&) {
+            return std::nullopt;
+        }
+    }
+    return std::nullopt;
+}
+} // namespace
+
+SchemaValidator::SchemaValidator(
+    const json& schema, const SchemaValidationSettings& settings,
+    const std::function<void(const json_uri& uri, json& schema)>& loader,
+    const std::function<void(const std::string& format, const std::string& value)>& format_checker,
+    std::shared_ptr<Counters> counters) :
+    settings(settings), counters(std::move(counters)) {
+    if (settings.mode == SchemaValidationMode::Full || settings.mode == SchemaValidationMode::Sampled) {
+        this->validator.emplace(loader, format_checker);
+        this->validator->set_root_schema(schema);
+    }
+
+    // schemas whose $refs cannot be resolved leave types and required empty, their messages are counted as skipped
+    const auto resolved = settings.mode == SchemaValidationMode::TypeOnly ? resolve_refs(schema, loader) : std::nullopt;
+    if (resolved.has_value() && resolved->is_object()) {
+        const auto type_it = resolved->find("type");
+        if (type_it != resolved->end() && type_it->is_string()) {
+            add_types(*type_it, this->types);
+        } else if (type_it != resolved->end() && type_it->is_array()) {
+            for (const auto& type : *type_it) {
+                add_types(type, this->types);
+            }
+        }
+        const auto required_it = resolved->find("required");
+        if (required_it != resolved->end() && required_it->is_array()) {
+            for (const auto& property : *required_it) {
+                this->required.push_back(property.get<std::string>());
+            }
+        }
+    }
+}
+
+void SchemaValidator::validate(const json& value) const {
+    switch (this->settings.mode) {
+    case SchemaValidationMode::Full:
+        this->counters->validated++;
+        this->validator->validate(value);
+        break;
+    case SchemaValidationMode::Sampled: {
+        const auto message = this->messages++;
+        const auto sampled = message < this->settings.sample_first ||
+                             (this->settings.sample_every != 0 &&
+                              (message - this->settings.sample_first) % this->settings.sample_every == 0);
+        if (!sampled) {
+            this->counters->skipped++;
+            break;
+        }
+        this->counters->validated++;
+        this->validator->validate(value);
+        break;
+    }
+    case SchemaValidationMode::TypeOnly:
+        if (this->types.empty() && this->required.empty()) {
+            // nothing to check, e.g. the schema only combines other schemas
+            this->counters->skipped++;
+            break;
+        }
+        this->counters->type_checked++;
+        this->check_type(value);
+        break;
+    case SchemaValidationMode::Off:
+    default:
+        this->counters->skipped++;
+        break;
+    }
+}
+
+void SchemaValidator::check_type(const json& value) const {
+    if (!this->types.empty() && std::find(this->types.begin(), this->types.end(), value.type()) == this->types.end()) {
+        throw std::invalid_argument(fmt::format("unexpected type {}", value.type_name()));
+    }
+    if (!value.is_object()) {
+        return;
+    }
+    for (const auto& property : this->required) {
+        if (!value.contains(property)) {
+            throw std::invalid_argument(fmt::format("required property '{}' not found", property));
+        }
+    }
+}
+
+SchemaValidatorCache::SchemaValidatorCache(SchemaLoader loader, FormatChecker format_checker,
+                                           SchemaValidationSettings settings) :
+    loader(std::move(loader)),
+    format_checker(std::move(format_checker)),
+    settings(settings),
+    counters(std::make_shared<SchemaValidator::Counters>()) {
+}
+
+std::shared_ptr<const SchemaValidator> SchemaValidatorCache::get(const std::string& key, const json& schema) {
+    // compiling happens while holding the lock, the schema loader does not need to be thread-safe this way
+    const std::lock_guard<std::mutex> lock(this->validators_mutex);
+    const auto validator_it = this->validators.find(key);
+    if (validator_it != this->validators.end()) {
+        return validator_it->second;
+    }
+
+    auto validator = std::make_shared<const SchemaValidator>(schema, this->settings, this->loader,
+                                                             this->format_checker, this->counters);
+    this->validators.emplace(key, validator);
+    return validator;
+}
+
+bool SchemaValidatorCache::is_enabled() const {
+    return this->settings.mode != SchemaValidationMode::Off;
+}
+
+void SchemaValidatorCache::count_skipped() {
+    this->counters->skipped++;
+}
+
+size_t SchemaValidatorCache::size() const {
+    const std::lock_guard<std::mutex> lock(this->validators_mutex);
+    return this->validators.size();
+}
+
+SchemaValidationStatistics SchemaValidatorCache::get_statistics() const {
+    SchemaValidationStatistics statistics;
+    statistics.validated = this->counters->validated;
+    statistics.type_checked = this->counters->type_checked;
+    statistics.skipped = this->counters->skipped;
+    return statistics;
+}
+
+} // namespace Everest
@@ -0,0 +1,316 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <atomic>
+#include <cerrno>
+#include <charconv>
+#include <cstring>
+#include <new>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/shared_memory_transport.hpp>
+
+namespace Everest {
+namespace {
+// neither json text nor a CBOR or MessagePack document longer than a single byte starts with a NUL character, so
+// descriptors cannot be mistaken for payloads
+constexpr std::string_view descriptor_marker{"\0shm:", 5};
+
+/// \brief the start of every segment, the payload follows it
+struct SegmentHeader {
+    std::atomic<uint32_t> pending_readers; ///< registered readers that have not mapped the segment yet
+    uint32_t sequence;                     ///< the newest registration counted in pending_readers
+};
+static_assert(std::atomic<uint32_t>::is_always_lock_free, "segment headers are shared between processes");
+
+/// the registry of the readers of a topic holds their registration sequence number in its upper and their number in
+/// its lower 32 bits, so a reader gets its sequence number with the same atomic operation that registers it
+using Registry = std::atomic<uint64_t>;
+static_assert(Registry::is_always_lock_free, "registries are shared between processes");
+constexpr uint64_t registration = (uint64_t{1} << 32) | 1;
+constexpr uint64_t registered_readers_mask = 0xffffffff;
+
+/// \returns the FNV-1a hash of \p data, which unlike std::hash is the same in every process
+uint64_t fnv1a(std::string_view data) {
+    uint64_t hash = 0xcbf29ce484222325;
+    for (const auto c : data) {
+        hash ^= static_cast<uint8_t>(c);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+/// \brief a mapping of a whole segment, unmapped on destruction
+class Mapping {
+public:
+    Mapping(void* data, size_t size) : data(data), size(size) {
+    }
+    ~Mapping() {
+        if (this->data != MAP_FAILED) {
+            munmap(this->data, this->size);
+        }
+    }
+    Mapping(Mapping const&) = delete;
+    void operator=(Mapping const&) = delete;
+
+    const char* begin() const {
+        return static_cast<const char*>(this->data);
+    }
+
+    SegmentHeader* header() const {
+        return static_cast<SegmentHeader*>(this->data);
+    }
+
+private:
+    void* data;
+    size_t size;
+};
+} // namespace
+
+SharedMemoryTransport::SharedMemoryTransport(size_t threshold, size_t max_size, std::chrono::milliseconds lease) :
+    threshold(threshold),
+    max_size(max_size),
+    lease(lease),
+    // the start time keeps the names unique even if a crashed process with the same pid left segments behind
+    name_prefix(fmt::format("/everest-{}-{:x}-", getpid(),
+                            std::chrono::steady_clock::now().time_since_epoch().count())) {
+}
+
+SharedMemoryTransport::~SharedMemoryTransport() {
+    {
+        const std::lock_guard<std::mutex> lock(this->segments_mutex);
+        for (const auto& segment : this->segments) {
+            munmap(segment.mapping, sizeof(SegmentHeader) + segment.size);
+            shm_unlink(segment.name.c_str());
+        }
+        for (const auto& [topic, readers] : this->publish_registries) {
+            munmap(readers, sizeof(Registry));
+        }
+    }
+    const std::lock_guard<std::mutex> lock(this->registrations_mutex);
+    for (const auto& [topic, registration] : this->registrations) {
+        registration.readers->fetch_sub(1);
+        munmap(registration.readers, sizeof(Registry));
+    }
+}
+
+bool SharedMemoryTransport::accepts(size_t size) const {
+    return this->threshold > 0 && size >= this->threshold;
+}
+
+void SharedMemoryTransport::subscribe(const std::string& topic) {
+    if (this->threshold == 0) {
+        return;
+    }
+    const std::lock_guard<std::mutex> lock(this->registrations_mutex);
+    if (this->registrations.find(topic) != this->registrations.end()) {
+        return;
+    }
+    auto* readers = map_registry(topic);
+    if (readers == nullptr) {
+        EVLOG_warning << fmt::format("Could not register as reader of shared memory segments on topic {}: {}", topic,
+                                     strerror(errno));
+        return;
+    }
+    const auto previous = readers->fetch_add(registration);
+    this->registrations.emplace(topic, Registration{readers, static_cast<uint32_t>(previous >> 32) + 1});
+}
+
+void SharedMemoryTransport::unsubscribe(const std::string& topic) {
+    const std::lock_guard<std::mutex> lock(this->registrations_mutex);
+    const auto it = this->registrations.find(topic);
+    if (it == this->registrations.end()) {
+        return;
+    }
+    it->second.readers->fetch_sub(1);
+    munmap(it->second.readers, sizeof(Registry));
+    this->registrations.erase(it);
+}
+
+std::optional<std::string> SharedMemoryTransport::publish(const std::string& topic, std::string_view data) {
+    const std::lock_guard<std::mutex> lock(this->segments_mutex);
+    this->release_segments_locked(std::chrono::steady_clock::now());
+
+    auto registry_it = this->publish_registries.find(topic);
+    if (registry_it == this->publish_registries.end()) {
+        auto* readers = map_registry(topic);
+        if (readers == nullptr) {
+            EVLOG_warning << fmt::format("Could not open the shared memory readers of topic {}: {}", topic,
+                                         strerror(errno));
+            this->publish_fallbacks++;
+            return std::nullopt;
+        }
+        registry_it = this->publish_registries.emplace(topic, readers).first;
+    }
+    const auto registry = registry_it->second->load();
+    const auto readers = static_cast<uint32_t>(registry & registered_readers_mask);
+    if (readers == 0) {
+        // nobody reads the payload from shared memory, so there is no point in holding a segment
+        return std::nullopt;
+    }
+    if (this->bytes_held + data.size() > this->max_size) {
+        this->publish_fallbacks++;
+        return std::nullopt;
+    }
+
+    auto name = fmt::format("{}{}", this->name_prefix, this->next_segment++);
+    const int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        EVLOG_warning << fmt::format("Could not create shared memory segment {}: {}", name, strerror(errno));
+        this->publish_fallbacks++;
+        return std::nullopt;
+    }
+
+    const auto segment_size = sizeof(SegmentHeader) + data.size();
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, static_cast<off_t>(segment_size)) == 0) {
+        mapped = mmap(nullptr, segment_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        EVLOG_warning << fmt::format("Could not map shared memory segment {}: {}", name, strerror(errno));
+        shm_unlink(name.c_str());
+        this->publish_fallbacks++;
+        return std::nullopt;
+    }
+    auto* header = new (mapped) SegmentHeader;
+    header->pending_readers = readers;
+    header->sequence = static_cast<uint32_t>(registry >> 32);
+    std::memcpy(static_cast<char*>(mapped) + sizeof(SegmentHeader), data.data(), data.size());
+
+    this->segments.push_back({name, data.size(), std::chrono::steady_clock::now() + this->lease, mapped});
+    this->bytes_held += data.size();
+    this->segments_published++;
+    return fmt::format("{}{}:{}", descriptor_marker, name, data.size());
+}
+
+void SharedMemoryTransport::release_segments() {
+    const std::lock_guard<std::mutex> lock(this->segments_mutex);
+    this->release_segments_locked(std::chrono::steady_clock::now());
+}
+
+bool SharedMemoryTransport::is_descriptor(std::string_view payload) {
+    return payload.substr(0, descriptor_marker.size()) == descriptor_marker;
+}
+
+std::shared_ptr<const json> SharedMemoryTransport::read(const std::string& topic, std::string_view descriptor,
+                                                        PayloadEncoding encoding) {
+    descriptor.remove_prefix(descriptor_marker.size());
+    const auto separator = descriptor.rfind(':');
+    size_t size = 0;
+    if (separator == std::string_view::npos ||
+        std::from_chars(descriptor.data() + separator + 1, descriptor.data() + descriptor.size(), size).ec !=
+            std::errc() ||
+        size == 0) {
+        EVLOG_warning << "Received a malformed shared memory descriptor";
+        this->segments_missed++;
+        return nullptr;
+    }
+    const std::string name(descriptor.substr(0, separator));
+
+    // only readers registered for the exact topic were counted by the publisher
+    std::optional<uint32_t> sequence;
+    {
+        const std::lock_guard<std::mutex> lock(this->registrations_mutex);
+        const auto it = this->registrations.find(topic);
+        if (it != this->registrations.end()) {
+            sequence = it->second.sequence;
+        }
+    }
+
+    const int fd = shm_open(name.c_str(), (sequence.has_value() ? O_RDWR : O_RDONLY) | O_CLOEXEC, 0);
+    if (fd == -1) {
+        EVLOG_error << fmt::format("Shared memory segment {} received on topic {} is no longer available: {}", name,
+                                   topic, strerror(errno));
+        this->segments_missed++;
+        return nullptr;
+    }
+    // reading beyond the end of a segment would raise SIGBUS
+    const auto segment_size = sizeof(SegmentHeader) + size;
+    struct stat segment_stat = {};
+    if (fstat(fd, &segment_stat) == -1 || static_cast<size_t>(segment_stat.st_size) < segment_size) {
+        EVLOG_warning << fmt::format("Shared memory segment {} is smaller than announced", name);
+        close(fd);
+        this->segments_missed++;
+        return nullptr;
+    }
+    // the mapping keeps the segment alive even if its publisher releases it in the meantime
+    const auto protection = sequence.has_value() ? PROT_READ | PROT_WRITE : PROT_READ;
+    const Mapping mapping(mmap(nullptr, segment_size, protection, MAP_SHARED, fd, 0), segment_size);
+    close(fd);
+    if (mapping.begin() == MAP_FAILED) {
+        EVLOG_warning << fmt::format("Could not map shared memory segment {}: {}", name, strerror(errno));
+        this->segments_missed++;
+        return nullptr;
+    }
+
+    // readers that registered after the segment was published were not counted
+    auto* header = mapping.header();
+    if (sequence.has_value() && sequence.value() <= header->sequence) {
+        auto pending = header->pending_readers.load();
+        while (pending > 0 && !header->pending_readers.compare_exchange_weak(pending, pending - 1)) {
+        }
+    }
+
+    const auto* payload = mapping.begin() + sizeof(SegmentHeader);
+    auto data = std::make_shared<const json>(decode_payload(payload, payload + size, encoding));
+    this->segments_read++;
+    return data;
+}
+
+SharedMemoryStatistics SharedMemoryTransport::get_statistics() const {
+    SharedMemoryStatistics statistics;
+    statistics.segments_published = this->segments_published;
+    statistics.segments_released = this->segments_released;
+    statistics.segments_expired = this->segments_expired;
+    statistics.bytes_held = this->bytes_held;
+    statistics.publish_fallbacks = this->publish_fallbacks;
+    statistics.segments_read = this->segments_read;
+    statistics.segments_missed = this->segments_missed;
+    return statistics;
+}
+
+void SharedMemoryTransport::release_segments_locked(std::chrono::steady_clock::time_point now) {
+    for (auto it = this->segments.begin(); it != this->segments.end();) {
+        const auto read = static_cast<SegmentHeader*>(it->mapping)->pending_readers == 0;
+        if (!read && it->expires > now) {
+            ++it;
+            continue;
+        }
+        if (!read) {
+            this->segments_expired++;
+        }
+        munmap(it->mapping, sizeof(SegmentHeader) + it->size);
+        shm_unlink(it->name.c_str());
+        this->bytes_held -= it->size;
+        this->segments_released++;
+        it = this->segments.erase(it);
+    }
+}
+
+std::atomic<uint64_t>* SharedMemoryTransport::map_registry(const std::string& topic) {
+    // registries are tiny and shared by all processes of the host, so they are kept once created
+    const auto name = fmt::format("/everest-readers-{:016x}", fnv1a(topic));
+    const int fd = shm_open(name.c_str(), O_CREAT | O_RDWR | O_CLOEXEC, S_IRUSR | S_IWUSR);
+    if (fd == -1) {
+        return nullptr;
+    }
+    void* mapped = MAP_FAILED;
+    if (ftruncate(fd, sizeof(Registry)) == 0) {
+        mapped = mmap(nullptr, sizeof(Registry), PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    }
+    close(fd);
+    if (mapped == MAP_FAILED) {
+        return nullptr;
+    }
+    return static_cast<Registry*>(mapped);
+}
+
+} // namespace Everest
@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <utility>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/subscription_batch.hpp>
+
+namespace Everest {
+namespace {
+// keeps single packets well below the packet size limits brokers usually apply
+constexpr size_t max_topics_per_packet = 128;
+constexpr size_t max_packet_size = 16 * 1024;
+// upper bound of the fixed header and the packet id of a SUBSCRIBE or UNSUBSCRIBE packet
+constexpr size_t packet_overhead = 7;
+constexpr uint8_t subscribe_packet_type = 0x82;
+
+/// \returns the size of the SUBSCRIBE payload entry for \p topic: its length, the topic itself and the QoS
+size_t payload_entry_size(const std::string& topic) {
+    return 2 + topic.size() + 1;
+}
+
+uint8_t qos_level(QOS qos) {
+    switch (qos) {
+    case QOS::QOS1:
+        return 1;
+    case QOS::QOS2:
+        return 2;
+    case QOS::QOS0:
+    default:
+        return 0;
+    }
+}
+} // namespace
+
+size_t pack_subscribe_request(uint8_t* buffer, size_t size, uint16_t packet_id, const SubscriptionChange* first,
+                              const SubscriptionChange* last) {
+    size_t remaining_length = 2;
+    for (const auto* change = first; change != last; change++) {
+        remaining_length += payload_entry_size(change->topic);
+    }
+
+    // fixed header with the remaining length as variable byte integer
+    uint8_t header[5] = {subscribe_packet_type};
+    size_t header_size = 1;
+    auto length = remaining_length;
+    do {
+        header[header_size] = static_cast<uint8_t>(length & 0x7f);
+        length >>= 7;
+        if (length > 0) {
+            header[header_size] |= 0x80;
+        }
+        header_size++;
+    } while (length > 0 && header_size < sizeof(header));
+
+    const auto packet_size = header_size + remaining_length;
+    if (length > 0 || packet_size > size) {
+        return 0;
+    }
+
+    auto* out = buffer;
+    for (size_t i = 0; i < header_size; i++) {
+        *out++ = header[i];
+    }
+    *out++ = static_cast<uint8_t>(packet_id >> 8);
+    *out++ = static_cast<uint8_t>(packet_id & 0xff);
+    for (const auto* change = first; change != last; change++) {
+        *out++ = static_cast<uint8_t>(change->topic.size() >> 8);
+        *out++ = static_cast<uint8_t>(change->topic.size() & 0xff);
+        for (const auto c : change->topic) {
+            *out++ = static_cast<uint8_t>(c);
+        }
+        *out++ = qos_level(change->qos);
+    }
+    return packet_size;
+}
+
+bool SubscriptionBatch::subscribe(const std::string& topic, QOS qos) {
+    return this->add({topic, qos, true});
+}
+
+bool SubscriptionBatch::unsubscribe(const std::string& topic) {
+    return this->add({topic, QOS::QOS0, false});
+}
+
+bool SubscriptionBatch::add(SubscriptionChange change) {
+    const std::lock_guard<std::mutex> lock(this->changes_mutex);
+    this->changes.push_back(std::move(change));
+    return !this->changes_pending.exchange(true);
+}
+
+bool SubscriptionBatch::pending() const {
+    return this->changes_pending;
+}
+
+void SubscriptionBatch::clear() {
+    const std::lock_guard<std::mutex> lock(this->changes_mutex);
+    this->changes.clear();
+    this->changes_pending = false;
+}
+
+void SubscriptionBatch::flush(struct mqtt_client& client, MQTTBuffers& buffers) {
+    std::vector<SubscriptionChange> flushed;
+    {
+        const std::lock_guard<std::mutex> lock(this->changes_mutex);
+        flushed.swap(this->changes);
+        this->changes_pending = false;
+    }
+
+    const auto* it = flushed.data();
+    const auto* end = it + flushed.size();
+    while (it != end) {
+        if (!it->subscribe) {
+            buffers.reserve_send_space(client, it->topic.size() + packet_overhead);
+            mqtt_unsubscribe(&client, it->topic.c_str());
+            this->unsubscribe_packets++;
+            it++;
+            continue;
+        }
+
+        // consecutive subscriptions share a packet, keeping the order of all changes
+        const auto* last = it;
+        size_t packet_size = packet_overhead;
+        while (last != end && last->subscribe && static_cast<size_t>(last - it) < max_topics_per_packet &&
+               (last == it || packet_size + payload_entry_size(last->topic) <= max_packet_size)) {
+            packet_size += payload_entry_size(last->topic);
+            last++;
+        }
+        const auto topics = static_cast<uint64_t>(last - it);
+
+        size_t packed = 0;
+        if (buffers.reserve_send_space(client, packet_size)) {
+            MQTT_PAL_MUTEX_LOCK(&client.mutex);
+            const auto packet_id = __mqtt_next_pid(&client);
+            packed = pack_subscribe_request(client.mq.curr, client.mq.curr_sz, packet_id, it, last);
+            if (packed > 0) {
+                auto* message = mqtt_mq_register(&client.mq, packed);
+                message->control_type = MQTT_CONTROL_SUBSCRIBE;
+                message->packet_id = packet_id;
+            }
+            MQTT_PAL_MUTEX_UNLOCK(&client.mutex);
+        }
+
+        if (packed > 0) {
+            this->topics_subscribed += topics;
+            this->subscribe_packets++;
+        } else {
+            EVLOG_error << fmt::format("Could not subscribe to {} topics starting with {}, they exceed the MQTT "
+                                       "buffer limit",
+                                       topics, it->topic);
+        }
+        it = last;
+    }
+}
+
+SubscriptionStatistics SubscriptionBatch::get_statistics() const {
+    SubscriptionStatistics statistics;
+    statistics.topics_subscribed = this->topics_subscribed;
+    statistics.subscribe_packets = this->subscribe_packets;
+    statistics.unsubscribe_packets = this->unsubscribe_packets;
+    return statistics;
+}
+
+} // namespace Everest
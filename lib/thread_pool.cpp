@@ -0,0 +1,121 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+
+#include <fmt/format.h>
+
+#include <everest/logging.hpp>
+
+#include <utils/thread_pool.hpp>
+
+namespace Everest {
+
+namespace {
+// minimum number of workers when the pool size is selected automatically, handlers might block for some time (e.g.
+// while waiting for the result of a command) and should not be able to starve all others that easily
+constexpr size_t min_automatic_pool_size = 4;
+
+// allows workers to post follow-up tasks to their own queue
+thread_local const ThreadPool* current_pool = nullptr;
+thread_local size_t current_queue_index = 0;
+} // namespace
+
+ThreadPool::ThreadPool(size_t number_of_threads) {
+    BOOST_LOG_FUNCTION();
+
+    if (number_of_threads == 0) {
+        number_of_threads = std::max<size_t>(min_automatic_pool_size, std::thread::hardware_concurrency());
+    }
+
+    for (size_t i = 0; i < number_of_threads; i++) {
+        this->queues.push_back(std::make_unique<WorkerQueue>());
+    }
+
+    this->workers.reserve(number_of_threads);
+    for (size_t i = 0; i < number_of_threads; i++) {
+        this->workers.emplace_back([this, i]() { this->run_worker(i); });
+    }
+
+    EVLOG_debug << fmt::format("Started thread pool with {} workers", number_of_threads);
+}
+
+ThreadPool::~ThreadPool() {
+    {
+        std::lock_guard<std::mutex> lock(this->idle_mutex);
+        this->running = false;
+    }
+    this->idle_cv.notify_all();
+
+    for (auto& worker : this->workers) {
+        worker.join();
+    }
+}
+
+void ThreadPool::post(Task task) {
+    size_t index = 0;
+    if (current_pool == this) {
+        index = current_queue_index;
+    } else {
+        index = this->next_queue++ % this->queues.size();
+    }
+
+    {
+        auto& queue = *this->queues.at(index);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        queue.tasks.push_back(std::move(task));
+        // counted while holding the queue lock, so the matching decrement in try_pop can never happen first
+        this->pending_tasks++;
+    }
+
+    // an idle worker might have just checked for pending tasks, taking the lock makes sure it is waiting already
+    { std::lock_guard<std::mutex> lock(this->idle_mutex); }
+    this->idle_cv.notify_one();
+}
+
+size_t ThreadPool::size() const {
+    return this->workers.size();
+}
+
+bool ThreadPool::try_pop(size_t index, Task& task) {
+    const auto number_of_queues = this->queues.size();
+    for (size_t offset = 0; offset < number_of_queues; offset++) {
+        auto& queue = *this->queues.at((index + offset) % number_of_queues);
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty()) {
+            continue;
+        }
+        if (offset == 0) {
+            // own queue: oldest task first
+            task = std::move(queue.tasks.front());
+            queue.tasks.pop_front();
+        } else {
+            // steal from the other end to keep contention with the owner low
+            task = std::move(queue.tasks.back());
+            queue.tasks.pop_back();
+        }
+        this->pending_tasks--;
+        return true;
+    }
+    return false;
+}
+
+void ThreadPool::run_worker(size_t index) {
+    current_pool = this;
+    current_queue_index = index;
+
+    while (true) {
+        Task task;
+        if (this->try_pop(index, task)) {
+            task();
+            continue;
+        }
+
+        std::unique_lock<std::mutex> lock(this->idle_mutex);
+        this->idle_cv.wait(lock, [this]() { return this->pending_tasks > 0 || !this->running; });
+        if (!this->running) {
+            return;
+        }
+    }
+}
+
+} // namespace Everest
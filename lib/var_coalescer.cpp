@@ -0,0 +1,112 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <algorithm>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/var_coalescer.hpp>
+
+namespace Everest {
+
+json make_var_message(const VarBatch& vars) {
+    if (vars.size() == 1) {
+        return {{"name", vars.front().first}, {"data", vars.front().second}};
+    }
+
+    json batch = json::array();
+    for (const auto& [var_name, value] : vars) {
+        batch.push_back({{"name", var_name}, {"data", value}});
+    }
+    return {{"batch", std::move(batch)}};
+}
+
+VarCoalescer::VarCoalescer(std::chrono::milliseconds window, PublishFunc publish) :
+    window(window), publish(std::move(publish)) {
+    this->thread = std::thread(&VarCoalescer::run, this);
+}
+
+VarCoalescer::~VarCoalescer() {
+    {
+        const std::lock_guard<std::mutex> lock(this->batches_mutex);
+        this->running = false;
+    }
+    this->batches_cv.notify_one();
+    this->thread.join();
+    this->flush();
+}
+
+void VarCoalescer::add(const std::string& impl_id, const std::string& var_name, json value) {
+    const std::lock_guard<std::mutex> lock(this->batches_mutex);
+    auto batch_it = this->batches.find(impl_id);
+    if (batch_it == this->batches.end()) {
+        Batch batch;
+        batch.deadline = std::chrono::steady_clock::now() + this->window;
+        batch.vars.emplace_back(var_name, std::move(value));
+        this->batches.emplace(impl_id, std::move(batch));
+        this->batches_cv.notify_one();
+        return;
+    }
+
+    auto& vars = batch_it->second.vars;
+    const auto var_it =
+        std::find_if(vars.begin(), vars.end(), [&var_name](const auto& var) { return var.first == var_name; });
+    if (var_it != vars.end()) {
+        var_it->second = std::move(value);
+    } else {
+        vars.emplace_back(var_name, std::move(value));
+    }
+}
+
+void VarCoalescer::flush() {
+    std::map<std::string, Batch> due_batches;
+    {
+        const std::lock_guard<std::mutex> lock(this->batches_mutex);
+        due_batches.swap(this->batches);
+    }
+    this->publish_batches(std::move(due_batches));
+}
+
+void VarCoalescer::run() {
+    std::unique_lock<std::mutex> lock(this->batches_mutex);
+    while (this->running) {
+        if (this->batches.empty()) {
+            this->batches_cv.wait(lock);
+            continue;
+        }
+
+        const auto now = std::chrono::steady_clock::now();
+        auto next_deadline = std::chrono::steady_clock::time_point::max();
+        std::map<std::string, Batch> due_batches;
+        for (auto batch_it = this->batches.begin(); batch_it != this->batches.end();) {
+            if (batch_it->second.deadline <= now) {
+                due_batches.insert(this->batches.extract(batch_it++));
+            } else {
+                next_deadline = std::min(next_deadline, batch_it->second.deadline);
+                ++batch_it;
+            }
+        }
+
+        if (due_batches.empty()) {
+            this->batches_cv.wait_until(lock, next_deadline);
+            continue;
+        }
+
+        lock.unlock();
+        this->publish_batches(std::move(due_batches));
+        lock.lock();
+    }
+}
+
+void VarCoalescer::publish_batches(std::map<std::string, Batch> due_batches) {
+    for (const auto& [impl_id, batch] : due_batches) {
+        try {
+            this->publish(impl_id, batch.vars);
+        } catch (const std::exception& e) {
+            EVLOG_error << fmt::format("Could not publish the vars of implementation '{}': {}", impl_id, e.what());
+        }
+    }
+}
+
+} // namespace Everest
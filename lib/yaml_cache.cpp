@@ -0,0 +1,166 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <fstream>
+#include <iterator>
+#include <system_error>
+
+#include <unistd.h>
+
+#include <everest/logging.hpp>
+
+#include <fmt/format.h>
+
+#include <utils/yaml_cache.hpp>
+#include <utils/yaml_loader.hpp>
+
+namespace Everest {
+namespace {
+// version of the format of the entries, entries of other versions are not used
+constexpr int yaml_cache_version = 1;
+constexpr auto entry_extension = ".cbor";
+constexpr auto temporary_extension = ".tmp";
+
+std::string read_file(const fs::path& path) {
+    std::ifstream ifs(path, std::ios::binary);
+    if (!ifs) {
+        throw std::runtime_error(fmt::format("Could not open '{}'", path.string()));
+    }
+    return std::string(std::istreambuf_iterator<char>(ifs), std::istreambuf_iterator<char>());
+}
+} // namespace
+
+YamlCache::YamlCache(fs::path cache_dir) : cache_dir(std::move(cache_dir)) {
+}
+
+json YamlCache::load(const fs::path& path, const json& schema, const Processor& process) {
+    BOOST_LOG_FUNCTION();
+
+    if (!this->is_enabled()) {
+        return process(load_yaml(path));
+    }
+
+    std::error_code size_error;
+    std::error_code time_error;
+    const auto file_size = fs::file_size(path, size_error);
+    const auto write_time = fs::last_write_time(path, time_error);
+    if (size_error || time_error) {
+        // missing files are reported by load_yaml(), which also knows about the deprecated json fallback
+        return process(load_yaml(path));
+    }
+
+    const auto content = read_file(path);
+    const auto schema_hash = YamlCache::hash(schema.dump());
+    const auto absolute_path = fs::absolute(path).string();
+    const json key = {
+        {"version", yaml_cache_version},
+        {"path", absolute_path},
+        {"size", file_size},
+        {"mtime", static_cast<std::int64_t>(write_time.time_since_epoch().count())},
+        {"hash", YamlCache::hash(content)},
+        {"schema", schema_hash},
+    };
+    const auto entry_path =
+        this->cache_dir /
+        fmt::format("{:016x}{}", YamlCache::hash(fmt::format("{}\n{:016x}", absolute_path, schema_hash)),
+                    entry_extension);
+
+    auto cached = this->read_entry(entry_path, key);
+    if (cached.has_value()) {
+        this->state->hits++;
+        return std::move(*cached);
+    }
+
+    this->state->misses++;
+    auto value = process(parse_yaml(content));
+    this->write_entry(entry_path, key, value);
+    return value;
+}
+
+json YamlCache::load(const fs::path& path) {
+    return this->load(path, nullptr, [](json value) { return value; });
+}
+
+std::optional<json> YamlCache::read_entry(const fs::path& entry_path, const json& key) const {
+    std::error_code error;
+    if (!fs::is_regular_file(entry_path, error)) {
+        return std::nullopt;
+    }
+
+    try {
+        auto entry = json::from_cbor(read_file(entry_path));
+        for (const auto& field : key.items()) {
+            if (entry.at(field.key()) != field.value()) {
+                EVLOG_debug << fmt::format("Cache entry of {} is outdated: {} changed",
+                                           key.at("path").get<std::string>(), field.key());
+                return std::nullopt;
+            }
+        }
+        return std::move(entry.at("value"));
+    } catch (const std::exception& e) {
+        EVLOG_debug << fmt::format("Ignoring unreadable cache entry {}: {}", entry_path.string(), e.what());
+    }
+    return std::nullopt;
+}
+
+void YamlCache::write_entry(const fs::path& entry_path, const json& key, const json& value) {
+    json entry = key;
+    entry["value"] = value;
+    const auto data = json::to_cbor(entry);
+
+    // the entry is written to a temporary file first and renamed, so concurrent readers never see a partial entry
+    auto temporary_path = entry_path;
+    temporary_path += fmt::format(".{}.{}{}", getpid(), this->state->temporary_files++, temporary_extension);
+    try {
+        fs::create_directories(this->cache_dir);
+        {
+            std::ofstream ofs(temporary_path, std::ios::binary | std::ios::trunc);
+            ofs.write(reinterpret_cast<const char*>(data.data()), data.size());
+            if (!ofs) {
+                throw std::runtime_error(fmt::format("Could not write '{}'", temporary_path.string()));
+            }
+        }
+        fs::rename(temporary_path, entry_path);
+    } catch (const std::exception& e) {
+        std::error_code error;
+        fs::remove(temporary_path, error);
+        EVLOG_debug << fmt::format("Disabling the config cache in {}: {}", this->cache_dir.string(), e.what());
+        this->state->write_failed = true;
+    }
+}
+
+std::size_t YamlCache::clear() const {
+    BOOST_LOG_FUNCTION();
+
+    std::size_t removed = 0;
+    std::error_code error;
+    if (!this->is_enabled() || !fs::is_directory(this->cache_dir, error)) {
+        return removed;
+    }
+    for (const auto& entry : fs::directory_iterator(this->cache_dir)) {
+        const auto extension = entry.path().extension();
+        if (entry.is_regular_file() && (extension == entry_extension || extension == temporary_extension)) {
+            fs::remove(entry.path());
+            removed++;
+        }
+    }
+    return removed;
+}
+
+bool YamlCache::is_enabled() const {
+    return !this->cache_dir.empty() && !this->state->write_failed;
+}
+
+YamlCache::Statistics YamlCache::get_statistics() const {
+    return {this->state->hits, this->state->misses};
+}
+
+std::uint64_t YamlCache::hash(std::string_view data) {
+    std::uint64_t hash = 0xcbf29ce484222325;
+    for (const auto byte : data) {
+        hash ^= static_cast<unsigned char>(byte);
+        hash *= 0x100000001b3;
+    }
+    return hash;
+}
+
+} // namespace Everest
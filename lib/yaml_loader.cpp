@@ -110,10 +110,13 @@ static std::string load_yaml_content(std::filesystem::path path) {
 namespace Everest {
 
 nlohmann::ordered_json load_yaml(const std::filesystem::path& path) {
+    return parse_yaml(load_yaml_content(path));
+}
+
+nlohmann::ordered_json parse_yaml(const std::string& content) {
     // FIXME (aw): using the static here this isn't a perfect solution
     static RymlCallbackInitializer ryml_callback_initializer;
 
-    const auto content = load_yaml_content(path);
     // FIXME (aw): using parse_in_place would be faster but that will need the file as a whole char buffer
     const auto tree = ryml::parse_in_arena(ryml::to_csubstr(content));
     return ryml_to_nlohmann_json(tree.rootref());
@@ -7,6 +7,7 @@
 #include <list>
 #include <map>
 #include <mutex>
+#include <optional>
 #include <thread>
 
 #include <cstdlib>
@@ -28,12 +29,15 @@
 #include <framework/everest.hpp>
 #include <framework/runtime.hpp>
 #include <utils/config.hpp>
+#include <utils/config_blob.hpp>
+#include <utils/embedded_broker.hpp>
 #include <utils/error/error_comm_bridge.hpp>
 #include <utils/error/error_database.hpp>
 #include <utils/error/error_database_map.hpp>
 #include <utils/error/error_manager.hpp>
 #include <utils/mqtt_abstraction.hpp>
 #include <utils/status_fifo.hpp>
+#include <utils/yaml_cache.hpp>
 
 #include "controller/ipc.hpp"
 #include "system_unix.hpp"
@@ -211,7 +215,7 @@ static void exec_module(std::shared_ptr<RuntimeSettings> rs, const ModuleStartIn
 }
 
 static std::map<pid_t, std::string> spawn_modules(const std::vector<ModuleStartInfo>& modules,
-                                                  std::shared_ptr<RuntimeSettings> rs) {
+                                                  const ConfigBlob* config_blob, std::shared_ptr<RuntimeSettings> rs) {
     std::map<pid_t, std::string> started_modules;
 
     for (const auto& module : modules) {
@@ -222,6 +226,9 @@ static std::map<pid_t, std::string> spawn_modules(const std::vector<ModuleStartI
             // first, check if we need any capabilities
 
             try {
+                if (config_blob != nullptr) {
+                    config_blob->pass_to_exec();
+                }
                 exec_module(rs, module, proc_handle);
             } catch (const std::exception& err) {
                 proc_handle.send_error_and_exit(err.what());
@@ -256,7 +263,7 @@ static std::map<pid_t, std::string> start_modules(Config& config, MQTTAbstractio
 
     std::vector<ModuleStartInfo> modules_to_spawn;
 
-    auto main_config = config.get_main_config();
+    const auto& main_config = config.get_main_config();
     modules_to_spawn.reserve(main_config.size());
 
     for (const auto& module : main_config.items()) {
@@ -288,7 +295,7 @@ static std::map<pid_t, std::string> start_modules(Config& config, MQTTAbstractio
 
         Handler module_ready_handler = [module_name, &mqtt_abstraction, standalone_modules,
                                         mqtt_everest_prefix = rs->mqtt_everest_prefix,
-                                        &status_fifo](nlohmann::json json) {
+                                        &status_fifo](const nlohmann::json& json) {
             EVLOG_debug << fmt::format("received module ready signal for module: {}({})", module_name, json.dump());
             std::unique_lock<std::mutex> lock(modules_ready_mutex);
             // FIXME (aw): here are race conditions, if the ready handler gets called while modules are shut down!
@@ -334,7 +341,7 @@ static std::map<pid_t, std::string> start_modules(Config& config, MQTTAbstractio
         for (auto& it_impl : config.get_manifests().at(module_type).at("provides").items()) {
             std::string impl_name = it_impl.key();
             std::string if_name = it_impl.value().at("interface");
-            auto if_def = config.get_interface_definition(if_name);
+            const auto& if_def = config.get_interface_definition(if_name);
             for (auto& it_err_list : if_def.at("errors")) {
                 for (auto& it_err : it_err_list) {
                     std::string err_namespace = it_err.at("namespace");
@@ -385,7 +392,16 @@ static std::map<pid_t, std::string> start_modules(Config& config, MQTTAbstractio
         }
     }
 
-    return spawn_modules(modules_to_spawn, rs);
+    // the modules inherit the already validated config when they are spawned and do not have to load all files again
+    std::optional<ConfigBlob> config_blob;
+    try {
+        config_blob.emplace(ConfigBlob::create(config));
+        EVLOG_debug << fmt::format("Serialized config for the modules into {} bytes", config_blob->get_size());
+    } catch (const std::exception& e) {
+        EVLOG_warning << fmt::format("Could not serialize the config, modules load all config files: {}", e.what());
+    }
+
+    return spawn_modules(modules_to_spawn, config_blob ? &*config_blob : nullptr, rs);
 }
 
 static void shutdown_modules(const std::map<pid_t, std::string>& modules, Config& config,
@@ -492,7 +508,7 @@ int boot(const po::variables_map& vm) {
     EVLOG_info << fmt::format(TERMINAL_STYLE_BLUE, " |______|   \\/ \\___|_|  \\___||___/\\__|");
     EVLOG_info << "";
 
-    EVLOG_info << "Using MQTT broker " << rs->mqtt_broker_host << ":" << rs->mqtt_broker_port;
+    EVLOG_info << "Using MQTT broker " << get_mqtt_broker_address(*rs);
     if (rs->telemetry_enabled) {
         EVLOG_info << "Telemetry enabled";
     }
@@ -526,6 +542,12 @@ int boot(const po::variables_map& vm) {
         return EXIT_SUCCESS;
     }
 
+    if (vm.count("rebuild-cache") != 0) {
+        // every file is parsed and validated again and stored in the emptied cache
+        const auto removed = YamlCache(rs->cache_dir).clear();
+        EVLOG_info << fmt::format("Removed {} entries from the config cache in {}", removed, rs->cache_dir.string());
+    }
+
     auto start_time = std::chrono::system_clock::now();
     std::unique_ptr<Config> config;
     try {
@@ -558,7 +580,7 @@ int boot(const po::variables_map& vm) {
 
         output_config_stream << config->get_main_config().dump(DUMP_INDENT);
 
-        auto manifests = config->get_manifests();
+        const auto& manifests = config->get_manifests();
 
         for (const auto& module : manifests.items()) {
             std::string filename = module.key() + ".json";
@@ -588,12 +610,34 @@ int boot(const po::variables_map& vm) {
     // create StatusFifo object
     auto status_fifo = StatusFifo::create_from_path(vm["status-fifo"].as<std::string>());
 
-    auto mqtt_abstraction = MQTTAbstraction(rs->mqtt_broker_host, std::to_string(rs->mqtt_broker_port),
-                                            rs->mqtt_everest_prefix, rs->mqtt_external_prefix);
+    // the embedded broker has to outlive the MQTT connection of the manager
+    std::unique_ptr<EmbeddedBroker> embedded_broker;
+    if (rs->mqtt_embedded_broker) {
+        std::unique_ptr<MQTTAbstraction> bridge;
+        if (rs->mqtt_embedded_broker_bridge) {
+            auto bridge_settings = get_mqtt_settings(*rs);
+            bridge_settings.broker_socket_path.clear();
+            bridge = std::make_unique<MQTTAbstraction>(bridge_settings);
+            if (!bridge->connect()) {
+                EVLOG_error << fmt::format("Cannot connect to MQTT broker at {}:{} for bridging", rs->mqtt_broker_host,
+                                           rs->mqtt_broker_port);
+                return EXIT_FAILURE;
+            }
+            bridge->spawn_main_loop_thread();
+        }
+
+        embedded_broker =
+            std::make_unique<EmbeddedBroker>(rs->mqtt_broker_socket_path, rs->mqtt_everest_prefix, std::move(bridge));
+        if (!embedded_broker->start()) {
+            EVLOG_error << "Cannot start the embedded MQTT broker";
+            return EXIT_FAILURE;
+        }
+    }
+
+    auto mqtt_abstraction = MQTTAbstraction(get_mqtt_settings(*rs));
 
     if (!mqtt_abstraction.connect()) {
-        EVLOG_error << fmt::format("Cannot connect to MQTT broker at {}:{}", rs->mqtt_broker_host,
-                                   rs->mqtt_broker_port);
+        EVLOG_error << fmt::format("Cannot connect to MQTT broker at {}", get_mqtt_broker_address(*rs));
         return EXIT_FAILURE;
     }
 
@@ -749,6 +793,7 @@ int main(int argc, char* argv[]) {
     desc.add_options()("config", po::value<std::string>(),
                        "Full path to a config file.  If the file does not exist and has no extension, it will be "
                        "looked up in the default config directory");
+    desc.add_options()("rebuild-cache", "Parse and validate all config files again instead of using the config cache");
     desc.add_options()("status-fifo", po::value<std::string>()->default_value(""),
                        "Path to a named pipe, that shall be used for status updates from the manager");
 
@@ -0,0 +1,36 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+
+#include <utils/backoff.hpp>
+
+using namespace std::chrono_literals;
+
+SCENARIO("Backoff delays grow exponentially up to a maximum", "[!throws]") {
+    GIVEN("A backoff starting at 100ms with a maximum of 1s") {
+        Everest::Backoff backoff(100ms, 1s);
+
+        WHEN("Attempts keep failing") {
+            THEN("Every delay is between half of and the full current delay") {
+                for (const auto full_delay : {100ms, 200ms, 400ms, 800ms, 1000ms, 1000ms}) {
+                    const auto delay = backoff.next();
+                    CHECK(delay >= full_delay / 2);
+                    CHECK(delay <= full_delay);
+                }
+            }
+        }
+
+        WHEN("It is reset") {
+            for (int i = 0; i < 10; i++) {
+                backoff.next();
+            }
+            backoff.reset();
+
+            THEN("It starts over with the initial delay") {
+                CHECK(backoff.next() <= 100ms);
+            }
+        }
+    }
+}
@@ -104,3 +104,17 @@ SCENARIO("Check Config Constructor", "[!throws]") {
         }
     }
 }
+
+SCENARIO("Config files are loaded in parallel", "[config]") {
+    std::string bin_dir = Everest::tests::get_bin_dir().string() + "/";
+    GIVEN("A config with 50 modules") {
+        std::shared_ptr<Everest::RuntimeSettings> rs = std::make_shared<Everest::RuntimeSettings>(
+            Everest::RuntimeSettings(bin_dir + "many_modules/", bin_dir + "many_modules/config.yaml"));
+        rs->config_cache = false;
+        const Everest::Config config(rs);
+        THEN("Every load gives the same config") {
+            CHECK(Everest::Config(rs).serialize() == config.serialize());
+            CHECK(config.get_interface_definition("test_errors").contains("errors"));
+        }
+    }
+}
@@ -0,0 +1,119 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <cstdlib>
+#include <memory>
+#include <string>
+
+#include <sys/mman.h>
+#include <unistd.h>
+
+#include <framework/runtime.hpp>
+#include <tests/helpers.hpp>
+#include <utils/config.hpp>
+#include <utils/config_blob.hpp>
+
+namespace {
+std::shared_ptr<Everest::RuntimeSettings> many_modules_settings() {
+    const std::string bin_dir = Everest::tests::get_bin_dir().string() + "/";
+    return std::make_shared<Everest::RuntimeSettings>(bin_dir + "many_modules/", bin_dir + "many_modules/config.yaml");
+}
+} // namespace
+
+SCENARIO("A config is passed to modules in a config blob", "[config_blob]") {
+    GIVEN("A config with 50 modules loaded from the config files") {
+        const auto rs = many_modules_settings();
+        Everest::Config config(rs);
+        const auto blob = Everest::ConfigBlob::create(config);
+
+        THEN("The blob contains the serialized config") {
+            const auto opened = Everest::ConfigBlob::open(dup(blob.get_fd()));
+            const auto serialized = config.serialize();
+            CHECK(opened.get_size() == serialized.size());
+            CHECK(opened.get_data() ==
+                  std::string_view(reinterpret_cast<const char*>(serialized.data()), serialized.size()));
+        }
+
+        THEN("A config created from the blob equals the loaded config") {
+            const auto opened = Everest::ConfigBlob::open(dup(blob.get_fd()));
+            Everest::Config loaded(rs, opened.get_data());
+            CHECK(loaded.get_main_config() == config.get_main_config());
+            CHECK(loaded.get_manifests() == config.get_manifests());
+            CHECK(loaded.get_interfaces() == config.get_interfaces());
+            CHECK(loaded.get_interface_definition("test_errors") == config.get_interface_definition("test_errors"));
+            CHECK(loaded.get_module_name("module_7") == "TESTErrorModule");
+            CHECK(loaded.module_provides("TESTErrorModule", "main"));
+            CHECK(loaded.get_module_cmds("TESTErrorModule", "main") ==
+                  config.get_module_cmds("TESTErrorModule", "main"));
+            CHECK(loaded.resolve_requirement("module_7", "next") == config.resolve_requirement("module_7", "next"));
+            CHECK(loaded.get_telemetry_config("module_7").has_value() ==
+                  config.get_telemetry_config("module_7").has_value());
+            CHECK(loaded.get_error_map().get_error_types() == config.get_error_map().get_error_types());
+            CHECK(loaded.serialize() == config.serialize());
+        }
+
+        THEN("A module loads its config from the blob passed by the manager") {
+            setenv(Everest::CONFIG_BLOB_FD_ENV, std::to_string(dup(blob.get_fd())).c_str(), 1);
+            const auto loaded = Everest::load_module_config(rs);
+            CHECK(loaded.get_main_config() == config.get_main_config());
+            CHECK(std::getenv(Everest::CONFIG_BLOB_FD_ENV) == nullptr);
+        }
+
+        THEN("A module loads all config files if the blob cannot be used") {
+            setenv(Everest::CONFIG_BLOB_FD_ENV, "invalid", 1);
+            const auto loaded = Everest::load_module_config(rs);
+            CHECK(loaded.get_main_config() == config.get_main_config());
+        }
+    }
+
+    GIVEN("A config blob that was created from another config file") {
+        const auto rs = many_modules_settings();
+        const Everest::Config config(rs);
+        const auto serialized = config.serialize();
+        auto other_rs = std::make_shared<Everest::RuntimeSettings>(*rs);
+        other_rs->config_file = other_rs->config_file.parent_path() / "other.yaml";
+
+        THEN("It is rejected") {
+            const std::string_view blob(reinterpret_cast<const char*>(serialized.data()), serialized.size());
+            CHECK_THROWS(Everest::Config(other_rs, blob));
+            CHECK_THROWS(Everest::Config(rs, blob.substr(0, blob.size() / 2)));
+        }
+    }
+
+    GIVEN("A memfd that is not sealed") {
+        const int fd = memfd_create("test", 0);
+        REQUIRE(fd != -1);
+        REQUIRE(write(fd, "data", 4) == 4);
+
+        THEN("It is not accepted as config blob") {
+            CHECK_THROWS(Everest::ConfigBlob::open(fd));
+        }
+    }
+}
+
+TEST_CASE("Config blob module startup benchmark", "[.][benchmark]") {
+    // every module of a config loads the config once when it is started
+    constexpr int modules = 50;
+    const auto rs = many_modules_settings();
+    const Everest::Config config(rs);
+    const auto blob = Everest::ConfigBlob::create(config);
+    const auto opened = Everest::ConfigBlob::open(dup(blob.get_fd()));
+    WARN("Config blob size: " << blob.get_size() << " bytes");
+
+    BENCHMARK("load the config of 50 modules from the config files") {
+        for (int i = 0; i < modules - 1; i++) {
+            Everest::Config module_config(rs);
+        }
+        return Everest::Config(rs);
+    };
+
+    BENCHMARK("serialize the config once and load it from the blob in 50 modules") {
+        const auto module_blob = Everest::ConfigBlob::create(config);
+        for (int i = 0; i < modules - 1; i++) {
+            const auto module_opened = Everest::ConfigBlob::open(dup(module_blob.get_fd()));
+            Everest::Config module_config(rs, module_opened.get_data());
+        }
+        return Everest::Config(rs, opened.get_data());
+    };
+}
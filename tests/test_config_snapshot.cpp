@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include <framework/everest.hpp>
+#include <framework/runtime.hpp>
+#include <tests/helpers.hpp>
+#include <utils/config.hpp>
+#include <utils/config_snapshot.hpp>
+
+namespace {
+std::shared_ptr<Everest::RuntimeSettings> many_modules_settings() {
+    const std::string bin_dir = Everest::tests::get_bin_dir().string() + "/";
+    return std::make_shared<Everest::RuntimeSettings>(bin_dir + "many_modules/", bin_dir + "many_modules/config.yaml");
+}
+} // namespace
+
+SCENARIO("A config snapshot indexes the modules of a config", "[config_snapshot]") {
+    GIVEN("A config with 50 modules") {
+        Everest::Config config(many_modules_settings());
+        const Everest::ConfigSnapshot snapshot(config);
+
+        THEN("The config returns references instead of copies") {
+            CHECK(&config.get_main_config() == &config.get_main_config());
+            CHECK(&config.get_interfaces() == &config.get_interfaces());
+            CHECK(&config.get_interface_definition("test_errors") == &config.get_interface_definition("test_errors"));
+            CHECK(config.get_interface_definition("unknown").is_null());
+        }
+
+        THEN("All modules are found ordered by their id") {
+            REQUIRE(snapshot.get_modules().size() == 50);
+            CHECK(snapshot.get_modules().front()->module_id == "module_1");
+            CHECK(snapshot.get_main_config() == config.get_main_config());
+            CHECK(snapshot.find_module("unknown") == nullptr);
+
+            const auto* module = snapshot.find_module("module_7");
+            REQUIRE(module != nullptr);
+            CHECK(module->module_name == "TESTErrorModule");
+            CHECK(module->identifier == config.printable_identifier("module_7"));
+            CHECK(module->mqtt_prefix == config.mqtt_module_prefix("module_7"));
+            CHECK(module->manifest->at("enable_global_errors") == true);
+        }
+
+        THEN("Implementations are indexed with their interfaces") {
+            const auto* implementation = snapshot.find_implementation("module_7", "main");
+            REQUIRE(implementation != nullptr);
+            CHECK(implementation->interface_name == "test_errors");
+            CHECK(implementation->identifier == config.printable_identifier("module_7", "main"));
+            CHECK(implementation->mqtt_prefix == config.mqtt_prefix("module_7", "main"));
+            CHECK(implementation->interface->contains("cmds"));
+            CHECK(implementation->interface_definition->at("errors").at("test_errors").size() == 20);
+            CHECK(implementation->interface_definition == snapshot.find_interface_definition("test_errors"));
+            CHECK(snapshot.find_implementation("module_7", "unknown") == nullptr);
+            CHECK(snapshot.find_interface_definition("unknown") == nullptr);
+        }
+    }
+}
+
+TEST_CASE("Config snapshot and module init benchmark", "[.][benchmark]") {
+    const auto rs = many_modules_settings();
+    const Everest::Config config(rs);
+    const auto make_everest = [&config]() {
+        return std::make_unique<Everest::Everest>("module_1", config,
+                                                  Everest::SchemaValidationSettings{Everest::SchemaValidationMode::Full},
+                                                  Everest::MQTTSettings{}, "everest/telemetry/", false);
+    };
+
+    BENCHMARK("load a config with 50 modules") {
+        return Everest::Config(rs);
+    };
+
+    BENCHMARK("create a snapshot") {
+        return std::make_shared<const Everest::ConfigSnapshot>(config);
+    };
+
+    BENCHMARK("initialize the framework of a module") {
+        return make_everest();
+    };
+
+    BENCHMARK_ADVANCED("subscribe to all errors of 50 modules")(Catch::Benchmark::Chronometer meter) {
+        std::vector<std::unique_ptr<Everest::Everest>> instances;
+        for (int i = 0; i < meter.runs(); i++) {
+            instances.push_back(make_everest());
+        }
+        meter.measure([&instances](int i) { instances.at(i)->subscribe_all_errors([](const json&) {}); });
+    };
+}
@@ -0,0 +1,38 @@
+set(SETUP_NAME "many_modules")
+set(PREFIX_DIR ${CMAKE_CURRENT_BINARY_DIR}/${SETUP_NAME})
+
+# a ring of 50 modules, each one requires the implementation of the next one
+set(MODULE_COUNT 50)
+set(CONFIG_CONTENT "active_modules:\n")
+foreach(MODULE_INDEX RANGE 1 ${MODULE_COUNT})
+    math(EXPR NEXT_MODULE_INDEX "${MODULE_INDEX} % ${MODULE_COUNT} + 1")
+    string(APPEND CONFIG_CONTENT
+        "  module_${MODULE_INDEX}:\n"
+        "    module: \"TESTErrorModule\"\n"
+        "    connections:\n"
+        "      next:\n"
+        "        - module_id: \"module_${NEXT_MODULE_INDEX}\"\n"
+        "          implementation_id: \"main\"\n"
+    )
+endforeach()
+string(APPEND CONFIG_CONTENT
+    "settings:\n"
+    "  interfaces_dir: \"interfaces\"\n"
+    "  modules_dir: \"modules\"\n"
+    "  types_dir: \"types\"\n"
+    "  errors_dir: \"errors\"\n"
+    "  schemas_dir: \"schemas\"\n"
+    "  www_dir: \"www\"\n"
+    "  logging_config_file: \"logging.ini\"\n"
+)
+file(WRITE ${PREFIX_DIR}/config.yaml "${CONFIG_CONTENT}")
+
+configure_file(test_logging.ini ${SETUP_NAME}/logging.ini COPYONLY)
+file(COPY ../schemas/ DESTINATION ${SETUP_NAME}/schemas)
+file(COPY test_modules/TESTErrorModule DESTINATION ${SETUP_NAME}/modules)
+file(COPY test_interfaces/test_errors.yaml DESTINATION ${SETUP_NAME}/interfaces)
+file(COPY test_errors/test_errors.yaml DESTINATION ${SETUP_NAME}/errors)
+file(MAKE_DIRECTORY "${PREFIX_DIR}/types")
+file(MAKE_DIRECTORY "${PREFIX_DIR}/www")
+file(MAKE_DIRECTORY "${PREFIX_DIR}/etc/everest")
+file(MAKE_DIRECTORY "${PREFIX_DIR}/share/everest")
@@ -0,0 +1,301 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/socket.h>
+#include <sys/stat.h>
+#include <sys/un.h>
+#include <unistd.h>
+
+#include <utils/embedded_broker.hpp>
+#include <utils/mqtt_abstraction.hpp>
+
+using namespace std::chrono_literals;
+using namespace std::string_literals;
+
+namespace {
+Everest::MQTTSettings client_settings(const std::string& socket_path) {
+    Everest::MQTTSettings settings;
+    settings.broker_socket_path = socket_path;
+    settings.everest_prefix = "everest/";
+    return settings;
+}
+
+/// \brief A module connected to the embedded broker, collecting the topics and payloads of all messages it receives
+class TestClient {
+public:
+    explicit TestClient(const std::string& socket_path) : mqtt(client_settings(socket_path)) {
+    }
+
+    bool connect() {
+        if (!this->mqtt.connect()) {
+            return false;
+        }
+        this->mqtt.spawn_main_loop_thread();
+        return true;
+    }
+
+    Token subscribe(const std::string& topic) {
+        auto token = std::make_shared<TypedHandler>(
+            HandlerType::ExternalMQTTWithTopic, std::make_shared<Handler>([this](const json& data) {
+                const std::lock_guard<std::mutex> lock(this->mutex);
+                this->topics.push_back(data.at("topic").get<std::string>());
+                this->received.push_back(data.at("payload").get<std::string>());
+                this->cv.notify_all();
+            }));
+        this->mqtt.register_handler(topic, token, QOS::QOS0);
+        return token;
+    }
+
+    std::vector<std::string> wait_for_messages(size_t count) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        this->cv.wait_for(lock, 5s, [this, count]() { return this->received.size() >= count; });
+        return this->received;
+    }
+
+    std::vector<std::string> get_topics() {
+        const std::lock_guard<std::mutex> lock(this->mutex);
+        return this->topics;
+    }
+
+    Everest::MQTTAbstraction mqtt;
+
+private:
+    std::mutex mutex;
+    std::condition_variable cv;
+    std::vector<std::string> received;
+    std::vector<std::string> topics;
+};
+
+bool wait_for_subscriptions(const Everest::EmbeddedBroker& broker, uint64_t subscriptions) {
+    for (int i = 0; i < 500; i++) {
+        if (broker.get_statistics().subscriptions == subscriptions) {
+            return true;
+        }
+        std::this_thread::sleep_for(10ms);
+    }
+    return false;
+}
+
+/// \brief A client speaking MQTT on the socket itself, to check the packets sent by the broker
+class RawClient {
+public:
+    explicit RawClient(const std::string& socket_path) {
+        this->fd = socket(AF_UNIX, SOCK_STREAM, 0);
+        struct sockaddr_un addr = {};
+        addr.sun_family = AF_UNIX;
+        socket_path.copy(addr.sun_path, sizeof(addr.sun_path) - 1);
+        // NOLINTNEXTLINE(cppcoreguidelines-pro-type-reinterpret-cast): sockaddr_un has to be passed as sockaddr
+        connect(this->fd, reinterpret_cast<struct sockaddr*>(&addr), sizeof(addr));
+        // CONNECT with a clean session, keep alive 60s and client id "raw"
+        this->send("\x10\x0f\x00\x04MQTT\x04\x02\x00\x3c\x00\x03raw"s);
+        this->receive();
+    }
+
+    ~RawClient() {
+        close(this->fd);
+    }
+
+    RawClient(const RawClient&) = delete;
+    RawClient& operator=(const RawClient&) = delete;
+
+    void send(const std::string& packet) {
+        ::send(this->fd, packet.data(), packet.size(), MSG_NOSIGNAL);
+    }
+
+    /// \returns the next packet, with its fixed header, all packets used in the tests are shorter than 128 bytes
+    std::string receive() {
+        std::string packet(2, '\0');
+        if (recv(this->fd, packet.data(), 2, MSG_WAITALL) != 2) {
+            return {};
+        }
+        packet.resize(2 + static_cast<uint8_t>(packet.at(1)));
+        recv(this->fd, packet.data() + 2, packet.size() - 2, MSG_WAITALL);
+        return packet;
+    }
+
+private:
+    int fd{-1};
+};
+} // namespace
+
+TEST_CASE("Embedded broker routes messages between its clients", "[embedded_broker]") {
+    const auto socket_path = (std::filesystem::temp_directory_path() / "everest_embedded_broker_test.sock").string();
+    Everest::EmbeddedBroker broker(socket_path, "everest/");
+    REQUIRE(broker.start());
+
+    TestClient publisher(socket_path);
+    TestClient subscriber(socket_path);
+    REQUIRE(publisher.connect());
+    REQUIRE(subscriber.connect());
+
+    SECTION("Wildcard subscriptions") {
+        subscriber.subscribe("external/+/value");
+        REQUIRE(wait_for_subscriptions(broker, 1));
+
+        publisher.mqtt.publish("external/a/value", "1"s, QOS::QOS0);
+        publisher.mqtt.publish("external/a/other", "2"s, QOS::QOS1);
+        publisher.mqtt.publish("external/b/value", "3"s, QOS::QOS2);
+
+        // messages of a client are routed in order, so "2" would have arrived before "3"
+        CHECK(subscriber.wait_for_messages(2) == std::vector<std::string>{"1", "3"});
+        CHECK(subscriber.get_topics() == std::vector<std::string>{"external/a/value", "external/b/value"});
+        CHECK(broker.get_statistics().messages_received == 3);
+        CHECK(broker.get_statistics().messages_delivered == 2);
+    }
+
+    SECTION("Overlapping subscriptions deliver a message once") {
+        subscriber.subscribe("external/#");
+        subscriber.subscribe("external/+/value");
+        REQUIRE(wait_for_subscriptions(broker, 2));
+
+        publisher.mqtt.publish("external/a/value", "1"s, QOS::QOS0);
+        publisher.mqtt.publish("external/done", "2"s, QOS::QOS0);
+
+        CHECK(subscriber.wait_for_messages(2) == std::vector<std::string>{"1", "2"});
+        CHECK(broker.get_statistics().messages_delivered == 2);
+    }
+
+    SECTION("Unsubscribed topics are no longer delivered") {
+        const auto token = subscriber.subscribe("external/value");
+        subscriber.subscribe("external/done");
+        REQUIRE(wait_for_subscriptions(broker, 2));
+        subscriber.mqtt.unregister_handler("external/value", token);
+        REQUIRE(wait_for_subscriptions(broker, 1));
+
+        publisher.mqtt.publish("external/value", "1"s, QOS::QOS0);
+        publisher.mqtt.publish("external/done", "2"s, QOS::QOS0);
+
+        CHECK(subscriber.wait_for_messages(1) == std::vector<std::string>{"2"});
+    }
+
+    SECTION("Clients disconnecting remove their subscriptions") {
+        subscriber.subscribe("external/value");
+        REQUIRE(wait_for_subscriptions(broker, 1));
+        subscriber.mqtt.disconnect();
+
+        REQUIRE(wait_for_subscriptions(broker, 0));
+        CHECK(broker.get_statistics().clients == 1);
+        CHECK(broker.get_statistics().clients_dropped == 0);
+    }
+}
+
+TEST_CASE("Embedded broker bridges wildcard subscriptions to an external broker", "[embedded_broker]") {
+    const auto temp_dir = std::filesystem::temp_directory_path();
+    const auto external_socket_path = (temp_dir / "everest_embedded_broker_external.sock").string();
+    const auto socket_path = (temp_dir / "everest_embedded_broker_bridged.sock").string();
+    Everest::EmbeddedBroker external_broker(external_socket_path, "everest/");
+    REQUIRE(external_broker.start());
+
+    auto bridge = std::make_unique<Everest::MQTTAbstraction>(client_settings(external_socket_path));
+    REQUIRE(bridge->connect());
+    bridge->spawn_main_loop_thread();
+    Everest::EmbeddedBroker broker(socket_path, "everest/", std::move(bridge));
+    REQUIRE(broker.start());
+
+    TestClient external_publisher(external_socket_path);
+    TestClient subscriber(socket_path);
+    REQUIRE(external_publisher.connect());
+    REQUIRE(subscriber.connect());
+
+    subscriber.subscribe("external/+/state");
+    subscriber.subscribe("external/#");
+    REQUIRE(wait_for_subscriptions(external_broker, 2));
+
+    external_publisher.mqtt.publish("external/a/state", "1"s, QOS::QOS0);
+    external_publisher.mqtt.publish("external/done", "2"s, QOS::QOS0);
+
+    // bridged messages keep their topic and reach a client once, even if several of its subscriptions match
+    CHECK(subscriber.wait_for_messages(2) == std::vector<std::string>{"1", "2"});
+    CHECK(subscriber.get_topics() == std::vector<std::string>{"external/a/state", "external/done"});
+    CHECK(broker.get_statistics().messages_bridged == 2);
+}
+
+TEST_CASE("Embedded broker replaces a stale socket file", "[embedded_broker]") {
+    const auto socket_path = (std::filesystem::temp_directory_path() / "everest_embedded_broker_stale.sock").string();
+    {
+        Everest::EmbeddedBroker broker(socket_path, "everest/");
+        REQUIRE(broker.start());
+    }
+    CHECK_FALSE(std::filesystem::exists(socket_path));
+
+    std::ofstream(socket_path) << "stale";
+    Everest::EmbeddedBroker broker(socket_path, "everest/");
+    CHECK(broker.start());
+}
+
+TEST_CASE("Embedded broker delivers messages with the QoS granted to the subscriber", "[embedded_broker]") {
+    const auto socket_path = (std::filesystem::temp_directory_path() / "everest_embedded_broker_qos.sock").string();
+    Everest::EmbeddedBroker broker(socket_path, "everest/");
+    REQUIRE(broker.start());
+    RawClient publisher(socket_path);
+    RawClient subscriber(socket_path);
+
+    // SUBSCRIBE with packet id 1 to "a" with QoS 1 and "b" with QoS 0
+    subscriber.send("\x82\x0a\x00\x01\x00\x01" "a\x01\x00\x01" "b\x00"s);
+    CHECK(subscriber.receive() == "\x90\x04\x00\x01\x01\x00"s);
+
+    SECTION("Messages are delivered with at most the granted QoS and have to be acknowledged") {
+        // PUBLISH "1" to "a" with QoS 2 and packet id 7
+        publisher.send("\x34\x06\x00\x01" "a\x00\x07" "1"s);
+        CHECK(subscriber.receive() == "\x32\x06\x00\x01" "a\x00\x01" "1"s);
+        // PUBLISH "2" to "b" with QoS 1 and packet id 8
+        publisher.send("\x32\x06\x00\x01" "b\x00\x08" "2"s);
+        CHECK(subscriber.receive() == "\x30\x04\x00\x01" "b2"s);
+
+        // PUBACK of the first message
+        subscriber.send("\x40\x02\x00\x01"s);
+        publisher.send("\x30\x04\x00\x01" "a3"s);
+        CHECK(subscriber.receive() == "\x30\x04\x00\x01" "a3"s);
+        CHECK(broker.get_statistics().messages_retransmitted == 0);
+    }
+
+    SECTION("Subscribing again replaces the granted QoS") {
+        subscriber.send("\x82\x06\x00\x02\x00\x01" "a\x00"s);
+        CHECK(subscriber.receive() == "\x90\x03\x00\x02\x00"s);
+        publisher.send("\x32\x06\x00\x01" "a\x00\x07" "1"s);
+        CHECK(subscriber.receive() == "\x30\x04\x00\x01" "a1"s);
+    }
+
+    SECTION("A QoS that does not exist is refused") {
+        subscriber.send("\x82\x06\x00\x02\x00\x01" "c\x03"s);
+        CHECK(subscriber.receive() == "\x90\x03\x00\x02\x80"s);
+        CHECK(broker.get_statistics().subscriptions == 2);
+    }
+}
+
+TEST_CASE("Embedded broker socket is only accessible by its user and group", "[embedded_broker]") {
+    const auto directory = std::filesystem::temp_directory_path() / "everest_embedded_broker_private";
+    std::filesystem::remove_all(directory);
+    const auto socket_path = (directory / "mqtt.sock").string();
+
+    SECTION("The directory of the socket is created") {
+        Everest::EmbeddedBroker broker(socket_path, "everest/");
+        REQUIRE(broker.start());
+
+        struct stat directory_stat = {};
+        REQUIRE(stat(directory.c_str(), &directory_stat) == 0);
+        CHECK((directory_stat.st_mode & 0777) == 0750);
+        struct stat socket_stat = {};
+        REQUIRE(stat(socket_path.c_str(), &socket_stat) == 0);
+        CHECK((socket_stat.st_mode & 0777) == 0660);
+    }
+
+    SECTION("A directory other users can write to is refused") {
+        std::filesystem::create_directory(directory);
+        std::filesystem::permissions(directory, std::filesystem::perms::all);
+        Everest::EmbeddedBroker broker(socket_path, "everest/");
+        CHECK_FALSE(broker.start());
+    }
+    std::filesystem::remove_all(directory);
+}
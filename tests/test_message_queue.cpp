@@ -0,0 +1,287 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <utils/message_queue.hpp>
+#include <utils/var_coalescer.hpp>
+
+SCENARIO("Message pool reuses released message buffers", "[!throws]") {
+    GIVEN("A message pool") {
+        Everest::MessagePool pool(2);
+        const std::string payload(1024, 'x');
+
+        THEN("The first message needs fresh buffers") {
+            const auto message = pool.acquire("everest/module/impl/var", payload);
+            CHECK(message->topic == "everest/module/impl/var");
+            CHECK(message->payload == payload);
+            CHECK(pool.get_reuses() == 0);
+            CHECK(pool.get_allocations() > 1);
+        }
+
+        THEN("Released messages are reused without growing their buffers") {
+            pool.acquire("everest/module/impl/var", payload).reset();
+            const auto allocations = pool.get_allocations();
+
+            const auto message = pool.acquire("everest/module/impl/cmd", "{}");
+            CHECK(message->topic == "everest/module/impl/cmd");
+            CHECK(message->payload == "{}");
+            CHECK(pool.get_reuses() == 1);
+            // only the reference count needs to be allocated
+            CHECK(pool.get_allocations() == allocations + 1);
+        }
+
+        THEN("Messages stay valid while references exist") {
+            auto first = pool.acquire("a", "first");
+            auto second = pool.acquire("b", "second");
+            const auto copy = first;
+            first.reset();
+            CHECK(copy->payload == "first");
+            CHECK(second->payload == "second");
+            CHECK(pool.get_reuses() == 0);
+        }
+    }
+}
+
+namespace {
+// message queue whose callback can be held back to fill up the queue deterministically
+struct HeldMessageQueue {
+    std::mutex mutex;
+    std::condition_variable cv;
+    bool released = false;
+    std::vector<std::string> received;
+    Everest::MessageQueue queue;
+
+    HeldMessageQueue(size_t capacity, Everest::MessageQueueOverflowPolicy overflow_policy) :
+        queue(
+            [this](std::shared_ptr<Everest::Message> message) {
+                std::unique_lock<std::mutex> lock(this->mutex);
+                this->received.push_back(message->payload);
+                this->cv.notify_all();
+                this->cv.wait(lock, [this]() { return this->released; });
+            },
+            capacity, overflow_policy) {
+    }
+
+    bool wait_for_received(size_t count) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        return this->cv.wait_for(lock, std::chrono::seconds(10), [&]() { return this->received.size() >= count; });
+    }
+
+    void release() {
+        std::lock_guard<std::mutex> lock(this->mutex);
+        this->released = true;
+        this->cv.notify_all();
+    }
+};
+
+std::shared_ptr<Everest::Message> make_message(const std::string& payload) {
+    return std::make_shared<Everest::Message>("topic", payload);
+}
+} // namespace
+
+SCENARIO("Message queue delivers messages in order and applies its overflow policy", "[!throws]") {
+    GIVEN("A small message queue that drops the newest messages") {
+        HeldMessageQueue held(2, Everest::MessageQueueOverflowPolicy::DropNewest);
+        held.queue.add(make_message("0"));
+        REQUIRE(held.wait_for_received(1));
+
+        WHEN("More messages are added than fit into the queue") {
+            for (int i = 1; i <= 4; i++) {
+                held.queue.add(make_message(std::to_string(i)));
+            }
+            held.release();
+
+            THEN("The newest messages are dropped and counted") {
+                REQUIRE(held.wait_for_received(3));
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                const std::lock_guard<std::mutex> lock(held.mutex);
+                CHECK(held.received == std::vector<std::string>{"0", "1", "2"});
+                CHECK(held.queue.get_dropped() == 2);
+            }
+        }
+    }
+
+    GIVEN("A small message queue that drops the oldest messages") {
+        HeldMessageQueue held(2, Everest::MessageQueueOverflowPolicy::DropOldest);
+        held.queue.add(make_message("0"));
+        REQUIRE(held.wait_for_received(1));
+
+        WHEN("More messages are added than fit into the queue") {
+            for (int i = 1; i <= 4; i++) {
+                held.queue.add(make_message(std::to_string(i)));
+            }
+            held.release();
+
+            THEN("The oldest messages are dropped and counted") {
+                REQUIRE(held.wait_for_received(3));
+                std::this_thread::sleep_for(std::chrono::milliseconds(50));
+                const std::lock_guard<std::mutex> lock(held.mutex);
+                CHECK(held.received == std::vector<std::string>{"0", "3", "4"});
+                CHECK(held.queue.get_dropped() == 2);
+            }
+        }
+    }
+
+    GIVEN("A small message queue that blocks when it is full") {
+        HeldMessageQueue held(2, Everest::MessageQueueOverflowPolicy::Block);
+        held.release();
+
+        WHEN("Many more messages are added than fit into the queue") {
+            constexpr size_t number_of_messages = 10000;
+            for (size_t i = 0; i < number_of_messages; i++) {
+                held.queue.add(make_message(std::to_string(i)));
+            }
+
+            THEN("All messages are delivered in order") {
+                REQUIRE(held.wait_for_received(number_of_messages));
+                const std::lock_guard<std::mutex> lock(held.mutex);
+                for (size_t i = 0; i < number_of_messages; i++) {
+                    CHECK(held.received.at(i) == std::to_string(i));
+                }
+                CHECK(held.queue.get_dropped() == 0);
+            }
+        }
+    }
+}
+
+namespace {
+json make_result(const std::string& name, const std::string& id) {
+    return json::object({{"name", name}, {"type", "result"}, {"data", json::object({{"id", id}, {"retval", id}})}});
+}
+} // namespace
+
+SCENARIO("Message handlers route results to result handlers", "[!throws]") {
+    GIVEN("A message handler with a result handler for one call and one for all results") {
+        std::vector<std::string> call_results;
+        std::vector<std::string> all_results;
+
+        // results are delivered directly, the thread pool is never used
+        Everest::ThreadPool thread_pool(1);
+        Everest::MessageHandler message_handler(thread_pool);
+        message_handler.add_handler(std::make_shared<TypedHandler>(
+            "cmd", "call_1", HandlerType::Result,
+            std::make_shared<Handler>([&](const json& data) { call_results.push_back(data.at("id")); })));
+        message_handler.add_handler(std::make_shared<TypedHandler>(
+            HandlerType::Result,
+            std::make_shared<Handler>([&](const json& data) { all_results.push_back(data.at("id")); })));
+
+        WHEN("Results arrive") {
+            message_handler.add(std::make_shared<const json>(make_result("cmd", "call_1")));
+            message_handler.add(std::make_shared<const json>(make_result("cmd", "call_2")));
+            message_handler.add(std::make_shared<const json>(make_result("other_cmd", "call_3")));
+
+            THEN("Results are delivered directly to the matching handlers") {
+                CHECK(call_results == std::vector<std::string>{"call_1"});
+                CHECK(all_results == std::vector<std::string>{"call_1", "call_2", "call_3"});
+            }
+        }
+    }
+}
+
+SCENARIO("Message handlers only deliver results directly to result handlers", "[!throws]") {
+    GIVEN("A message handler with an external handler") {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::thread::id> threads;
+
+        Everest::ThreadPool thread_pool(1);
+        Everest::MessageHandler message_handler(thread_pool);
+        message_handler.add_handler(std::make_shared<TypedHandler>(
+            HandlerType::ExternalMQTT, std::make_shared<Handler>([&](const json&) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                threads.push_back(std::this_thread::get_id());
+                cv.notify_all();
+            })));
+
+        WHEN("A payload that looks like a result arrives") {
+            message_handler.add(std::make_shared<const json>(make_result("cmd", "call_1")));
+
+            THEN("It is delivered on the thread pool like any other message") {
+                std::unique_lock<std::mutex> lock(mutex);
+                REQUIRE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return threads.size() == 1; }));
+                CHECK(threads.front() != std::this_thread::get_id());
+            }
+        }
+    }
+}
+
+SCENARIO("Message handlers unpack var batches", "[!throws]") {
+    GIVEN("A message handler with subscribers of two vars") {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::string> received;
+
+        Everest::ThreadPool thread_pool(2);
+        Everest::MessageHandler message_handler(thread_pool);
+        for (const auto& var_name : {"power", "limit"}) {
+            message_handler.add_handler(std::make_shared<TypedHandler>(
+                var_name, HandlerType::SubscribeVar, std::make_shared<Handler>([&, var_name](const json& data) {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    received.push_back(fmt::format("{}={}", var_name, data.dump()));
+                    cv.notify_all();
+                })));
+        }
+
+        WHEN("A plain var and a batch of vars arrive") {
+            message_handler.add(std::make_shared<const json>(Everest::make_var_message({{"power", 1}})));
+            message_handler.add(std::make_shared<const json>(
+                Everest::make_var_message({{"power", 2}, {"unknown", 0}, {"limit", 3}, {"power", 4}})));
+
+            THEN("Every subscriber receives its vars in the order they were published") {
+                std::unique_lock<std::mutex> lock(mutex);
+                REQUIRE(cv.wait_for(lock, std::chrono::seconds(10), [&]() { return received.size() == 4; }));
+                std::vector<std::string> power;
+                std::vector<std::string> limit;
+                for (const auto& var : received) {
+                    (var.rfind("power", 0) == 0 ? power : limit).push_back(var);
+                }
+                CHECK(power == std::vector<std::string>{"power=1", "power=2", "power=4"});
+                CHECK(limit == std::vector<std::string>{"limit=3"});
+            }
+        }
+    }
+}
+
+TEST_CASE("Result routing benchmark", "[.][benchmark]") {
+    constexpr size_t pending_calls = 256;
+    Everest::ThreadPool thread_pool(1);
+    const auto result = std::make_shared<const json>(make_result("cmd", fmt::format("call_{}", pending_calls / 2)));
+
+    // one result handler per pending call, like call_cmd used to register them
+    Everest::MessageHandler per_call_handlers(thread_pool);
+    for (size_t i = 0; i < pending_calls; i++) {
+        per_call_handlers.add_handler(std::make_shared<TypedHandler>(
+            "cmd", fmt::format("call_{}", i), HandlerType::Result, std::make_shared<Handler>([](const json&) {})));
+    }
+
+    // one result handler routing to a table of pending calls
+    std::unordered_map<std::string, size_t> pending;
+    for (size_t i = 0; i < pending_calls; i++) {
+        pending.emplace(fmt::format("call_{}", i), i);
+    }
+    size_t routed = 0;
+    Everest::MessageHandler routing_handler(thread_pool);
+    routing_handler.add_handler(std::make_shared<TypedHandler>(
+        HandlerType::Result, std::make_shared<Handler>([&](const json& data) {
+            routed += pending.count(data.at("id").get_ref<const std::string&>());
+        })));
+
+    BENCHMARK("one result handler per pending call") {
+        per_call_handlers.add(result);
+    };
+
+    BENCHMARK("one result router") {
+        routing_handler.add(result);
+        return routed;
+    };
+}
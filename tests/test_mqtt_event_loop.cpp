@@ -0,0 +1,70 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <ctime>
+
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <utils/mqtt_event_loop.hpp>
+
+SCENARIO("The MQTT main loop only wakes up for events", "[mqtt_event_loop]") {
+    GIVEN("An event loop watching a socket and an eventfd") {
+        Everest::MQTTEventLoop event_loop;
+        const int notify_fd = eventfd(0, 0);
+        int sockets[2] = {-1, -1};
+        REQUIRE(socketpair(AF_UNIX, SOCK_STREAM, 0, sockets) == 0);
+        event_loop.watch_notify_fd(notify_fd);
+        event_loop.watch_socket(sockets[0]);
+
+        // an idle client without queued messages, that just sent something
+        struct mqtt_client client = {};
+        client.keep_alive = 400;
+        client.time_of_last_send = time(nullptr);
+
+        WHEN("Something was queued for sending") {
+            event_loop.schedule(client, 5);
+            eventfd_write(notify_fd, 1);
+
+            THEN("The loop wakes up to sync") {
+                CHECK(event_loop.wait());
+                CHECK(event_loop.get_statistics().notify_wakeups == 1);
+            }
+        }
+
+        WHEN("Data arrives from the broker") {
+            event_loop.schedule(client, 5);
+            REQUIRE(write(sockets[1], "x", 1) == 1);
+
+            THEN("The loop wakes up to sync") {
+                CHECK(event_loop.wait());
+                CHECK(event_loop.get_statistics().socket_wakeups == 1);
+            }
+        }
+
+        WHEN("The keep-alive deadline is reached") {
+            client.keep_alive = 0;
+            event_loop.schedule(client, 5);
+
+            THEN("The loop wakes up to sync") {
+                CHECK(event_loop.wait());
+                CHECK(event_loop.get_statistics().timer_wakeups == 1);
+            }
+        }
+
+        WHEN("Nothing happens until the housekeeping interval ends") {
+            event_loop.schedule(client, 1);
+
+            THEN("The loop wakes up without syncing") {
+                CHECK_FALSE(event_loop.wait());
+                CHECK(event_loop.get_statistics().housekeeping_wakeups == 1);
+            }
+        }
+
+        close(sockets[0]);
+        close(sockets[1]);
+        close(notify_fd);
+    }
+}
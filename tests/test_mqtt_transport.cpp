@@ -0,0 +1,262 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/resource.h>
+
+#include <utils/mqtt_abstraction.hpp>
+
+using namespace std::chrono_literals;
+
+namespace {
+// allocations made by the current thread, counted by the replaced global operator new below
+thread_local uint64_t allocations = 0;
+} // namespace
+
+void* operator new(std::size_t size) {
+    allocations++;
+    if (void* memory = std::malloc(size == 0 ? 1 : size)) {
+        return memory;
+    }
+    throw std::bad_alloc();
+}
+
+void operator delete(void* memory) noexcept {
+    std::free(memory);
+}
+
+void operator delete(void* memory, std::size_t) noexcept {
+    std::free(memory);
+}
+
+namespace {
+std::string getenv_or(const char* name, const std::string& fallback) {
+    const char* value = std::getenv(name);
+    return (value != nullptr) ? value : fallback;
+}
+
+/// \brief Publishes messages on an external topic and waits until they come back from the broker
+class RoundTrip {
+public:
+    explicit RoundTrip(const Everest::MQTTSettings& settings) : mqtt(settings) {
+    }
+
+    bool connect() {
+        if (!this->mqtt.connect()) {
+            return false;
+        }
+        this->mqtt.spawn_main_loop_thread();
+        const auto handler = std::make_shared<Handler>([this](const json&) {
+            const std::lock_guard<std::mutex> lock(this->mutex);
+            this->received++;
+            this->cv.notify_all();
+        });
+        this->mqtt.register_handler(topic, std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, handler),
+                                    QOS::QOS0);
+
+        // the subscription is active once the first message comes back
+        for (int i = 0; i < 50; i++) {
+            if (this->run(100ms)) {
+                return true;
+            }
+        }
+        return false;
+    }
+
+    Everest::MQTTStatistics get_statistics() const {
+        return this->mqtt.get_statistics();
+    }
+
+    bool run(std::chrono::milliseconds timeout) {
+        std::unique_lock<std::mutex> lock(this->mutex);
+        const auto expected = this->received + 1;
+        this->mqtt.publish(topic, std::string(256, 'x'), QOS::QOS0);
+        return this->cv.wait_for(lock, timeout, [this, expected]() { return this->received >= expected; });
+    }
+
+private:
+    static constexpr auto topic = "everest_benchmark/round_trip";
+    Everest::MQTTAbstraction mqtt;
+    std::mutex mutex;
+    std::condition_variable cv;
+    uint64_t received{0};
+};
+} // namespace
+
+// needs a local broker listening on TCP and on a unix domain socket, e.g. mosquitto with
+// "listener 1883 127.0.0.1" and "listener 0 /tmp/mosquitto.sock"
+TEST_CASE("MQTT transport latency benchmark", "[.][benchmark]") {
+    Everest::MQTTSettings tcp_settings;
+    tcp_settings.broker_host = getenv_or("MQTT_SERVER_ADDRESS", "127.0.0.1");
+    tcp_settings.broker_port = std::stoi(getenv_or("MQTT_SERVER_PORT", "1883"));
+    tcp_settings.everest_prefix = "everest/";
+    RoundTrip tcp(tcp_settings);
+    REQUIRE(tcp.connect());
+
+    Everest::MQTTSettings uds_settings;
+    uds_settings.broker_socket_path = getenv_or("MQTT_SERVER_SOCKET_PATH", "/tmp/mosquitto.sock");
+    uds_settings.everest_prefix = "everest/";
+    RoundTrip uds(uds_settings);
+    REQUIRE(uds.connect());
+
+    BENCHMARK("publish round trip via loopback TCP") {
+        return tcp.run(1s);
+    };
+
+    BENCHMARK("publish round trip via unix domain socket") {
+        return uds.run(1s);
+    };
+}
+
+namespace {
+std::chrono::microseconds cpu_time() {
+    struct rusage usage = {};
+    getrusage(RUSAGE_SELF, &usage);
+    return std::chrono::seconds(usage.ru_utime.tv_sec + usage.ru_stime.tv_sec) +
+           std::chrono::microseconds(usage.ru_utime.tv_usec + usage.ru_stime.tv_usec);
+}
+} // namespace
+
+// needs a local broker listening on TCP, see above
+TEST_CASE("MQTT main loop idle CPU and publish latency benchmark", "[.][benchmark]") {
+    Everest::MQTTSettings settings;
+    settings.broker_host = getenv_or("MQTT_SERVER_ADDRESS", "127.0.0.1");
+    settings.broker_port = std::stoi(getenv_or("MQTT_SERVER_PORT", "1883"));
+    settings.everest_prefix = "everest/";
+    RoundTrip round_trip(settings);
+    REQUIRE(round_trip.connect());
+
+    const auto idle_duration = 10s;
+    const auto wakeups_before = round_trip.get_statistics().event_loop.wakeups;
+    const auto cpu_before = cpu_time();
+    std::this_thread::sleep_for(idle_duration);
+    const auto idle_cpu = cpu_time() - cpu_before;
+    const auto idle_wakeups = round_trip.get_statistics().event_loop.wakeups - wakeups_before;
+    WARN("idle for " << idle_duration.count() << "s: " << idle_cpu.count() << "us CPU time, " << idle_wakeups
+                     << " main loop wake-ups");
+
+    std::vector<std::chrono::nanoseconds> latencies;
+    for (int i = 0; i < 10000; i++) {
+        const auto start = std::chrono::steady_clock::now();
+        REQUIRE(round_trip.run(1s));
+        latencies.push_back(std::chrono::steady_clock::now() - start);
+    }
+    std::sort(latencies.begin(), latencies.end());
+    const auto percentile = [&latencies](double p) {
+        return std::chrono::duration_cast<std::chrono::microseconds>(
+                   latencies.at(static_cast<size_t>(p * static_cast<double>(latencies.size() - 1))))
+            .count();
+    };
+    WARN("publish round trip latency: p50 " << percentile(0.5) << "us, p99 " << percentile(0.99) << "us, max "
+                                             << percentile(1.0) << "us");
+}
+
+// needs a local broker listening on TCP, see above
+TEST_CASE("MQTT publish allocation benchmark", "[.][benchmark]") {
+    Everest::MQTTSettings settings;
+    settings.broker_host = getenv_or("MQTT_SERVER_ADDRESS", "127.0.0.1");
+    settings.broker_port = std::stoi(getenv_or("MQTT_SERVER_PORT", "1883"));
+    settings.everest_prefix = "everest/";
+    Everest::MQTTAbstraction mqtt(settings);
+    REQUIRE(mqtt.connect());
+    mqtt.spawn_main_loop_thread();
+
+    const std::string topic = "everest/evse_manager/evse/var";
+    const json message = {
+        {"name", "powermeter"},
+        {"data",
+         {{"timestamp", "2023-01-01T12:00:00.000Z"},
+          {"energy_Wh_import", {{"total", 123456.7}}},
+          {"power_W", {{"total", 11040.0}}},
+          {"voltage_V", {{"L1", 230.1}, {"L2", 229.8}, {"L3", 230.4}}}}}};
+
+    const auto allocations_per_publish = [](const auto& publish) {
+        // the first publishes size the buffers
+        for (int i = 0; i < 100; i++) {
+            publish();
+        }
+        const int publishes = 10000;
+        const auto before = allocations;
+        for (int i = 0; i < publishes; i++) {
+            publish();
+        }
+        return static_cast<double>(allocations - before) / publishes;
+    };
+    const auto publish_dumped = [&]() { mqtt.publish(topic, message.dump(), QOS::QOS0); };
+    const auto publish_json = [&]() { mqtt.publish(topic, message, QOS::QOS0); };
+
+    WARN("allocations per publish of a serialized string: " << allocations_per_publish(publish_dumped));
+    WARN("allocations per publish of a json document: " << allocations_per_publish(publish_json));
+
+    BENCHMARK("publish a serialized string") {
+        return publish_dumped();
+    };
+
+    BENCHMARK("publish a json document") {
+        return publish_json();
+    };
+}
+
+// needs a local broker listening on TCP, see above
+TEST_CASE("MQTT handler registration benchmark", "[.][benchmark]") {
+    Everest::MQTTSettings settings;
+    settings.broker_host = getenv_or("MQTT_SERVER_ADDRESS", "127.0.0.1");
+    settings.broker_port = std::stoi(getenv_or("MQTT_SERVER_PORT", "1883"));
+    settings.everest_prefix = "everest/";
+    const int handlers = 500;
+
+    // time until a message arrives on the last of the topics, like a module that registers its handlers on init
+    const auto measure_init_time = [&](bool subscribe_individually) {
+        Everest::MQTTAbstraction mqtt(settings);
+        REQUIRE(mqtt.connect());
+        mqtt.spawn_main_loop_thread();
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        bool received = false;
+        const auto handler = std::make_shared<Handler>([&](const json&) {
+            const std::lock_guard<std::mutex> lock(mutex);
+            received = true;
+            cv.notify_all();
+        });
+
+        const auto start = std::chrono::steady_clock::now();
+        std::string topic;
+        for (int i = 0; i < handlers; i++) {
+            topic = "everest_benchmark/init/" + std::to_string(i);
+            if (subscribe_individually) {
+                mqtt.subscribe(topic, QOS::QOS2);
+            }
+            mqtt.register_handler(topic, std::make_shared<TypedHandler>(HandlerType::ExternalMQTT, handler), QOS::QOS2);
+        }
+        std::unique_lock<std::mutex> lock(mutex);
+        while (!received && std::chrono::steady_clock::now() - start < 10s) {
+            mqtt.publish(topic, std::string("x"), QOS::QOS0);
+            cv.wait_for(lock, 10ms, [&received]() { return received; });
+        }
+        REQUIRE(received);
+        const auto elapsed =
+            std::chrono::duration_cast<std::chrono::microseconds>(std::chrono::steady_clock::now() - start);
+        const auto packets = mqtt.get_statistics().subscriptions.subscribe_packets;
+        lock.unlock();
+        mqtt.disconnect();
+        WARN(handlers << " handlers " << (subscribe_individually ? "also subscribed one by one" : "batched") << ": "
+                      << elapsed.count() << "us, " << packets << " batched SUBSCRIBE packets");
+    };
+
+    // subscribing each topic on its own sends one SUBSCRIBE packet per registration like before batching
+    measure_init_time(true);
+    measure_init_time(false);
+}
@@ -0,0 +1,123 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <string>
+
+#include <utils/payload_encoding.hpp>
+
+using Everest::PayloadEncoding;
+using nlohmann::json;
+
+namespace {
+// a powermeter var as published by an EVSE module
+const json powermeter_var = json::parse(R"({
+    "name": "powermeter",
+    "data": {
+        "timestamp": "2023-01-01T12:00:00.000Z",
+        "meter_id": "EVSE-1",
+        "energy_Wh_import": {"total": 123456.7, "L1": 41152.2, "L2": 41152.2, "L3": 41152.3},
+        "power_W": {"total": 11040.0, "L1": 3680.0, "L2": 3680.0, "L3": 3680.0},
+        "voltage_V": {"L1": 230.1, "L2": 229.8, "L3": 230.4},
+        "current_A": {"L1": 16.0, "L2": 16.0, "L3": 16.0},
+        "frequency_Hz": {"L1": 50.0, "L2": 50.0, "L3": 50.0}
+    }
+})");
+
+// the result of a cmd call
+const json cmd_result = json::parse(R"({
+    "name": "enable_disable",
+    "type": "result",
+    "data": {"id": "6c7d3a6e-9b7f-4a52-8d2e-1f0a6e3b2c11", "retval": true, "origin": "evse_manager"}
+})");
+
+// a raised error
+const json error_message = json::parse(R"({
+    "type": "evse_board_support/DiodeFault",
+    "description": "Diode fault detected",
+    "message": "CP signal negative level out of range",
+    "severity": "High",
+    "origin": {"module_id": "yeti_driver", "implementation_id": "board_support"},
+    "timestamp": "2023-01-01T12:00:00.000Z",
+    "uuid": "1d3b2a4c-5e6f-4a7b-8c9d-0e1f2a3b4c5d",
+    "state": "Active"
+})");
+
+const auto encodings = {PayloadEncoding::Json, PayloadEncoding::Cbor, PayloadEncoding::MessagePack};
+
+json round_trip(const json& data, PayloadEncoding encoding) {
+    const auto payload = Everest::encode_payload(data, encoding);
+    return Everest::decode_payload(payload.data(), payload.data() + payload.size(), encoding);
+}
+} // namespace
+
+SCENARIO("Payloads on everest topics can be encoded in a binary format", "[payload_encoding]") {
+    const auto encoding = GENERATE(values(encodings));
+
+    GIVEN("Typical messages and plain values") {
+        THEN("They survive encoding and decoding unchanged") {
+            CHECK(round_trip(powermeter_var, encoding) == powermeter_var);
+            CHECK(round_trip(cmd_result, encoding) == cmd_result);
+            CHECK(round_trip(error_message, encoding) == error_message);
+            CHECK(round_trip(json(true), encoding) == json(true));
+            CHECK(round_trip(json(0), encoding) == json(0));
+            CHECK(round_trip(json("ready"), encoding) == json("ready"));
+        }
+    }
+
+    GIVEN("A truncated payload") {
+        const auto payload = Everest::encode_payload(powermeter_var, encoding);
+
+        THEN("Decoding it fails with a parse error") {
+            CHECK_THROWS_AS(Everest::decode_payload(payload.data(), payload.data() + payload.size() / 2, encoding),
+                            json::parse_error);
+        }
+    }
+}
+
+TEST_CASE("Binary payloads are smaller than json text", "[payload_encoding]") {
+    const auto json_size = Everest::encode_payload(powermeter_var, PayloadEncoding::Json).size();
+    CHECK(Everest::encode_payload(powermeter_var, PayloadEncoding::Cbor).size() < json_size);
+    CHECK(Everest::encode_payload(powermeter_var, PayloadEncoding::MessagePack).size() < json_size);
+}
+
+TEST_CASE("A payload encoder encodes like encode_payload", "[payload_encoding]") {
+    const auto encoding = GENERATE(values(encodings));
+    Everest::PayloadEncoder encoder;
+
+    CHECK(encoder.encode(powermeter_var, encoding) == Everest::encode_payload(powermeter_var, encoding));
+    CHECK(encoder.encode(cmd_result, encoding) == Everest::encode_payload(cmd_result, encoding));
+
+    encoder.shrink_to(0);
+    CHECK(encoder.encode(error_message, encoding) == Everest::encode_payload(error_message, encoding));
+}
+
+TEST_CASE("A payload encoder reuses its buffer for binary encodings", "[payload_encoding]") {
+    const auto encoding = GENERATE(PayloadEncoding::Cbor, PayloadEncoding::MessagePack);
+    Everest::PayloadEncoder encoder;
+
+    const auto* memory = encoder.encode(powermeter_var, encoding).data();
+    CHECK(encoder.encode(cmd_result, encoding) == Everest::encode_payload(cmd_result, encoding));
+    CHECK(encoder.encode(cmd_result, encoding).data() == memory);
+}
+
+TEST_CASE("Payload encoding benchmark", "[.][benchmark]") {
+    const std::pair<const char*, PayloadEncoding> named_encodings[] = {
+        {"json", PayloadEncoding::Json}, {"cbor", PayloadEncoding::Cbor}, {"msgpack", PayloadEncoding::MessagePack}};
+    const std::pair<const char*, const json*> messages[] = {
+        {"powermeter var", &powermeter_var}, {"cmd result", &cmd_result}, {"error", &error_message}};
+
+    for (const auto& [message_name, message] : messages) {
+        for (const auto& [encoding_name, encoding] : named_encodings) {
+            const auto payload = Everest::encode_payload(*message, encoding);
+            WARN(message_name << " as " << encoding_name << ": " << payload.size() << " bytes on the wire");
+
+            BENCHMARK(std::string("encode ") + message_name + " as " + encoding_name) {
+                return Everest::encode_payload(*message, encoding);
+            };
+            BENCHMARK(std::string("decode ") + message_name + " from " + encoding_name) {
+                return Everest::decode_payload(payload.data(), payload.data() + payload.size(), encoding);
+            };
+        }
+    }
+}
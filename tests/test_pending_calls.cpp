@@ -0,0 +1,152 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+#include <everest/exceptions.hpp>
+
+#include <utils/pending_calls.hpp>
+
+using namespace std::chrono_literals;
+
+SCENARIO("Pending calls are completed by their results", "[!throws]") {
+    GIVEN("A table of pending calls") {
+        Everest::PendingCalls pending_calls;
+
+        WHEN("A call waiting with a future gets its result") {
+            auto result = pending_calls.add("call-1", "test->cmd()", 10s);
+            CHECK(pending_calls.size() == 1);
+            CHECK(pending_calls.complete("call-1", 42));
+
+            THEN("The future is ready with the result and the call is removed") {
+                REQUIRE(result.wait_for(0s) == std::future_status::ready);
+                CHECK(result.get() == 42);
+                CHECK(pending_calls.size() == 0);
+                CHECK_FALSE(pending_calls.complete("call-1", 43));
+            }
+        }
+
+        WHEN("Results of unknown calls arrive") {
+            THEN("They are ignored") {
+                CHECK_FALSE(pending_calls.complete("unknown", 42));
+            }
+        }
+
+        WHEN("A call could not be sent") {
+            auto result = pending_calls.add("call-1", "test->cmd()", 10s);
+            CHECK(pending_calls.fail("call-1", std::make_exception_ptr(Everest::EverestTimeoutError("not sent"))));
+
+            THEN("The future fails right away and the call is removed") {
+                REQUIRE(result.wait_for(0s) == std::future_status::ready);
+                CHECK_THROWS_AS(result.get(), Everest::EverestTimeoutError);
+                CHECK(pending_calls.size() == 0);
+                CHECK_FALSE(pending_calls.complete("call-1", 42));
+            }
+        }
+
+        WHEN("A call id is added twice") {
+            auto result = pending_calls.add("call-1", "test->cmd()", 10s);
+            THEN("It throws") {
+                CHECK_THROWS_AS(pending_calls.add("call-1", "test->cmd()", 10s), Everest::EverestInternalError);
+            }
+        }
+
+        WHEN("Many calls waiting with a callback get their results from another thread") {
+            constexpr int number_of_calls = 100;
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::vector<int> results;
+            size_t errors = 0;
+            std::thread::id callback_thread;
+
+            for (int i = 0; i < number_of_calls; i++) {
+                pending_calls.add(fmt::format("call-{}", i), "test->cmd()", 10s,
+                                  [&](json result, std::exception_ptr error) {
+                                      const std::lock_guard<std::mutex> lock(mutex);
+                                      if (error) {
+                                          errors++;
+                                      }
+                                      results.push_back(result.get<int>());
+                                      callback_thread = std::this_thread::get_id();
+                                      cv.notify_all();
+                                  });
+            }
+
+            std::thread results_thread([&]() {
+                for (int i = 0; i < number_of_calls; i++) {
+                    pending_calls.complete(fmt::format("call-{}", i), i);
+                }
+            });
+            results_thread.join();
+
+            THEN("Every callback is called once with its result, on a thread of the table") {
+                std::unique_lock<std::mutex> lock(mutex);
+                REQUIRE(cv.wait_for(lock, 10s, [&]() { return results.size() == number_of_calls; }));
+                CHECK(errors == 0);
+                for (int i = 0; i < number_of_calls; i++) {
+                    CHECK(results.at(i) == i);
+                }
+                CHECK(callback_thread != std::this_thread::get_id());
+                CHECK(pending_calls.size() == 0);
+            }
+        }
+    }
+}
+
+SCENARIO("Pending calls time out", "[!throws]") {
+    GIVEN("A table of pending calls") {
+        Everest::PendingCalls pending_calls;
+
+        WHEN("A call waiting with a future does not get its result in time") {
+            auto slow = pending_calls.add("slow", "test->slow()", 10s);
+            auto fast = pending_calls.add("fast", "test->fast()", 50ms);
+
+            THEN("Only the call with the earlier deadline times out with an EverestTimeoutError") {
+                REQUIRE(fast.wait_for(10s) == std::future_status::ready);
+                CHECK_THROWS_AS(fast.get(), Everest::EverestTimeoutError);
+                CHECK(slow.wait_for(0s) == std::future_status::timeout);
+                CHECK(pending_calls.size() == 1);
+                CHECK_FALSE(pending_calls.complete("fast", 42));
+            }
+        }
+
+        WHEN("A call waiting with a callback does not get its result in time") {
+            std::mutex mutex;
+            std::condition_variable cv;
+            std::exception_ptr timeout_error;
+            json timeout_result;
+            bool called = false;
+
+            pending_calls.add("call", "test->cmd()", 50ms, [&](json result, std::exception_ptr error) {
+                const std::lock_guard<std::mutex> lock(mutex);
+                timeout_result = result;
+                timeout_error = error;
+                called = true;
+                cv.notify_all();
+            });
+
+            THEN("The callback is called with an EverestTimeoutError") {
+                std::unique_lock<std::mutex> lock(mutex);
+                REQUIRE(cv.wait_for(lock, 10s, [&]() { return called; }));
+                CHECK(timeout_result.is_null());
+                CHECK_THROWS_AS(std::rethrow_exception(timeout_error), Everest::EverestTimeoutError);
+                CHECK(pending_calls.size() == 0);
+            }
+        }
+
+        WHEN("A call gets its result before its deadline") {
+            auto result = pending_calls.add("call", "test->cmd()", 50ms);
+            CHECK(pending_calls.complete("call", "done"));
+            std::this_thread::sleep_for(100ms);
+
+            THEN("It does not time out anymore") {
+                CHECK(result.get() == "done");
+            }
+        }
+    }
+}
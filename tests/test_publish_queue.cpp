@@ -0,0 +1,173 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <utils/publish_queue.hpp>
+
+using Everest::PublishQueue;
+using Everest::PublishQueueOverflowPolicy;
+using Everest::QueuedPublish;
+using namespace std::chrono_literals;
+
+namespace {
+std::vector<std::string> drain_payloads(PublishQueue& queue) {
+    std::vector<std::string> payloads;
+    queue.drain([&payloads](const QueuedPublish& message) {
+        payloads.push_back(message.payload);
+        return true;
+    });
+    return payloads;
+}
+} // namespace
+
+SCENARIO("Published messages wait in the publish queue until they fit into the send buffer", "[publish_queue]") {
+    GIVEN("A queue for two messages") {
+        PublishQueue queue(2, PublishQueueOverflowPolicy::FailFast, 0ms);
+
+        WHEN("Messages are queued") {
+            REQUIRE(queue.push("everest/a", "1", QOS::QOS0));
+            REQUIRE(queue.push("everest/b", "2", QOS::QOS2));
+
+            THEN("They are drained in order") {
+                std::vector<QueuedPublish> sent;
+                CHECK(queue.drain([&sent](const QueuedPublish& message) {
+                    sent.push_back(message);
+                    return true;
+                }) == 2);
+                REQUIRE(sent.size() == 2);
+                CHECK(sent.at(0).topic == "everest/a");
+                CHECK(sent.at(0).qos == QOS::QOS0);
+                CHECK(sent.at(1).payload == "2");
+                CHECK(sent.at(1).qos == QOS::QOS2);
+                CHECK(queue.get_statistics().messages_sent == 2);
+            }
+
+            THEN("A message that does not fit stays at the front of the queue") {
+                CHECK(queue.drain([](const QueuedPublish&) { return false; }) == 0);
+                CHECK(queue.get_statistics().send_buffer_full == 1);
+                CHECK(queue.get_statistics().queue_depth == 2);
+                CHECK(drain_payloads(queue) == std::vector<std::string>{"1", "2"});
+            }
+        }
+    }
+
+    GIVEN("A full queue that fails fast") {
+        PublishQueue queue(2, PublishQueueOverflowPolicy::FailFast, 1000ms);
+        REQUIRE(queue.push("everest/a", "1", QOS::QOS0));
+        REQUIRE(queue.push("everest/a", "2", QOS::QOS0));
+
+        THEN("New messages are rejected without waiting") {
+            const auto start = std::chrono::steady_clock::now();
+            CHECK_FALSE(queue.push("everest/a", "3", QOS::QOS1));
+            CHECK(std::chrono::steady_clock::now() - start < 500ms);
+            const auto statistics = queue.get_statistics();
+            CHECK(statistics.queue_full == 1);
+            CHECK(statistics.messages_dropped == 1);
+            CHECK(statistics.queue_high_water_mark == 2);
+        }
+    }
+
+    GIVEN("A full queue that blocks, filled without waiting") {
+        PublishQueue queue(2, PublishQueueOverflowPolicy::Block, 1000ms);
+        REQUIRE(queue.try_push("everest/a", "1", QOS::QOS2));
+        REQUIRE(queue.try_push("everest/a", "2", QOS::QOS2));
+
+        THEN("New messages are rejected without waiting") {
+            const auto start = std::chrono::steady_clock::now();
+            CHECK_FALSE(queue.try_push("everest/a", "3", QOS::QOS2));
+            CHECK(std::chrono::steady_clock::now() - start < 500ms);
+            CHECK(queue.get_statistics().messages_dropped == 1);
+        }
+    }
+
+    GIVEN("A full queue that drops the oldest QoS 0 message") {
+        PublishQueue queue(2, PublishQueueOverflowPolicy::DropOldestQoS0, 0ms);
+        REQUIRE(queue.push("everest/a", "1", QOS::QOS1));
+        REQUIRE(queue.push("everest/a", "2", QOS::QOS0));
+
+        THEN("The QoS 0 message makes room for a new message") {
+            CHECK(queue.push("everest/a", "3", QOS::QOS2));
+            CHECK(drain_payloads(queue) == std::vector<std::string>{"1", "3"});
+            CHECK(queue.get_statistics().messages_dropped == 1);
+        }
+
+        THEN("Without a queued QoS 0 message a new message is dropped") {
+            REQUIRE(queue.push("everest/a", "3", QOS::QOS1));
+            CHECK_FALSE(queue.push("everest/a", "4", QOS::QOS0));
+            CHECK(drain_payloads(queue) == std::vector<std::string>{"1", "3"});
+        }
+    }
+
+    GIVEN("A full queue that blocks") {
+        PublishQueue queue(1, PublishQueueOverflowPolicy::Block, 10s);
+        REQUIRE(queue.push("everest/a", "1", QOS::QOS1));
+
+        THEN("A publisher waits until the queue was drained") {
+            std::thread drainer([&queue]() {
+                std::this_thread::sleep_for(50ms);
+                drain_payloads(queue);
+            });
+            CHECK(queue.push("everest/a", "2", QOS::QOS1));
+            drainer.join();
+            CHECK(drain_payloads(queue) == std::vector<std::string>{"2"});
+        }
+
+        THEN("A publisher gives up when the queue is stopped") {
+            std::thread stopper([&queue]() {
+                std::this_thread::sleep_for(50ms);
+                queue.stop();
+            });
+            CHECK_FALSE(queue.push("everest/a", "2", QOS::QOS1));
+            stopper.join();
+        }
+    }
+
+    GIVEN("A full queue that blocks only briefly") {
+        PublishQueue queue(1, PublishQueueOverflowPolicy::Block, 10ms);
+        REQUIRE(queue.push("everest/a", "1", QOS::QOS1));
+
+        THEN("The message is dropped after the timeout") {
+            CHECK_FALSE(queue.push("everest/a", "2", QOS::QOS1));
+            CHECK(queue.get_statistics().messages_dropped == 1);
+        }
+    }
+}
+
+TEST_CASE("Publish queue under concurrent publishers", "[publish_queue]") {
+    PublishQueue queue(16, PublishQueueOverflowPolicy::Block, 10s);
+    const int publishers = 4;
+    const int messages = 1000;
+
+    std::vector<std::thread> threads;
+    for (int i = 0; i < publishers; i++) {
+        threads.emplace_back([&queue, i]() {
+            for (int j = 0; j < messages; j++) {
+                queue.push("everest/" + std::to_string(i), std::to_string(j), QOS::QOS1);
+            }
+        });
+    }
+
+    std::vector<int> next(publishers, 0);
+    bool in_order = true;
+    int received = 0;
+    while (received < publishers * messages) {
+        received += static_cast<int>(queue.drain([&](const QueuedPublish& message) {
+            auto& expected = next.at(std::stoi(message.topic.substr(8)));
+            in_order = in_order && (std::stoi(message.payload) == expected);
+            expected++;
+            return true;
+        }));
+    }
+    for (auto& thread : threads) {
+        thread.join();
+    }
+
+    CHECK(in_order);
+    CHECK(queue.get_statistics().messages_dropped == 0);
+    CHECK(queue.get_statistics().queue_depth == 0);
+}
@@ -0,0 +1,138 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <memory>
+#include <string>
+
+#include <framework/runtime.hpp>
+#include <tests/helpers.hpp>
+#include <utils/config.hpp>
+#include <utils/routing_table.hpp>
+#include <utils/schema_validator_cache.hpp>
+
+namespace {
+std::shared_ptr<Everest::RuntimeSettings> routing_table_settings() {
+    const std::string bin_dir = Everest::tests::get_bin_dir().string() + "/";
+    return std::make_shared<Everest::RuntimeSettings>(bin_dir + "routing_table/",
+                                                      bin_dir + "routing_table/config.yaml");
+}
+} // namespace
+
+SCENARIO("A routing table resolves the implementations of a module", "[routing_table]") {
+    GIVEN("A module that provides one implementation and requires one with one and one with two connections") {
+        Everest::Config config(routing_table_settings());
+        Everest::SchemaValidatorCache validators(
+            [&config](const Everest::json_uri& uri, json& schema) { config.ref_loader(uri, schema); },
+            Everest::Config::format_checker);
+        const Everest::RoutingTable routing(config, "routing_1", validators);
+
+        THEN("The provided implementation is found") {
+            const auto* implementation = routing.find_implementation("main");
+            REQUIRE(implementation != nullptr);
+            CHECK(implementation->module_id == "routing_1");
+            CHECK(implementation->impl_id == "main");
+            CHECK(implementation->identifier == config.printable_identifier("routing_1", "main"));
+            CHECK(implementation->cmds.count("get_value") == 1);
+            CHECK(implementation->vars.count("value") == 1);
+            CHECK(routing.find_implementation("unknown") == nullptr);
+        }
+
+        THEN("The topics are the ones of the config") {
+            const auto* implementation = routing.find_implementation("main");
+            REQUIRE(implementation != nullptr);
+            CHECK(implementation->cmd_topic == config.mqtt_prefix("routing_1", "main") + "/cmd");
+            CHECK(implementation->var_topic == config.mqtt_prefix("routing_1", "main") + "/var");
+
+            const auto* connection = routing.find_connection({"next", 0});
+            REQUIRE(connection != nullptr);
+            CHECK(connection->implementation->cmd_topic == config.mqtt_prefix("routing_2", "main") + "/cmd");
+            CHECK(connection->implementation->var_topic == config.mqtt_prefix("routing_2", "main") + "/var");
+        }
+
+        THEN("The index of a requirement with a single connection is ignored") {
+            const auto* connection = routing.find_connection({"next", 0});
+            REQUIRE(connection != nullptr);
+            CHECK(connection->implementation->module_id == "routing_2");
+            CHECK(connection->implementation->impl_id == "main");
+            CHECK_FALSE(connection->cmd_timeout.has_value());
+            CHECK(routing.find_connection({"next", 5}) == connection);
+        }
+
+        THEN("The connections of a requirement with multiple connections are found by their index") {
+            const auto* first = routing.find_connection({"many", 0});
+            const auto* second = routing.find_connection({"many", 1});
+            REQUIRE(first != nullptr);
+            REQUIRE(second != nullptr);
+            CHECK(first->implementation->module_id == "routing_2");
+            CHECK(second->implementation->module_id == "routing_3");
+            CHECK(second->cmd_timeout == std::chrono::milliseconds(500));
+            CHECK(routing.find_connection({"many", 2}) == nullptr);
+        }
+
+        THEN("Implementations connected more than once share their route") {
+            CHECK(routing.find_connection({"next", 0})->implementation ==
+                  routing.find_connection({"many", 0})->implementation);
+        }
+
+        THEN("Unknown requirements are not connected") {
+            CHECK(routing.find_connection({"unknown", 0}) == nullptr);
+        }
+
+        THEN("The mqtt_qos config of the module overrides the QoS of the interface") {
+            const auto* implementation = routing.find_implementation("main");
+            REQUIRE(implementation != nullptr);
+            CHECK(implementation->vars.at("value").qos == QOS::QOS0);
+            CHECK(implementation->cmds.at("get_value").qos == QOS::QOS1);
+            CHECK(implementation->result_qos == QOS::QOS1);
+
+            // the override only applies to the implementations of the module it is configured for
+            const auto* connected = routing.find_connection({"next", 0})->implementation;
+            CHECK(connected->vars.at("value").qos == QOS::QOS2);
+            CHECK(connected->cmds.at("get_value").qos == QOS::QOS2);
+            CHECK(connected->result_qos == QOS::QOS2);
+        }
+
+        THEN("Only the vars listed in the var_coalescing config of the module are coalesced") {
+            CHECK(routing.find_implementation("main")->vars.at("value").coalesce);
+            CHECK_FALSE(routing.find_connection({"next", 0})->implementation->vars.at("value").coalesce);
+        }
+
+        THEN("The validators of all cmds and vars are compiled once when the table is built") {
+            // one result and one var validator per implementation, routing_1, routing_2 and routing_3
+            CHECK(validators.size() == 6);
+
+            const auto* implementation = routing.find_implementation("main");
+            REQUIRE(implementation != nullptr);
+            const auto& cmd = implementation->cmds.at("get_value");
+            CHECK(cmd.argument_validators.empty());
+            REQUIRE(cmd.result_validator != nullptr);
+            REQUIRE(implementation->vars.at("value").validator != nullptr);
+            CHECK(validators.get("routing_1/main/cmd/get_value/result", json::object()) == cmd.result_validator);
+            CHECK(validators.get("routing_1/main/var/value", json::object()) ==
+                  implementation->vars.at("value").validator);
+
+            const Everest::RoutingTable other(config, "routing_1", validators);
+            CHECK(validators.size() == 6);
+            CHECK(other.find_implementation("main")->vars.at("value").validator ==
+                  implementation->vars.at("value").validator);
+        }
+    }
+
+    GIVEN("A routing table built with validation turned off") {
+        Everest::Config config(routing_table_settings());
+        Everest::SchemaValidatorCache validators(
+            [&config](const Everest::json_uri& uri, json& schema) { config.ref_loader(uri, schema); },
+            Everest::Config::format_checker, Everest::SchemaValidationSettings{Everest::SchemaValidationMode::Off});
+        const Everest::RoutingTable routing(config, "routing_1", validators);
+
+        THEN("No validators are compiled") {
+            CHECK(validators.size() == 0);
+            const auto* implementation = routing.find_implementation("main");
+            REQUIRE(implementation != nullptr);
+            CHECK(implementation->cmds.at("get_value").result_validator == nullptr);
+            CHECK(implementation->vars.at("value").validator == nullptr);
+        }
+    }
+}
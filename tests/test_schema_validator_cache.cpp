@@ -0,0 +1,163 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <vector>
+
+#include <utils/config.hpp>
+#include <utils/schema_validator_cache.hpp>
+
+namespace {
+// a var definition similar to the ones found in interfaces, with a $ref into a types file
+const json var_schema = json::parse(R"({
+    "type": "object",
+    "required": ["current_A", "voltage_V"],
+    "properties": {
+        "current_A": {"$ref": "/types#/Measurement"},
+        "voltage_V": {"$ref": "/types#/Measurement"},
+        "phase": {"type": "string", "enum": ["L1", "L2", "L3"]}
+    }
+})");
+
+const json types = json::parse(R"({
+    "Measurement": {
+        "type": "object",
+        "required": ["value"],
+        "properties": {
+            "value": {"type": "number"},
+            "timestamp": {"type": "string", "format": "date-time"}
+        }
+    }
+})");
+
+const json valid_value = json::parse(R"({
+    "current_A": {"value": 16.0},
+    "voltage_V": {"value": 230.0, "timestamp": "2023-01-01T00:00:00Z"},
+    "phase": "L1"
+})");
+
+void types_loader(const Everest::json_uri& uri, json& schema) {
+    if (uri.path() == "/types") {
+        schema = types;
+        return;
+    }
+    Everest::Config::loader(uri, schema);
+}
+} // namespace
+
+SCENARIO("Schema validator cache compiles every schema once", "[!throws]") {
+    GIVEN("A schema validator cache") {
+        Everest::SchemaValidatorCache cache(types_loader, Everest::Config::format_checker);
+
+        THEN("Validators are shared per key") {
+            const auto first = cache.get("module/impl/var/powermeter", var_schema);
+            const auto second = cache.get("module/impl/var/powermeter", var_schema);
+            CHECK(first == second);
+            CHECK(cache.size() == 1);
+
+            const auto other = cache.get("module/impl/var/other", var_schema);
+            CHECK(other != first);
+            CHECK(cache.size() == 2);
+        }
+
+        THEN("Cached validators resolve references and validate values") {
+            const auto validator = cache.get("module/impl/var/powermeter", var_schema);
+            CHECK_NOTHROW(validator->validate(valid_value));
+
+            auto invalid_value = valid_value;
+            invalid_value["current_A"]["value"] = "16";
+            CHECK_THROWS(validator->validate(invalid_value));
+        }
+
+        THEN("Schemas that cannot be compiled are not cached") {
+            CHECK_THROWS(cache.get("module/impl/var/broken", json::parse(R"({"$ref": "/unknown#/Type"})")));
+            CHECK(cache.size() == 0);
+        }
+    }
+}
+
+SCENARIO("Schema validators check messages according to the validation mode", "[!throws]") {
+    auto invalid_value = valid_value;
+    invalid_value["current_A"]["value"] = "16";
+
+    GIVEN("A cache that samples messages") {
+        Everest::SchemaValidatorCache cache(types_loader, Everest::Config::format_checker,
+                                            {Everest::SchemaValidationMode::Sampled, 2, 3});
+        const auto validator = cache.get("module/impl/var/powermeter", var_schema);
+
+        THEN("The first messages and afterwards every nth message are validated") {
+            std::vector<bool> rejected;
+            for (int i = 0; i < 9; i++) {
+                try {
+                    validator->validate(invalid_value);
+                    rejected.push_back(false);
+                } catch (const std::exception&) {
+                    rejected.push_back(true);
+                }
+            }
+            CHECK(rejected == std::vector<bool>{true, true, true, false, false, true, false, false, true});
+            const auto statistics = cache.get_statistics();
+            CHECK(statistics.validated == 5);
+            CHECK(statistics.skipped == 4);
+            CHECK(statistics.type_checked == 0);
+        }
+    }
+
+    GIVEN("A cache that only checks types") {
+        Everest::SchemaValidatorCache cache(types_loader, Everest::Config::format_checker,
+                                            {Everest::SchemaValidationMode::TypeOnly});
+        const auto validator = cache.get("module/impl/var/powermeter", var_schema);
+
+        THEN("Only types and required properties are checked") {
+            CHECK_NOTHROW(validator->validate(valid_value));
+            CHECK_NOTHROW(validator->validate(invalid_value));
+            CHECK_THROWS(validator->validate(json::array()));
+            CHECK_THROWS(validator->validate(json::object({{"current_A", valid_value["current_A"]}})));
+            CHECK(cache.get_statistics().type_checked == 4);
+        }
+
+        THEN("References to types are followed") {
+            const auto ref_validator = cache.get("module/impl/var/measurement", {{"$ref", "/types#/Measurement"}});
+            CHECK_NOTHROW(ref_validator->validate(valid_value["current_A"]));
+            CHECK_THROWS(ref_validator->validate(json::array()));
+            CHECK_THROWS(ref_validator->validate(json::object({{"timestamp", "2023-01-01T00:00:00Z"}})));
+            CHECK(cache.get_statistics().type_checked == 3);
+        }
+
+        THEN("Messages that cannot be checked are counted as skipped") {
+            const auto unknown_validator = cache.get("module/impl/var/unknown", {{"$ref", "/unknown#/Type"}});
+            CHECK_NOTHROW(unknown_validator->validate(json::array()));
+            const auto any_validator = cache.get("module/impl/var/any", json::object());
+            CHECK_NOTHROW(any_validator->validate(42));
+            CHECK(cache.get_statistics().type_checked == 0);
+            CHECK(cache.get_statistics().skipped == 2);
+        }
+    }
+
+    GIVEN("A cache with validation turned off") {
+        Everest::SchemaValidatorCache cache(types_loader, Everest::Config::format_checker,
+                                            {Everest::SchemaValidationMode::Off});
+
+        THEN("Messages are only counted") {
+            CHECK_FALSE(cache.is_enabled());
+            CHECK_NOTHROW(cache.get("module/impl/var/powermeter", var_schema)->validate(invalid_value));
+            cache.count_skipped();
+            CHECK(cache.get_statistics().skipped == 2);
+            CHECK(cache.get_statistics().validated == 0);
+        }
+    }
+}
+
+TEST_CASE("Schema validation benchmark", "[.][benchmark]") {
+    Everest::SchemaValidatorCache cache(types_loader, Everest::Config::format_checker);
+
+    BENCHMARK("compile schema for every message") {
+        Everest::json_validator validator(types_loader, Everest::Config::format_checker);
+        validator.set_root_schema(var_schema);
+        return validator.validate(valid_value);
+    };
+
+    BENCHMARK("cached validator") {
+        return cache.get("module/impl/var/powermeter", var_schema)->validate(valid_value);
+    };
+}
@@ -0,0 +1,184 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <string>
+#include <thread>
+
+#include <unistd.h>
+
+#include <utils/shared_memory_transport.hpp>
+
+using Everest::SharedMemoryTransport;
+
+namespace {
+// the readers of a topic are registered host wide, so every test process uses topics of its own
+std::string test_topic(const std::string& name) {
+    return "everest/test_shared_memory_transport/" + std::to_string(getpid()) + "/" + name;
+}
+
+// a json document of 2 KiB
+const std::string large_payload = nlohmann::json(std::string(2048, '1')).dump();
+} // namespace
+
+SCENARIO("Large payloads are handed over via shared memory", "[shared_memory_transport]") {
+    GIVEN("A transport for payloads of at least 1 KiB and a subscriber of a topic") {
+        const auto topic = test_topic("var");
+        SharedMemoryTransport publisher(1024, 1024 * 1024);
+        SharedMemoryTransport subscriber(1024, 1024 * 1024);
+        subscriber.subscribe(topic);
+
+        THEN("Only large payloads are accepted") {
+            CHECK_FALSE(publisher.accepts(1023));
+            CHECK(publisher.accepts(1024));
+        }
+
+        WHEN("A payload is published") {
+            const nlohmann::json payload = {{"certificate_chain", std::string(4096, 'c')}};
+            const auto descriptor = publisher.publish(topic, payload.dump());
+            REQUIRE(descriptor.has_value());
+
+            THEN("Only a small descriptor has to be sent via the broker") {
+                CHECK(SharedMemoryTransport::is_descriptor(descriptor.value()));
+                CHECK(descriptor.value().size() < 100);
+                CHECK_FALSE(SharedMemoryTransport::is_descriptor(payload.dump()));
+            }
+
+            THEN("The segment is held by the publisher until the subscriber read it") {
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 0);
+                CHECK(publisher.get_statistics().bytes_held == payload.dump().size());
+
+                const auto data = subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json);
+                REQUIRE(data != nullptr);
+                CHECK(*data == payload);
+                CHECK(subscriber.get_statistics().segments_read == 1);
+
+                publisher.release_segments();
+                const auto statistics = publisher.get_statistics();
+                CHECK(statistics.segments_published == 1);
+                CHECK(statistics.segments_released == 1);
+                CHECK(statistics.segments_expired == 0);
+                CHECK(statistics.bytes_held == 0);
+            }
+
+            THEN("Readers that are not registered for the topic do not release the segment") {
+                SharedMemoryTransport observer(1024, 1024 * 1024);
+                const auto data = observer.read(topic, descriptor.value(), Everest::PayloadEncoding::Json);
+                REQUIRE(data != nullptr);
+                CHECK(*data == payload);
+
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 0);
+            }
+        }
+
+        WHEN("A second subscriber registers") {
+            SharedMemoryTransport second_subscriber(1024, 1024 * 1024);
+            second_subscriber.subscribe(topic);
+            const auto descriptor = publisher.publish(topic, large_payload);
+            REQUIRE(descriptor.has_value());
+
+            THEN("The segment is held until both subscribers read it") {
+                CHECK(subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) != nullptr);
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 0);
+
+                CHECK(second_subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) != nullptr);
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 1);
+            }
+        }
+
+        WHEN("A subscriber registers after a payload was published") {
+            const auto descriptor = publisher.publish(topic, large_payload);
+            REQUIRE(descriptor.has_value());
+            SharedMemoryTransport late_subscriber(1024, 1024 * 1024);
+            late_subscriber.subscribe(topic);
+
+            THEN("It was not counted as a reader of the segment") {
+                CHECK(late_subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) != nullptr);
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 0);
+
+                CHECK(subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) != nullptr);
+                publisher.release_segments();
+                CHECK(publisher.get_statistics().segments_released == 1);
+            }
+        }
+
+        WHEN("The subscriber unsubscribes") {
+            subscriber.unsubscribe(topic);
+
+            THEN("Payloads are published via the broker") {
+                CHECK_FALSE(publisher.publish(topic, std::string(2048, '1')).has_value());
+                CHECK(publisher.get_statistics().segments_published == 0);
+            }
+        }
+
+        WHEN("The publisher is gone") {
+            const auto descriptor = SharedMemoryTransport(1024, 1024 * 1024).publish(topic, std::string(2048, '1'));
+            REQUIRE(descriptor.has_value());
+
+            THEN("Its segments are no longer available") {
+                CHECK(subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) == nullptr);
+                CHECK(subscriber.get_statistics().segments_missed == 1);
+            }
+        }
+    }
+
+    GIVEN("A topic without subscribers") {
+        SharedMemoryTransport publisher(1024, 1024 * 1024);
+
+        THEN("Payloads are published via the broker") {
+            CHECK_FALSE(publisher.publish(test_topic("unread"), std::string(2048, '1')).has_value());
+            CHECK(publisher.get_statistics().publish_fallbacks == 0);
+        }
+    }
+
+    GIVEN("A transport with a short lease and a subscriber that never reads") {
+        const auto topic = test_topic("lease");
+        SharedMemoryTransport publisher(1024, 1024 * 1024, std::chrono::milliseconds(10));
+        SharedMemoryTransport subscriber(1024, 1024 * 1024);
+        subscriber.subscribe(topic);
+        const auto descriptor = publisher.publish(topic, std::string(2048, '1'));
+        REQUIRE(descriptor.has_value());
+
+        WHEN("The lease ended") {
+            std::this_thread::sleep_for(std::chrono::milliseconds(20));
+            publisher.release_segments();
+
+            THEN("The segment is released although it was not read") {
+                CHECK(publisher.get_statistics().segments_released == 1);
+                CHECK(publisher.get_statistics().segments_expired == 1);
+                CHECK(subscriber.read(topic, descriptor.value(), Everest::PayloadEncoding::Json) == nullptr);
+                CHECK(subscriber.get_statistics().segments_missed == 1);
+            }
+        }
+    }
+
+    GIVEN("A transport that may hold only 4 KiB") {
+        const auto topic = test_topic("limit");
+        SharedMemoryTransport publisher(1024, 4096);
+        SharedMemoryTransport subscriber(1024, 4096);
+        subscriber.subscribe(topic);
+
+        THEN("Payloads beyond the limit fall back to the broker") {
+            CHECK(publisher.publish(topic, std::string(3000, '1')).has_value());
+            CHECK_FALSE(publisher.publish(topic, std::string(3000, '2')).has_value());
+            CHECK(publisher.get_statistics().publish_fallbacks == 1);
+        }
+    }
+
+    GIVEN("A disabled transport") {
+        const auto topic = test_topic("disabled");
+        SharedMemoryTransport disabled(0, 4096);
+        disabled.subscribe(topic);
+
+        THEN("No payload is accepted and it does not register as a reader") {
+            CHECK_FALSE(disabled.accepts(1024 * 1024));
+            CHECK_FALSE(SharedMemoryTransport(1024, 4096).publish(topic, std::string(2048, '1')).has_value());
+        }
+    }
+}
@@ -0,0 +1,94 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <string>
+#include <vector>
+
+#include <utils/subscription_batch.hpp>
+
+using Everest::SubscriptionChange;
+
+SCENARIO("Subscriptions are packed into a single SUBSCRIBE packet", "[subscription_batch]") {
+    GIVEN("Two subscriptions") {
+        const std::vector<SubscriptionChange> changes = {{"a/b", QOS::QOS1, true}, {"c", QOS::QOS2, true}};
+
+        THEN("They are packed as MQTT 3.1.1 SUBSCRIBE packet") {
+            std::vector<uint8_t> buffer(64);
+            const auto size = Everest::pack_subscribe_request(buffer.data(), buffer.size(), 0x1234, changes.data(),
+                                                              changes.data() + changes.size());
+            const std::vector<uint8_t> expected = {0x82, 12,  0x12, 0x34, 0,   3, 'a',
+                                                   '/',  'b', 1,    0,    1,   'c', 2};
+            REQUIRE(size == expected.size());
+            buffer.resize(size);
+            CHECK(buffer == expected);
+        }
+
+        THEN("Nothing is packed into a buffer that is too small") {
+            std::vector<uint8_t> buffer(13);
+            CHECK(Everest::pack_subscribe_request(buffer.data(), buffer.size(), 1, changes.data(),
+                                                  changes.data() + changes.size()) == 0);
+        }
+    }
+
+    GIVEN("Many subscriptions") {
+        const std::vector<SubscriptionChange> changes(100, {"everest/module/impl/error/type", QOS::QOS2, true});
+
+        THEN("The remaining length takes two bytes") {
+            std::vector<uint8_t> buffer(8 * 1024);
+            const auto size = Everest::pack_subscribe_request(buffer.data(), buffer.size(), 1, changes.data(),
+                                                              changes.data() + changes.size());
+            const size_t remaining_length = 2 + 100 * (2 + changes.at(0).topic.size() + 1);
+            REQUIRE(size == 1 + 2 + remaining_length);
+            CHECK(buffer.at(1) == ((remaining_length & 0x7f) | 0x80));
+            CHECK(buffer.at(2) == (remaining_length >> 7));
+        }
+    }
+}
+
+SCENARIO("Subscription changes are collected until they are flushed", "[subscription_batch]") {
+    GIVEN("A batch and a MQTT-C client") {
+        Everest::SubscriptionBatch batch;
+        Everest::MQTTBuffers buffers(1024, 1024 * 1024);
+        struct mqtt_client client = {};
+        buffers.init(client, -1, nullptr);
+
+        THEN("Only the first change needs to wake up the main loop") {
+            CHECK_FALSE(batch.pending());
+            CHECK(batch.subscribe("everest/a", QOS::QOS2));
+            CHECK_FALSE(batch.subscribe("everest/b", QOS::QOS2));
+            CHECK(batch.pending());
+            batch.clear();
+            CHECK_FALSE(batch.pending());
+        }
+
+        WHEN("Hundreds of topics are subscribed") {
+            for (int i = 0; i < 300; i++) {
+                batch.subscribe("everest/module/impl/error/" + std::to_string(i), QOS::QOS2);
+            }
+            batch.flush(client, buffers);
+
+            THEN("They are sent in a few packets") {
+                const auto statistics = batch.get_statistics();
+                CHECK(statistics.topics_subscribed == 300);
+                CHECK(statistics.subscribe_packets == 3);
+                CHECK(mqtt_mq_length(&client.mq) == 3);
+                CHECK_FALSE(batch.pending());
+            }
+        }
+
+        WHEN("Subscribing and unsubscribing alternate") {
+            batch.subscribe("everest/a", QOS::QOS2);
+            batch.unsubscribe("everest/a");
+            batch.subscribe("everest/a", QOS::QOS1);
+            batch.flush(client, buffers);
+
+            THEN("The order of the changes is kept") {
+                const auto statistics = batch.get_statistics();
+                CHECK(statistics.subscribe_packets == 2);
+                CHECK(statistics.unsubscribe_packets == 1);
+                CHECK(mqtt_mq_length(&client.mq) == 3);
+            }
+        }
+    }
+}
@@ -0,0 +1,95 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <list>
+#include <mutex>
+#include <vector>
+
+#include <utils/message_queue.hpp>
+#include <utils/thread_pool.hpp>
+
+namespace {
+// waits until \p predicate is true, returns false on timeout
+template <typename Predicate> bool wait_for(std::mutex& mutex, std::condition_variable& cv, Predicate predicate) {
+    std::unique_lock<std::mutex> lock(mutex);
+    return cv.wait_for(lock, std::chrono::seconds(10), predicate);
+}
+} // namespace
+
+SCENARIO("Thread pool executes posted tasks", "[!throws]") {
+    GIVEN("A thread pool with a fixed number of workers") {
+        std::mutex mutex;
+        std::condition_variable cv;
+        size_t executed = 0;
+
+        Everest::ThreadPool pool(3);
+        CHECK(pool.size() == 3);
+
+        THEN("All posted tasks are executed") {
+            constexpr size_t number_of_tasks = 1000;
+            for (size_t i = 0; i < number_of_tasks; i++) {
+                pool.post([&]() {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    executed++;
+                    cv.notify_all();
+                });
+            }
+            CHECK(wait_for(mutex, cv, [&]() { return executed == number_of_tasks; }));
+        }
+    }
+
+    GIVEN("A thread pool with an automatically selected number of workers") {
+        Everest::ThreadPool pool(0);
+        THEN("At least some workers are started") {
+            CHECK(pool.size() >= 4);
+        }
+    }
+}
+
+SCENARIO("Message handlers deliver messages of one topic in order", "[!throws]") {
+    GIVEN("Many message handlers sharing a small thread pool") {
+        constexpr size_t number_of_topics = 50;
+        constexpr size_t messages_per_topic = 200;
+
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::vector<int>> received(number_of_topics);
+        size_t total_received = 0;
+
+        // NOTE: the thread pool is declared last, so it is stopped before the message handlers get destroyed
+        std::list<Everest::MessageHandler> message_handlers;
+        Everest::ThreadPool pool(2);
+
+        for (size_t topic = 0; topic < number_of_topics; topic++) {
+            auto& message_handler = message_handlers.emplace_back(pool);
+            message_handler.add_handler(std::make_shared<TypedHandler>(
+                HandlerType::ExternalMQTT, std::make_shared<Handler>([&, topic](const json& data) {
+                    std::lock_guard<std::mutex> lock(mutex);
+                    received.at(topic).push_back(data.get<int>());
+                    total_received++;
+                    cv.notify_all();
+                })));
+        }
+
+        WHEN("Messages are added to all handlers") {
+            for (int i = 0; i < static_cast<int>(messages_per_topic); i++) {
+                for (auto& message_handler : message_handlers) {
+                    message_handler.add(std::make_shared<const json>(i));
+                }
+            }
+
+            THEN("Every handler receives its messages in the order they were added") {
+                REQUIRE(wait_for(mutex, cv, [&]() { return total_received == number_of_topics * messages_per_topic; }));
+                for (const auto& messages : received) {
+                    REQUIRE(messages.size() == messages_per_topic);
+                    for (size_t i = 0; i < messages.size(); i++) {
+                        CHECK(messages.at(i) == static_cast<int>(i));
+                    }
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,101 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <set>
+#include <string>
+#include <vector>
+
+#include <fmt/format.h>
+
+#include <utils/mqtt_abstraction_impl.hpp>
+#include <utils/topic_trie.hpp>
+
+namespace {
+std::set<std::string> trie_matches(const Everest::TopicTrie<std::string>& trie, const std::string& topic) {
+    std::set<std::string> matches;
+    trie.match(topic, [&matches](const std::string& subscription) { matches.insert(subscription); });
+    return matches;
+}
+
+std::set<std::string> scan_matches(const std::vector<std::string>& subscriptions, const std::string& topic) {
+    std::set<std::string> matches;
+    for (const auto& subscription : subscriptions) {
+        if (Everest::MQTTAbstractionImpl::check_topic_matches(topic, subscription)) {
+            matches.insert(subscription);
+        }
+    }
+    return matches;
+}
+} // namespace
+
+SCENARIO("Topic trie routes topics like check_topic_matches", "[!throws]") {
+    GIVEN("A set of subscriptions with and without wildcards") {
+        const std::vector<std::string> subscriptions = {
+            "#",         "a",           "a/b",   "a/b/c",  "a/+",      "a/+/c",   "+/b",   "+/+",   "+",
+            "a/#",       "a/b/#",       "+/#",   "a/#/c",  "a/+/#",    "#/c",     "a/#/#", "x/y/z", "a//b",
+            "a/+/+/+/#", "everest/foo", "/",     "/#",     "+/b/+/d",  "a/b/c/d", "",      "a#",    "a/b+",
+        };
+        Everest::TopicTrie<std::string> trie;
+        for (const auto& subscription : subscriptions) {
+            trie.insert(subscription, subscription);
+        }
+        THEN("It contains all subscriptions") {
+            CHECK(trie.size() == subscriptions.size());
+        }
+        THEN("All topics match the same subscriptions as with a linear scan") {
+            const std::vector<std::string> topics = {
+                "a",     "b",       "a/b",     "a/c",     "a/b/c",       "a/b/c/d", "a/b/c/d/e", "x/y/z",
+                "x/y",   "a//b",    "/",       "//",      "/a",          "a/",      "c",         "b/c",
+                "a/x/c", "q/b/x/d", "",        "a#",      "everest/foo", "a/b+",    "everest",   "a/b/c/d/e/f/g",
+            };
+            for (const auto& topic : topics) {
+                INFO("topic: '" << topic << "'");
+                CHECK(trie_matches(trie, topic) == scan_matches(subscriptions, topic));
+            }
+        }
+        THEN("Erased subscriptions do not match anymore") {
+            CHECK(trie.erase("a/#"));
+            CHECK(trie.erase("a/b"));
+            CHECK_FALSE(trie.erase("a/b"));
+            CHECK_FALSE(trie.erase("does/not/exist"));
+            CHECK(trie.size() == subscriptions.size() - 2);
+            const auto matches = trie_matches(trie, "a/b");
+            CHECK(matches.count("a/#") == 0);
+            CHECK(matches.count("a/b") == 0);
+            CHECK(matches.count("a/+") == 1);
+        }
+    }
+}
+
+TEST_CASE("Topic routing benchmark", "[.][benchmark]") {
+    std::vector<std::string> subscriptions;
+    for (int module = 0; module < 100; module++) {
+        for (int topic = 0; topic < 5; topic++) {
+            subscriptions.push_back(fmt::format("external/module_{}/topic_{}", module, topic));
+        }
+        subscriptions.push_back(fmt::format("external/module_{}/+/state", module));
+        subscriptions.push_back(fmt::format("external/module_{}/debug/#", module));
+    }
+    Everest::TopicTrie<const std::string*> trie;
+    for (const auto& subscription : subscriptions) {
+        trie.insert(subscription, &subscription);
+    }
+    const std::string topic = "external/module_73/connector_1/state";
+
+    BENCHMARK("linear scan with check_topic_matches") {
+        size_t matches = 0;
+        for (const auto& subscription : subscriptions) {
+            if (Everest::MQTTAbstractionImpl::check_topic_matches(topic, subscription)) {
+                matches++;
+            }
+        }
+        return matches;
+    };
+
+    BENCHMARK("topic trie") {
+        size_t matches = 0;
+        trie.match(topic, [&matches](const std::string*) { matches++; });
+        return matches;
+    };
+}
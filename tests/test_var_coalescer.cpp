@@ -0,0 +1,91 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright 2020 - 2023 Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <chrono>
+#include <condition_variable>
+#include <map>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <utils/var_coalescer.hpp>
+
+using json = nlohmann::json;
+using namespace std::chrono_literals;
+
+SCENARIO("Var messages are only batched if there is more than one var", "[!throws]") {
+    GIVEN("A single var") {
+        THEN("It is published as a plain var message") {
+            CHECK(Everest::make_var_message({{"power", 1}}) == json({{"name", "power"}, {"data", 1}}));
+        }
+    }
+    GIVEN("Several vars") {
+        THEN("They are published as one batch message in the given order") {
+            CHECK(Everest::make_var_message({{"power", 1}, {"limit", 2}}) ==
+                  json({{"batch", {{{"name", "power"}, {"data", 1}}, {{"name", "limit"}, {"data", 2}}}}}));
+        }
+    }
+}
+
+SCENARIO("Var coalescer publishes one batch per implementation and window", "[!throws]") {
+    GIVEN("A var coalescer") {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::vector<std::pair<std::string, json>> published;
+
+        Everest::VarCoalescer coalescer(50ms, [&](const std::string& impl_id, const Everest::VarBatch& vars) {
+            const std::lock_guard<std::mutex> lock(mutex);
+            published.emplace_back(impl_id, Everest::make_var_message(vars));
+            cv.notify_all();
+        });
+
+        WHEN("Vars of two implementations are published within one window") {
+            coalescer.add("meter", "power", 1);
+            coalescer.add("meter", "energy", 10);
+            coalescer.add("evse", "limit", 16);
+            coalescer.add("meter", "power", 2);
+
+            THEN("Each implementation publishes one message with the last value of every var") {
+                std::unique_lock<std::mutex> lock(mutex);
+                REQUIRE(cv.wait_for(lock, 10s, [&]() { return published.size() == 2; }));
+                std::map<std::string, json> by_impl{published.begin(), published.end()};
+                CHECK(by_impl.at("meter") == Everest::make_var_message({{"power", 2}, {"energy", 10}}));
+                CHECK(by_impl.at("evse") == Everest::make_var_message({{"limit", 16}}));
+            }
+        }
+
+        WHEN("Vars are flushed before the window ends") {
+            coalescer.add("meter", "power", 1);
+            coalescer.flush();
+
+            THEN("They are published right away and only once") {
+                {
+                    const std::lock_guard<std::mutex> lock(mutex);
+                    REQUIRE(published.size() == 1);
+                    CHECK(published.at(0).second == Everest::make_var_message({{"power", 1}}));
+                }
+                std::this_thread::sleep_for(100ms);
+                const std::lock_guard<std::mutex> lock(mutex);
+                CHECK(published.size() == 1);
+            }
+        }
+    }
+
+    GIVEN("A var coalescer that is destroyed with pending vars") {
+        std::vector<json> published;
+        {
+            Everest::VarCoalescer coalescer(10s, [&](const std::string&, const Everest::VarBatch& vars) {
+                published.push_back(Everest::make_var_message(vars));
+            });
+            coalescer.add("meter", "power", 1);
+        }
+
+        THEN("The pending vars are published") {
+            REQUIRE(published.size() == 1);
+            CHECK(published.at(0) == Everest::make_var_message({{"power", 1}}));
+        }
+    }
+}
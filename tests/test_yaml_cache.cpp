@@ -0,0 +1,142 @@
+// SPDX-License-Identifier: Apache-2.0
+// Copyright Pionix GmbH and Contributors to EVerest
+#include <catch2/catch_all.hpp>
+
+#include <fstream>
+#include <memory>
+#include <string>
+
+#include <framework/runtime.hpp>
+#include <tests/helpers.hpp>
+#include <utils/config.hpp>
+#include <utils/yaml_cache.hpp>
+
+namespace {
+std::shared_ptr<Everest::RuntimeSettings> many_modules_settings(const fs::path& cache_dir) {
+    const std::string bin_dir = Everest::tests::get_bin_dir().string() + "/";
+    auto rs =
+        std::make_shared<Everest::RuntimeSettings>(bin_dir + "many_modules/", bin_dir + "many_modules/config.yaml");
+    rs->cache_dir = cache_dir;
+    rs->config_cache = true;
+    return rs;
+}
+
+void write_file(const fs::path& path, const std::string& content) {
+    std::ofstream ofs(path, std::ios::trunc);
+    ofs << content;
+}
+} // namespace
+
+SCENARIO("Parsed and validated yaml files are cached", "[yaml_cache]") {
+    const auto test_dir = Everest::tests::get_bin_dir() / "yaml_cache_test";
+    fs::remove_all(test_dir);
+    fs::create_directories(test_dir);
+    const auto cache_dir = test_dir / "cache";
+    const auto yaml_path = test_dir / "file.yaml";
+    write_file(yaml_path, "value: 1\nlist: [a, b]\n");
+
+    const json schema = {{"type", "object"}};
+    int processed = 0;
+    const auto process = [&processed](json value) {
+        processed++;
+        value["processed"] = true;
+        return value;
+    };
+
+    GIVEN("A file that was loaded before") {
+        const auto loaded = Everest::YamlCache(cache_dir).load(yaml_path, schema, process);
+        REQUIRE(processed == 1);
+        CHECK(loaded.at("value") == 1);
+        CHECK(loaded.at("processed") == true);
+
+        THEN("It is taken from the cache if neither the file nor the schema changed") {
+            Everest::YamlCache cache(cache_dir);
+            CHECK(cache.load(yaml_path, schema, process) == loaded);
+            CHECK(processed == 1);
+            CHECK(cache.get_statistics().hits == 1);
+            CHECK(cache.get_statistics().misses == 0);
+        }
+
+        THEN("It is loaded again if the file changed") {
+            write_file(yaml_path, "value: 2\nlist: [a, b]\n");
+            Everest::YamlCache cache(cache_dir);
+            CHECK(cache.load(yaml_path, schema, process).at("value") == 2);
+            CHECK(processed == 2);
+            CHECK(cache.get_statistics().misses == 1);
+        }
+
+        THEN("It is loaded again if the schema changed") {
+            Everest::YamlCache cache(cache_dir);
+            CHECK(cache.load(yaml_path, {{"type", "array"}}, process) == loaded);
+            CHECK(processed == 2);
+        }
+
+        THEN("It is loaded again if the cache entry is broken") {
+            for (const auto& entry : fs::directory_iterator(cache_dir)) {
+                write_file(entry.path(), "broken");
+            }
+            Everest::YamlCache cache(cache_dir);
+            CHECK(cache.load(yaml_path, schema, process) == loaded);
+            CHECK(processed == 2);
+        }
+
+        THEN("It is loaded again after the cache was cleared") {
+            CHECK(Everest::YamlCache(cache_dir).clear() == 1);
+            Everest::YamlCache cache(cache_dir);
+            CHECK(cache.load(yaml_path, schema, process) == loaded);
+            CHECK(processed == 2);
+        }
+    }
+
+    GIVEN("A disabled cache") {
+        Everest::YamlCache cache;
+
+        THEN("Every file is loaded and nothing is written") {
+            cache.load(yaml_path, schema, process);
+            cache.load(yaml_path, schema, process);
+            CHECK(processed == 2);
+            CHECK_FALSE(fs::exists(cache_dir));
+        }
+    }
+
+    GIVEN("A file that does not exist") {
+        Everest::YamlCache cache(cache_dir);
+
+        THEN("Loading it fails") {
+            CHECK_THROWS(cache.load(test_dir / "missing.yaml", schema, process));
+        }
+    }
+}
+
+SCENARIO("A config is loaded from the config cache", "[yaml_cache]") {
+    const auto cache_dir = Everest::tests::get_bin_dir() / "yaml_cache_test" / "config_cache";
+    fs::remove_all(cache_dir);
+
+    GIVEN("A config with 50 modules that was loaded before") {
+        const auto rs = many_modules_settings(cache_dir);
+        const Everest::Config uncached(rs);
+
+        THEN("Loading it again from the cache gives the same config") {
+            const Everest::Config cached(rs);
+            CHECK(cached.serialize() == uncached.serialize());
+        }
+    }
+}
+
+TEST_CASE("Config cache benchmark", "[.][benchmark]") {
+    const auto cache_dir = Everest::tests::get_bin_dir() / "yaml_cache_test" / "benchmark_cache";
+    const auto rs = many_modules_settings(cache_dir);
+    auto uncached_rs = std::make_shared<Everest::RuntimeSettings>(*rs);
+    uncached_rs->config_cache = false;
+    // fill the cache
+    fs::remove_all(cache_dir);
+    const Everest::Config config(rs);
+
+    BENCHMARK("load a config with 50 modules without cache") {
+        return Everest::Config(uncached_rs);
+    };
+
+    BENCHMARK("load a config with 50 modules from the cache") {
+        return Everest::Config(rs);
+    };
+}